@@ -19,10 +19,21 @@
 #include "logger/player_logger.h"
 #include "player/pipeline/conf.h"
 #include "player/creator.h"
+#include "player/pipeline/audio_sink_cache.h"
+#include "player/pipeline/autoplug_policy.h"
+#include "player/pipeline/factory_index.h"
+#include "player/pipeline/gst_media.h"
 #include "player/pipeline/info.h"
 #include "player/pipeline/common.h"
+#include "player/pipeline/element_policy.h"
 #include "player/pipeline/keep_alive.h"
+#include "player/pipeline/load_timeline.h"
 #include "player/pipeline/pipeline.h"
+#include "player/pipeline/playbin_pool.h"
+#include "player/pipeline/thread_registry.h"
+#include "player/pipeline/thumbnail_batch.h"
+#include "player/pipeline/thumbnail_cache.h"
+#include "player/pipeline/thumbnail_store.h"
 
 #include "player/media_player.h"
 
@@ -76,6 +87,7 @@ MediaPlayer::MediaPlayer()
     audio_controller_(std::make_shared<AudioController>()),
     start_timer_(new Timer()),
     callback_(),
+    thumbnail_batch_(nullptr),
     need_fade_out_(true),
     need_fade_in_(false),
     media_init_flag_(true),
@@ -105,6 +117,18 @@ MediaPlayer::~MediaPlayer() {
   LOG_INFO("");
   if (start_timer_)
     delete start_timer_;
+  // workers use the autoplug policy until they are joined
+  if (thumbnail_batch_)
+    delete thumbnail_batch_;
+  PlaybinPool::Destroy();
+  AudioSinkCache::Destroy();
+  FactoryIndex::Destroy();
+  ThreadRegistry::Destroy();
+  AutoplugPolicy::Destroy();
+  ElementPolicy::Destroy();
+  LoadTimeline::Destroy();
+  ThumbnailStore::Destroy();
+  ThumbnailCache::Destroy();
   KeepAlive::Exit();
 }
 
@@ -129,6 +153,10 @@ void MediaPlayer::MediaPlayerInit() {
 
     Conf::LoadSink();
     Conf::LoadRank();
+    // applied to streaming threads as they post STREAM_STATUS ENTER
+    ThreadRegistry::Instance()->LoadPolicy(Conf::GetThreadPolicy());
+    // cached sink bins were built from the previous sink/alsa configuration
+    AudioSinkCache::Instance()->Invalidate();
 
     if (Conf::GetFeatures(SUPPORT_DOLBY_ATMOS)) {
       bool is_dlbdec_exist = true;
@@ -143,6 +171,22 @@ void MediaPlayer::MediaPlayerInit() {
     } else {
       Conf::SetRank("dlbparse", 0);
     }
+    // ranks are final from here, index the decodable factories once for FindElementFactory()
+    FactoryIndex::Instance()->Invalidate();
+    FactoryIndex::Instance()->Build(GST_ELEMENT_FACTORY_TYPE_DECODABLE);
+    // autoplug-select rules shared by video, audio and thumbnail pipelines, nullptr keeps the defaults
+    AutoplugPolicy::Instance()->LoadRules(Conf::GetAutoplugRules());
+    // properties set on elements when they are added, e.g. ignore-eos of asfdemux
+    ElementPolicy::Instance()->LoadRules(Conf::GetElementProperties());
+
+    // warm playbins are built after ranks are final, on main loop idle
+    PlaybinPool::Instance()->SetCapacity("video_pipeline", Conf::GetSpec(PLAYBIN_POOL_VIDEO));
+    PlaybinPool::Instance()->SetCapacity("audio_pipeline", Conf::GetSpec(PLAYBIN_POOL_AUDIO));
+    PlaybinPool::Instance()->Prewarm();
+
+    // an empty THUMBNAIL_CACHE_PATH leaves the cache closed, every thumbnail is decoded
+    ThumbnailCache::Instance()->Open(Conf::GetThumbnail(THUMBNAIL_CACHE_PATH),
+                                     Conf::GetSpec(THUMBNAIL_CACHE_MB));
 
     media_init_flag_ = false;
   }
@@ -262,12 +306,14 @@ bool MediaPlayer::Rewind(double step) {
 }
 
 bool MediaPlayer::SetURI(const std::string& uri, int media_type) {
+  LoadTimeline::Instance()->Begin(uri);
   MediaPlayerInit();
   SetURIInternal(uri, media_type);
   return pipeline_->Load(uri);
 }
 
 bool MediaPlayer::SetURI(const std::string& uri, const std::string& option) {
+  LoadTimeline::Instance()->Begin(uri);
   MediaPlayerInit();
   using boost::property_tree::ptree;
 
@@ -357,12 +403,14 @@ bool MediaPlayer::SetURI(const std::string& uri, const std::string& option) {
       channel = audio_controller_->getAudioChannel(uri, slot, channel, &need_convert, &codec_id, &exec_time);
     }
   }
+  LoadTimeline::Instance()->Mark("channel-probe");
 
   if (!need_fade_out_) {
     fadeOut((int)(100L - exec_time));
   } else {
     fadeOut(100L);
   }
+  LoadTimeline::Instance()->Mark("fade-out");
   need_fade_out_ = false;
   need_fade_in_ = true;
 
@@ -503,6 +551,76 @@ bool MediaPlayer::SwitchChannel(bool downmix) {
   return pipeline_->SwitchChannel(downmix);
 }
 
+bool MediaPlayer::EnqueueNextURI(const std::string& uri) {
+  LOG_INFO("EnqueueNextURI[%s]", uri.c_str());
+  if (!pipeline_)
+    return false;
+  return pipeline_->EnqueueNextURI(uri);
+}
+
+std::string MediaPlayer::GetThreadInfo() {
+  LOG_INFO("GetThreadInfo");
+  return ThreadRegistry::Instance()->GetJson();
+}
+
+std::string MediaPlayer::GetQosInfo() {
+  LOG_INFO("GetQosInfo");
+  return GstMedia::Instance()->GetQosJson();
+}
+
+bool MediaPlayer::ExtractThumbnails(const std::string& option) {
+  using boost::property_tree::ptree;
+  LOG_INFO("ExtractThumbnails");
+  MediaPlayerInit();
+
+  ptree tree;
+  std::stringstream stream(option);
+  try {
+    boost::property_tree::read_json(stream, tree);
+  } catch (const boost::property_tree::ptree_error& exception) {
+    LOG_ERROR("Invalid JSON Format - %s", exception.what());
+    return false;
+  }
+
+  std::vector<ThumbnailItem> items;
+  boost::optional<ptree&> list = tree.get_child_optional("Thumbnails");
+  if (list) {
+    for (const auto& entry : *list) {
+      ThumbnailItem item;
+      item.uri_ = entry.second.get<std::string>("uri", "");
+      // static, the batch must not create the GstMedia singleton
+      item.raw_uri_ = GstMedia::GetRawURI(item.uri_);
+      item.filename_ = entry.second.get<std::string>("filename", "");
+      if (item.raw_uri_.empty()) {
+        LOG_ERROR("Fail to convert raw uri [%s]", item.uri_.c_str());
+        continue;
+      }
+      items.push_back(item);
+    }
+  }
+
+  if (!thumbnail_batch_) {
+    thumbnail_batch_ = new ThumbnailBatch([this](const std::string& data) {
+                                            if (callback_)
+                                              callback_(data);
+                                          });
+  }
+  return thumbnail_batch_->Start(items);
+}
+
+int MediaPlayer::TakeThumbnail(const std::string& uri, gint64* size) {
+  ThumbnailImage image;
+  if (!ThumbnailStore::Instance()->Take(uri, &image)) {
+    LOG_ERROR("no thumbnail for [%s]", uri.c_str());
+    return -1;
+  }
+  LOG_INFO("TakeThumbnail [%s] %dx%d %" G_GSIZE_FORMAT " bytes", uri.c_str(), image.width_, image.height_,
+           image.size_);
+  if (size)
+    *size = (gint64)image.size_;
+  return image.fd_;
+}
+
 int MediaPlayer::GetChannelInfo(const std::string& uri, const std::string& option) {
   LOG_INFO("GetChannelInfo");
   MediaPlayerInit();
@@ -605,6 +723,7 @@ void MediaPlayer::SetURIInternal(const std::string& uri, int media_type) {
 
   MI::Clear();
   CreatePipeline(media_type, uri);
+  LoadTimeline::Instance()->Mark("creator-done");
   MI::Get()->error_reason_ = creator_->GetErrorReason();
   pipeline_->RegisterCallback(callback_);
 
@@ -3990,6 +3990,31 @@ int32_t PlayerEngineCCOSAdaptor::getPlayNgByDatabase(std::string path) {
     return result;
 }
 
+// key of the player's ThumbnailCache entry, taken from the "cache_key" of a ThumbnailDone or
+// ThumbnailBatch event, so thumbnail_db rows can point at the cached image instead of a copy;
+// empty if the player has no entry for the file
+std::string PlayerEngineCCOSAdaptor::getThumbnailCacheKey(std::string event) {
+    ptree pt;
+    std::istringstream is(event);
+    try {
+        read_json(is, pt);
+    } catch (std::exception &e) {
+        m_logger->e("{}) {}:{} : exception {}", TAG, __FUNCTION__, __LINE__, e.what());
+        return std::string();
+    }
+
+    for (const char* name : {"ThumbnailDone", "ThumbnailBatch"}) {
+        boost::optional<ptree &> json_child = pt.get_child_optional(name);
+        if (!json_child.is_initialized())
+            continue;
+        auto key = (*json_child).get_optional<std::string>("cache_key");
+        if (key.is_initialized() && !(*key).empty())
+            return *key;
+    }
+    m_logger->w("{}) {}:{} : no cache key in {}", TAG, __FUNCTION__, __LINE__, event);
+    return std::string();
+}
+
 int32_t PlayerEngineCCOSAdaptor::getReadCntByDatabase(std::string path) {
     std::string file_path;
     const std::string filePrefix("file://");
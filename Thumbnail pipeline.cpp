@@ -14,25 +14,47 @@
 #include <boost/property_tree/json_parser.hpp>
 #include <boost/property_tree/ptree.hpp>
 #include <ctime>
+#include <unistd.h>
 
 #include "logger/player_logger.h"
+#include "player/pipeline/autoplug_policy.h"
 #include "player/pipeline/conf.h"
+#include "player/pipeline/fast_path_bin.h"
+#include "player/pipeline/thumbnail_cache.h"
+#include "player/pipeline/thumbnail_encoder.h"
+#include "player/pipeline/thumbnail_scaler.h"
+#include "player/pipeline/thumbnail_store.h"
 
 namespace genivimedia {
 
+struct CacheHit {
+  ThumbnailPipeline* pipeline_;
+  std::string dest_;
+  gint64 duration_;
+  std::string cache_key_;
+};
+
 ThumbnailPipeline::ThumbnailPipeline()
   : gst_media_(new GstMedia()),
     event_(new Event(false)),
     timer_(new Timer()),
     filename_(),
     uri_(),
-    video_count_(0) {
+    video_count_(0),
+    fast_path_(false),
+    fast_path_failed_(false),
+    output_fd_(false),
+    load_start_us_(0),
+    cache_key_(),
+    cache_source_id_(0) {
   LOG_DEBUG("");
 }
 
 ThumbnailPipeline::~ThumbnailPipeline() {
   LOG_INFO("");
 
+  if (cache_source_id_)
+    g_source_remove(cache_source_id_);
   if (gst_media_)
     delete gst_media_;
   if (event_)
@@ -51,6 +73,14 @@ bool ThumbnailPipeline::Load(const std::string& uri) {
     LOG_INFO("Fail to convert raw uri");
     return false;
   }
+
+  // a cached image of the file in its current state needs no pipeline at all
+  cache_key_.clear();
+  if (ThumbnailCache::Instance()->IsOpen() &&
+      ThumbnailCache::MakeKey(raw_uri, Conf::GetThumbnail(THUMBNAIL_FORMAT), &cache_key_) &&
+      LoadFromCache(uri))
+    return true;
+
   char* caps = nullptr;
 #if defined(PLATFORM_NVIDIA)
   caps = g_strdup_printf ("%s%s%s",
@@ -58,49 +88,77 @@ bool ThumbnailPipeline::Load(const std::string& uri) {
                           Conf::GetThumbnail(THUMBNAIL_WIDTH),
                           ",height=90");
 #else
-  caps = g_strdup_printf ("%s%s%s",
-                          "video/x-raw,format=RGB,width=",
-                          Conf::GetThumbnail(THUMBNAIL_WIDTH),
-                          ",pixel-aspect-ratio=1/1");
+  // ThumbnailScaler converts and scales in one pass, videoconvert ! videoscale stay in passthrough
+  if (Conf::GetFeatures(SUPPORT_THUMBNAIL_SCALER))
+    caps = g_strdup(ThumbnailScaler::kSinkCaps);
+  else
+    caps = g_strdup_printf ("%s%s%s",
+                            "video/x-raw,format=RGB,width=",
+                            Conf::GetThumbnail(THUMBNAIL_WIDTH),
+                            ",pixel-aspect-ratio=1/1");
 #endif
   LOG_INFO("uri[%s] with caps[%s]", uri.c_str(), caps);
   uri_ = uri;
+  load_start_us_ = g_get_monotonic_time();
+
+  // a thumbnail needs the video stream only, so only MP4 is worth the explicit chain
+  fast_path_ = false;
+  if (Conf::GetFeatures(SUPPORT_FAST_PATH) && !fast_path_failed_ &&
+      FastPathBin::Probe(raw_uri.c_str()) == FAST_PATH_MP4)
+    fast_path_ = gst_media_->CreateGstFastDecodebin(raw_uri.c_str(), caps, FAST_PATH_MP4);
 
-  if (!gst_media_->CreateGstUriDecodebin(raw_uri.c_str(), caps)) {
+  if (!fast_path_ && !gst_media_->CreateGstUriDecodebin(raw_uri.c_str(), caps)) {
     LOG_ERROR("cannot create Uridecodebin!");
     if (caps)
       g_free(caps);
     return false;
   }
+#if !defined(PLATFORM_NVIDIA)
+  if (Conf::GetFeatures(SUPPORT_THUMBNAIL_SCALER)) {
+    gint width = (gint)g_ascii_strtoll(Conf::GetThumbnail(THUMBNAIL_WIDTH), nullptr, 10);
+    ThumbnailScaler::RequestDecoderScaling(gst_media_->GetPipeline(), width);
+  }
+#endif
 
   BusCallback callback = std::bind(&ThumbnailPipeline::BusMessage, this,
                                    std::placeholders::_1,
                                    std::placeholders::_2,
                                    std::placeholders::_3);
   gst_media_->RegisterWatchBus(callback);
-  AutoPlugSortCallback autoplugsort_callback = std::bind(&ThumbnailPipeline::HandleAutoplugSort, this,
-                                                     std::placeholders::_1,
-                                                     std::placeholders::_2,
-                                                     std::placeholders::_3,
-                                                     std::placeholders::_4,
-                                                     std::placeholders::_5);
-  gst_media_->RegisterAutoPlugSort(autoplugsort_callback,
-                                   gst_bin_get_by_name(GST_BIN(gst_media_->GetPipeline()), "uridecode"));
-  AutoPlugSelectCallback autoplugselect_callback = std::bind(&ThumbnailPipeline::HandleAutoplugSelect, this,
-                                                     std::placeholders::_1,
-                                                     std::placeholders::_2,
-                                                     std::placeholders::_3,
-                                                     std::placeholders::_4,
-                                                     std::placeholders::_5);
-  gst_media_->RegisterAutoPlugSelect(autoplugselect_callback,
+  if (fast_path_) {
+    NoMorePadsCallback nomorepads_callback = std::bind(&ThumbnailPipeline::HandleNoMorePads, this,
+                                                       std::placeholders::_1,
+                                                       std::placeholders::_2);
+    gst_media_->RegisterNoMorePads(nomorepads_callback,
+                                   gst_bin_get_by_name(GST_BIN(gst_media_->GetPipeline()), "fastdecode"));
+    video_count_ = 0;
+  } else {
+    AutoPlugSortCallback autoplugsort_callback = std::bind(&ThumbnailPipeline::HandleAutoplugSort, this,
+                                                       std::placeholders::_1,
+                                                       std::placeholders::_2,
+                                                       std::placeholders::_3,
+                                                       std::placeholders::_4,
+                                                       std::placeholders::_5);
+    gst_media_->RegisterAutoPlugSort(autoplugsort_callback,
                                      gst_bin_get_by_name(GST_BIN(gst_media_->GetPipeline()), "uridecode"));
-  NoMorePadsCallback nomorepads_callback = std::bind(&ThumbnailPipeline::HandleNoMorePads, this,
-                                                     std::placeholders::_1,
-                                                     std::placeholders::_2);
-  gst_media_->RegisterNoMorePads(nomorepads_callback,
-                                 gst_bin_get_by_name(GST_BIN(gst_media_->GetPipeline()), "uridecode"));
+    AutoPlugSelectCallback autoplugselect_callback = std::bind(&ThumbnailPipeline::HandleAutoplugSelect, this,
+                                                       std::placeholders::_1,
+                                                       std::placeholders::_2,
+                                                       std::placeholders::_3,
+                                                       std::placeholders::_4,
+                                                       std::placeholders::_5);
+    gst_media_->RegisterAutoPlugSelect(autoplugselect_callback,
+                                       gst_bin_get_by_name(GST_BIN(gst_media_->GetPipeline()), "uridecode"));
+    NoMorePadsCallback nomorepads_callback = std::bind(&ThumbnailPipeline::HandleNoMorePads, this,
+                                                       std::placeholders::_1,
+                                                       std::placeholders::_2);
+    gst_media_->RegisterNoMorePads(nomorepads_callback,
+                                   gst_bin_get_by_name(GST_BIN(gst_media_->GetPipeline()), "uridecode"));
+  }
   TimerCallback timer_callback = std::bind(&ThumbnailPipeline::CheckConnectVideoPad, this);
   timer_->AddCallback(timer_callback, 10000);
+  if (fast_path_)
+    timer_->Start();
 
   if (!gst_media_->ChangeStateToPause()) {
     LOG_ERROR("cannot change status into pause.");
@@ -113,6 +171,74 @@ bool ThumbnailPipeline::Load(const std::string& uri) {
   return true;
 }
 
+bool ThumbnailPipeline::LoadFromCache(const std::string& uri) {
+  std::vector<guint8> data;
+  gint64 duration = 0;
+  if (!ThumbnailCache::Instance()->Lookup(cache_key_, &data, &duration))
+    return false;
+
+  gchar* format = Conf::GetThumbnail(THUMBNAIL_FORMAT);
+  gchar* dest = nullptr;
+  if (output_fd_) {
+    ThumbnailImage image;
+    if (!ThumbnailEncoder::CopyToMemfd(data.data(), data.size(), &image))
+      return false;
+    ThumbnailStore::Instance()->Put(uri, image);
+    dest = g_strdup("fd");
+  } else {
+    GError* error = nullptr;
+    dest = g_strdup_printf("%s%s.%s", Conf::GetThumbnail(THUMBNAIL_PATH), filename_.c_str(), format);
+    if (!g_file_set_contents(dest, (const gchar*)data.data(), data.size(), &error)) {
+      LOG_ERROR("cannot write %s: %s", dest, error->message);
+      g_error_free(error);
+      g_free(dest);
+      return false;
+    }
+  }
+  LOG_INFO("cache hit [%s] -> %s", uri.c_str(), dest);
+
+  // the client expects the result after Load() has returned, as from the pipeline
+  uri_ = uri;
+  if (cache_source_id_)
+    g_source_remove(cache_source_id_);
+  CacheHit* hit = new CacheHit{this, dest, duration, cache_key_};
+  cache_source_id_ = g_idle_add_full(G_PRIORITY_DEFAULT_IDLE, NotifyCacheHitFunc, hit, FreeCacheHitFunc);
+  g_free(dest);
+  return true;
+}
+
+gboolean ThumbnailPipeline::NotifyCacheHitFunc(gpointer data) {
+  CacheHit* hit = reinterpret_cast<CacheHit*>(data);
+  ThumbnailPipeline* pipeline = hit->pipeline_;
+  pipeline->cache_source_id_ = 0;
+  pipeline->event_->NotifyEventThumbnailDone(pipeline->uri_.c_str(), hit->dest_.c_str(), hit->duration_,
+                                            hit->cache_key_);
+  return G_SOURCE_REMOVE;
+}
+
+void ThumbnailPipeline::FreeCacheHitFunc(gpointer data) {
+  delete reinterpret_cast<CacheHit*>(data);
+}
+
+void ThumbnailPipeline::InsertIntoCache(const gchar* path, const ThumbnailImage* image, gint64 duration) {
+  if (cache_key_.empty())
+    return;
+  if (image) {
+    // pread leaves the offset of the fd handed to the client alone
+    std::vector<guint8> data(image->size_);
+    ssize_t size = pread(image->fd_, data.data(), data.size(), 0);
+    if (size == (ssize_t)data.size())
+      ThumbnailCache::Instance()->Insert(cache_key_, data.data(), data.size(), duration);
+    return;
+  }
+  gchar* contents = nullptr;
+  gsize length = 0;
+  if (g_file_get_contents(path, &contents, &length, nullptr)) {
+    ThumbnailCache::Instance()->Insert(cache_key_, (const guint8*)contents, length, duration);
+    g_free(contents);
+  }
+}
+
 bool ThumbnailPipeline::Load(const std::string& uri, const std::string& option, char slot) {
   using boost::property_tree::ptree;
 
@@ -127,9 +253,12 @@ bool ThumbnailPipeline::Load(const std::string& uri, const std::string& option,
 
   auto iter = tree.begin();
   ptree info = iter->second;
+  fast_path_failed_ = false;
   if (info.get_optional<std::string>("filename"))
     filename_ = info.get<std::string>("filename");
-  LOG_INFO("%s",filename_.c_str());
+  // "fd" keeps the image in a memfd for TakeThumbnail instead of writing THUMBNAIL_PATH
+  output_fd_ = (info.get<std::string>("output", "") == "fd");
+  LOG_INFO("%s output[%s]", filename_.c_str(), output_fd_ ? "fd" : "file");
   return Load(uri);
 }
 
@@ -138,6 +267,13 @@ bool ThumbnailPipeline::Unload(bool send_event, bool destroy_pipeline) {
 }
 
 bool ThumbnailPipeline::UnloadInternal(bool destroy_pipeline) {
+  if (cache_source_id_) {
+    g_source_remove(cache_source_id_);
+    cache_source_id_ = 0;
+  }
+  // served from ThumbnailCache, nothing was built
+  if (!gst_media_->GetPipeline())
+    return true;
   video_count_ = 0;
   timer_->Stop();
   if ( false == gst_media_->StopGstPipeline()) {
@@ -225,6 +361,7 @@ bool ThumbnailPipeline::Extract() {
   gchar* dest = nullptr;
   gchar* format = Conf::GetThumbnail(THUMBNAIL_FORMAT);
   bool ret = true;
+  gint64 start_us = g_get_monotonic_time();
 
   LOG_INFO("Extract");
   duration = gst_media_->GetDuration();
@@ -233,22 +370,40 @@ bool ThumbnailPipeline::Extract() {
   else
     position = 1 * GST_SECOND;
 
-  dest = g_strdup_printf ("%s%s.%s",
-                          Conf::GetThumbnail(THUMBNAIL_PATH),
-                          filename_.c_str(),
-                          format);
-  if (gst_media_->IsSeekable() && !gst_media_->SeekSimple(position)){
+  if (output_fd_)
+    dest = g_strdup("fd");
+  else
+    dest = g_strdup_printf ("%s%s.%s",
+                            Conf::GetThumbnail(THUMBNAIL_PATH),
+                            filename_.c_str(),
+                            format);
+  // with SUPPORT_THUMBNAIL_KEYFRAME ExtractThumbnail() seeks to the keyframe itself
+  if (!Conf::GetFeatures(SUPPORT_THUMBNAIL_KEYFRAME) &&
+      gst_media_->IsSeekable() && !gst_media_->SeekSimple(position)){
     LOG_ERROR("SeekSimple Error!");
     ret = false;
     goto EXIT;
   }
-  if (!gst_media_->ExtractThumbnail(const_cast<char*>(dest), const_cast<char*>(format))){
+  if (output_fd_) {
+    ThumbnailImage image;
+    if (!gst_media_->ExtractThumbnail(format, &image)) {
+      LOG_ERROR("ExtrctThumbnail Error!");
+      ret = false;
+      goto EXIT;
+    }
+    InsertIntoCache(nullptr, &image, duration);
+    ThumbnailStore::Instance()->Put(uri_, image);
+  } else if (!gst_media_->ExtractThumbnail(const_cast<char*>(dest), const_cast<char*>(format))){
     LOG_ERROR("ExtrctThumbnail Error!");
     ret = false;
     goto EXIT;
+  } else {
+    InsertIntoCache(dest, nullptr, duration);
   }
 
-  event_->NotifyEventThumbnailDone(uri_.c_str(), dest, duration);
+  LOG_INFO("extract [%lld]us", g_get_monotonic_time() - start_us);
+
+  event_->NotifyEventThumbnailDone(uri_.c_str(), dest, duration, cache_key_);
 
 EXIT:
   if (dest)
@@ -316,6 +471,14 @@ void ThumbnailPipeline::HandleBusChangeState(GstMessage* message) {
 
 gboolean ThumbnailPipeline::HandleBusApplication(GstMessage* message) {
   LOG_INFO("[HandleBusApplication] src(%s)", GST_MESSAGE_SRC_NAME(message));
+
+  const GstStructure* structure = gst_message_get_structure(message);
+  if (structure && gst_structure_has_name(structure, FAST_PATH_FALLBACK_MESSAGE)) {
+    LOG_INFO("reload [%s] through uridecodebin", uri_.c_str());
+    fast_path_failed_ = true;
+    UnloadInternal(true);
+    Load(uri_);
+  }
   return true;
 }
 
@@ -342,6 +505,10 @@ gboolean ThumbnailPipeline::HandleBusPipelineMessage(GstMessage* message) {
 
     case GST_MESSAGE_ASYNC_DONE:
       LOG_INFO("[BUS] GST_MESSAGE_ASYNC_DONE");
+      if (load_start_us_) {
+        FastPathBin::ReportLoad("thumbnail_pipeline", fast_path_, g_get_monotonic_time() - load_start_us_);
+        load_start_us_ = 0;
+      }
       break;
 
     default:
@@ -430,12 +597,25 @@ GValueArray* ThumbnailPipeline::HandleAutoplugSort(GstElement *bin,GstPad *pad,G
 
 int ThumbnailPipeline::HandleAutoplugSelect(GstElement *bin,GstPad *pad, GstCaps *caps,
                                         GstElementFactory *factory, gpointer data) {
-  int select_result = GST_AUTOPLUG_SELECT_TRY;
+  int select_result = AutoplugPolicy::Instance()->Select("thumbnail_pipeline", caps, factory);
 
   return select_result;
 }
 
 void ThumbnailPipeline::HandleNoMorePads(GstElement *element, gpointer data) {
+  if (fast_path_) {
+    // no autoplug-sort on the fast path, the video pad is either linked to the converter or absent
+    GstElement* convert = gst_bin_get_by_name(GST_BIN(gst_media_->GetPipeline()), "convert");
+    GstPad* sink = convert ? gst_element_get_static_pad(convert, "sink") : nullptr;
+    video_count_ = (sink && gst_pad_is_linked(sink)) ? 2 : 0;
+    if (video_count_ > 1)
+      timer_->Stop();
+    if (sink)
+      gst_object_unref(sink);
+    if (convert)
+      gst_object_unref(convert);
+  }
+
   if (video_count_ < 2) {
     LOG_ERROR("No Video");
     event_->NotifyEventError(ERROR_THUMBNAIL_EXTRACT, "", uri_);
@@ -0,0 +1,175 @@
+// @@@LICENSE
+//
+// Copyright (C) 2023, LG Electronics, All Right Reserved.
+//
+// No part of this source code may be communicated, distributed, reproduced
+// or transmitted in any form or by any means, electronic or mechanical or
+// otherwise, for any purpose, without the prior written permission of
+// LG Electronics.
+//
+// LICENSE@@@
+
+#include "player/pipeline/audio_sink_cache.h"
+
+#include <algorithm>
+
+#include "logger/player_logger.h"
+
+namespace genivimedia {
+
+AudioSinkCache* AudioSinkCache::instance_ = nullptr;
+
+AudioSinkCache* AudioSinkCache::Instance() {
+  if (instance_ == nullptr) {
+    instance_ = new AudioSinkCache();
+  }
+  return instance_;
+}
+
+void AudioSinkCache::Destroy() {
+  if (instance_) {
+    delete instance_;
+    instance_ = nullptr;
+  }
+}
+
+AudioSinkCache::AudioSinkCache()
+  : mutex_(),
+    bins_(),
+    descriptions_(),
+    pending_(),
+    order_(),
+    rebuild_source_id_(0),
+    hits_(0),
+    misses_(0) {
+}
+
+AudioSinkCache::~AudioSinkCache() {
+  LOG_INFO("hit=[%u] miss=[%u]", hits_, misses_);
+  if (rebuild_source_id_) {
+    g_source_remove(rebuild_source_id_);
+    rebuild_source_id_ = 0;
+  }
+  Invalidate();
+}
+
+GstElement* AudioSinkCache::Take(const AudioSinkKey& key, const std::string& description) {
+  GstElement* bin = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto iter = bins_.find(key);
+    if (iter != bins_.end()) {
+      bin = iter->second;
+      bins_.erase(iter);
+      hits_++;
+    } else {
+      misses_++;
+    }
+    LOG_INFO("audio sink cache %s, hit=[%u] miss=[%u]", bin ? "hit" : "miss", hits_, misses_);
+  }
+
+  if (bin) {
+    // hand out the same kind of reference gst_parse_bin_from_description() returns
+    g_object_force_floating(G_OBJECT(bin));
+  } else {
+    bin = Build(description);
+  }
+
+  if (bin)
+    ScheduleRebuild(key, description);
+  return bin;
+}
+
+void AudioSinkCache::Invalidate() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  LOG_INFO("drop %u cached audio sink bins", (guint)bins_.size());
+  for (auto& entry : bins_)
+    gst_object_unref(entry.second);
+  bins_.clear();
+  descriptions_.clear();
+  pending_.clear();
+  order_.clear();
+}
+
+guint AudioSinkCache::GetHitCount() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return hits_;
+}
+
+guint AudioSinkCache::GetMissCount() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return misses_;
+}
+
+gboolean AudioSinkCache::RebuildCallbackFunc(gpointer data) {
+  AudioSinkCache* cache = reinterpret_cast<AudioSinkCache*>(data);
+  AudioSinkKey key;
+  std::string description;
+  {
+    std::lock_guard<std::mutex> lock(cache->mutex_);
+    if (cache->pending_.empty()) {
+      cache->rebuild_source_id_ = 0;
+      return G_SOURCE_REMOVE;
+    }
+    key = cache->pending_.front();
+    cache->pending_.pop_front();
+    auto iter = cache->descriptions_.find(key);
+    if (iter == cache->descriptions_.end() || cache->bins_.count(key))
+      return G_SOURCE_CONTINUE;
+    description = iter->second;
+  }
+
+  GstElement* bin = Build(description);
+  if (!bin)
+    return G_SOURCE_CONTINUE;
+  gst_object_ref_sink(bin);
+
+  std::lock_guard<std::mutex> lock(cache->mutex_);
+  if (!cache->descriptions_.count(key) || cache->bins_.count(key)) {
+    // invalidated or refilled while building
+    gst_object_unref(bin);
+    return G_SOURCE_CONTINUE;
+  }
+  cache->bins_[key] = bin;
+  return G_SOURCE_CONTINUE;
+}
+
+GstElement* AudioSinkCache::Build(const std::string& description) {
+  GError* error = nullptr;
+  GstElement* bin = gst_parse_bin_from_description(description.c_str(), TRUE, &error);
+  if (error) {
+    LOG_ERROR("Failed to build audio sink[%s] : %s", description.c_str(), error->message);
+    g_error_free(error);
+  }
+  return bin;
+}
+
+void AudioSinkCache::ScheduleRebuild(const AudioSinkKey& key, const std::string& description) {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  auto order_iter = std::find_if(order_.begin(), order_.end(),
+                                 [&key](const AudioSinkKey& other) {
+                                   return !(key < other) && !(other < key);
+                                 });
+  if (order_iter != order_.end())
+    order_.erase(order_iter);
+  order_.push_back(key);
+
+  while (order_.size() > kMaxEntries) {
+    AudioSinkKey oldest = order_.front();
+    order_.pop_front();
+    auto bin_iter = bins_.find(oldest);
+    if (bin_iter != bins_.end()) {
+      gst_object_unref(bin_iter->second);
+      bins_.erase(bin_iter);
+    }
+    descriptions_.erase(oldest);
+  }
+
+  descriptions_[key] = description;
+  pending_.push_back(key);
+  if (rebuild_source_id_ == 0)
+    rebuild_source_id_ = g_idle_add_full(G_PRIORITY_LOW, RebuildCallbackFunc, this, nullptr);
+}
+
+}  // namespace genivimedia
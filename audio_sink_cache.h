@@ -0,0 +1,96 @@
+// @@@LICENSE
+//
+// Copyright (C) 2023, LG Electronics, All Right Reserved.
+//
+// No part of this source code may be communicated, distributed, reproduced
+// or transmitted in any form or by any means, electronic or mechanical or
+// otherwise, for any purpose, without the prior written permission of
+// LG Electronics.
+//
+// LICENSE@@@
+
+#ifndef GENIVIMEDIA_AUDIO_SINK_CACHE_H
+#define GENIVIMEDIA_AUDIO_SINK_CACHE_H
+
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <tuple>
+
+#include <glib.h>
+#include <gst/gst.h>
+
+namespace genivimedia {
+
+/**
+ * @struct     genivimedia::AudioSinkKey
+ * @brief      Every input that changes the audio sink bin description built by GstMedia::CreateAudioSinkBin().
+ */
+struct AudioSinkKey {
+  std::string audio_sink_;  /**< sink factory with its properties, e.g. "alsasink provide-clock=true" */
+  int channel_;
+  char slot_;
+  char slot_6ch_;
+  bool is_dsd_;
+  std::string media_type_;
+  std::string alsa_device_;
+
+  bool operator<(const AudioSinkKey& other) const {
+    return std::tie(audio_sink_, channel_, slot_, slot_6ch_, is_dsd_, media_type_, alsa_device_) <
+           std::tie(other.audio_sink_, other.channel_, other.slot_, other.slot_6ch_,
+                    other.is_dsd_, other.media_type_, other.alsa_device_);
+  }
+};
+
+/**
+ * @class      genivimedia::AudioSinkCache
+ * @brief      Keeps ready-made audio sink bins so that load and SwitchChannel skip gst_parse_bin_from_description().
+ * @details    A bin handed out by Take() belongs to the caller; the cache rebuilds a spare for the same key
+ *             on the main loop idle, so the next load with the same configuration is a hit.
+ *             Invalidate() drops every cached bin and shall be called whenever Conf is reloaded.
+ * @see        genivimedia::GstMedia
+ */
+class AudioSinkCache {
+ public:
+  static AudioSinkCache* Instance();
+  static void Destroy();
+
+  /**
+   * @fn Take
+   * @brief Returns a sink bin for the key, building it synchronously only on a miss.
+   * @param[in] key : cache key
+   * @param[in] description : gst-launch description of the bin for the key
+   * @return GstElement* (floating reference like gst_parse_bin_from_description()) or nullptr
+   */
+  GstElement* Take(const AudioSinkKey& key, const std::string& description);
+
+  void Invalidate();
+
+  guint GetHitCount();
+  guint GetMissCount();
+
+ private:
+  AudioSinkCache();
+  ~AudioSinkCache();
+
+  static gboolean RebuildCallbackFunc(gpointer data);
+  static GstElement* Build(const std::string& description);
+  void ScheduleRebuild(const AudioSinkKey& key, const std::string& description);
+
+  static AudioSinkCache* instance_;
+  static const size_t kMaxEntries = 8;
+
+  std::mutex mutex_;
+  std::map<AudioSinkKey, GstElement*> bins_;
+  std::map<AudioSinkKey, std::string> descriptions_;
+  std::deque<AudioSinkKey> pending_;
+  std::deque<AudioSinkKey> order_;
+  guint rebuild_source_id_;
+  guint hits_;
+  guint misses_;
+};
+
+}  // namespace genivimedia
+
+#endif  // GENIVIMEDIA_AUDIO_SINK_CACHE_H
@@ -0,0 +1,237 @@
+// @@@LICENSE
+//
+// Copyright (C) 2023, LG Electronics, All Right Reserved.
+//
+// No part of this source code may be communicated, distributed, reproduced
+// or transmitted in any form or by any means, electronic or mechanical or
+// otherwise, for any purpose, without the prior written permission of
+// LG Electronics.
+//
+// LICENSE@@@
+
+#include "player/pipeline/audio_sink_swap.h"
+
+#include <gst/base/gstbasesink.h>
+
+#include "logger/player_logger.h"
+
+namespace genivimedia {
+
+struct AudioSinkSwap::SwapContext {
+  GstElement* sink_bin_;
+  GstElement* sink_;
+  int channels_;
+  bool is_dsd_;
+  std::string caps_;
+  std::string device_;
+  gint64 block_time_;
+  bool handed_over_;
+};
+
+bool AudioSinkSwap::Start(GstElement* sink_bin, int channels, bool is_dsd, const std::string& caps,
+                          const std::string& device) {
+  if (!sink_bin || !GST_IS_BIN(sink_bin))
+    return false;
+
+  GstElement* sink = FindSink(sink_bin);
+  if (!sink) {
+    LOG_ERROR("No base sink in audio sink bin");
+    return false;
+  }
+  GstElement* capsfilter = FindCapsFilter(sink);
+  if (!capsfilter) {
+    LOG_ERROR("No capsfilter in front of audio sink");
+    gst_object_unref(sink);
+    return false;
+  }
+  gst_object_unref(capsfilter);
+
+  GstPad* ghost_pad = gst_element_get_static_pad(sink_bin, "sink");
+  if (!ghost_pad) {
+    gst_object_unref(sink);
+    return false;
+  }
+
+  SwapContext* context = new SwapContext();
+  context->sink_bin_ = GST_ELEMENT(gst_object_ref(sink_bin));
+  context->sink_ = sink;
+  context->channels_ = channels;
+  context->is_dsd_ = is_dsd;
+  context->caps_ = caps;
+  context->device_ = device;
+  context->block_time_ = 0;
+  context->handed_over_ = false;
+
+  LOG_INFO("live audio sink swap to channels=[%d] device=[%s]", channels, device.c_str());
+  gst_pad_add_probe(ghost_pad, GST_PAD_PROBE_TYPE_BLOCK_DOWNSTREAM,
+                    BlockProbeFunc, context, FreeContext);
+  gst_object_unref(ghost_pad);
+  return true;
+}
+
+GstElement* AudioSinkSwap::FindSink(GstElement* sink_bin) {
+  GstElement* sink = nullptr;
+  GstIterator* iter = gst_bin_iterate_sinks(GST_BIN(sink_bin));
+  GValue item = G_VALUE_INIT;
+  while (gst_iterator_next(iter, &item) == GST_ITERATOR_OK) {
+    GstElement* element = GST_ELEMENT(g_value_get_object(&item));
+    if (GST_IS_BASE_SINK(element)) {
+      sink = GST_ELEMENT(gst_object_ref(element));
+      g_value_reset(&item);
+      break;
+    }
+    g_value_reset(&item);
+  }
+  g_value_unset(&item);
+  gst_iterator_free(iter);
+  return sink;
+}
+
+GstElement* AudioSinkSwap::FindCapsFilter(GstElement* sink) {
+  GstElement* capsfilter = nullptr;
+  GstPad* sink_pad = gst_element_get_static_pad(sink, "sink");
+  if (!sink_pad)
+    return nullptr;
+
+  GstPad* peer = gst_pad_get_peer(sink_pad);
+  if (peer) {
+    GstElement* element = gst_pad_get_parent_element(peer);
+    if (element) {
+      GstElementFactory* factory = gst_element_get_factory(element);
+      if (factory && g_strcmp0(GST_OBJECT_NAME(factory), "capsfilter") == 0)
+        capsfilter = element;
+      else
+        gst_object_unref(element);
+    }
+    gst_object_unref(peer);
+  }
+  gst_object_unref(sink_pad);
+  return capsfilter;
+}
+
+bool AudioSinkSwap::Swap(SwapContext* context) {
+  GstElement* sink = context->sink_;
+  GstElement* capsfilter = FindCapsFilter(sink);
+  if (!capsfilter)
+    return false;
+
+  // audioconvert renegotiates on the next buffer because of the reconfigure sent by capsfilter
+  GstCaps* caps = gst_caps_from_string(context->caps_.c_str());
+  g_object_set(G_OBJECT(capsfilter), "caps", caps, nullptr);
+  gst_caps_unref(caps);
+
+  GstPad* sink_pad = gst_element_get_static_pad(sink, "sink");
+  GstPad* src_pad = gst_element_get_static_pad(capsfilter, "src");
+  gst_object_unref(capsfilter);
+  if (!sink_pad || !src_pad) {
+    if (sink_pad)
+      gst_object_unref(sink_pad);
+    if (src_pad)
+      gst_object_unref(src_pad);
+    return false;
+  }
+
+  GstClock* clock = gst_element_get_clock(sink);
+  GstClockTime base_time = gst_element_get_base_time(sink);
+
+  // unlinking marks the sticky events of capsfilter as pending, so the re-opened sink gets
+  // stream-start, the new caps and the current segment again in front of the next buffer
+  gst_pad_unlink(src_pad, sink_pad);
+  gst_element_set_state(sink, GST_STATE_NULL);
+  if (g_object_class_find_property(G_OBJECT_GET_CLASS(sink), "device"))
+    g_object_set(G_OBJECT(sink), "device", context->device_.c_str(), nullptr);
+  // no preroll, the rest of the pipeline stays in PLAYING
+  g_object_set(G_OBJECT(sink), "async", FALSE, nullptr);
+
+  bool ret = (gst_pad_link(src_pad, sink_pad) == GST_PAD_LINK_OK);
+  if (ret) {
+    gst_element_set_state(sink, GST_STATE_READY);
+    if (clock)
+      gst_element_set_clock(sink, clock);
+    gst_element_set_base_time(sink, base_time);
+    ret = gst_element_sync_state_with_parent(sink);
+  }
+
+  if (ret) {
+    context->handed_over_ = true;
+    gst_pad_add_probe(sink_pad, GstPadProbeType(GST_PAD_PROBE_TYPE_BUFFER |
+                                                GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM |
+                                                GST_PAD_PROBE_TYPE_EVENT_FLUSH),
+                      FirstBufferProbeFunc, context, FreeContext);
+  } else {
+    LOG_ERROR("Failed to re-open audio sink on [%s]", context->device_.c_str());
+  }
+
+  if (clock)
+    gst_object_unref(clock);
+  gst_object_unref(src_pad);
+  gst_object_unref(sink_pad);
+  return ret;
+}
+
+void AudioSinkSwap::PostResult(SwapContext* context, bool result, gint64 first_buffer_time) {
+  gint64 gap_us = (result && first_buffer_time) ? (first_buffer_time - context->block_time_) : -1;
+  gint64 latency_time = 0;
+  gint64 buffer_time = 0;
+  if (g_object_class_find_property(G_OBJECT_GET_CLASS(context->sink_), "latency-time"))
+    g_object_get(G_OBJECT(context->sink_), "latency-time", &latency_time, nullptr);
+  if (g_object_class_find_property(G_OBJECT_GET_CLASS(context->sink_), "buffer-time"))
+    g_object_get(G_OBJECT(context->sink_), "buffer-time", &buffer_time, nullptr);
+
+  // the gap ends when the sink pad sees the first buffer, output is audible one buffer-time later
+  LOG_INFO("audio sink swap %s, channels=[%d] first-buffer gap=[%lld]us period=[%lld]us buffer=[%lld]us",
+           result ? "done" : "failed", context->channels_, gap_us, latency_time, buffer_time);
+
+  GstStructure* structure = gst_structure_new(AUDIO_SINK_SWAP_MESSAGE,
+                                              "result", G_TYPE_BOOLEAN, result,
+                                              "channels", G_TYPE_INT, context->channels_,
+                                              "dsd", G_TYPE_BOOLEAN, context->is_dsd_,
+                                              "gap-us", G_TYPE_INT64, gap_us,
+                                              "period-us", G_TYPE_INT64, latency_time,
+                                              "buffer-us", G_TYPE_INT64, buffer_time,
+                                              nullptr);
+  gst_element_post_message(context->sink_bin_,
+                           gst_message_new_application(GST_OBJECT(context->sink_bin_), structure));
+}
+
+void AudioSinkSwap::FreeContext(gpointer data) {
+  SwapContext* context = reinterpret_cast<SwapContext*>(data);
+  if (context->handed_over_) {
+    // the first buffer probe owns it from now on
+    context->handed_over_ = false;
+    return;
+  }
+  gst_object_unref(context->sink_);
+  gst_object_unref(context->sink_bin_);
+  delete context;
+}
+
+GstPadProbeReturn AudioSinkSwap::BlockProbeFunc(GstPad* pad, GstPadProbeInfo* info, gpointer data) {
+  SwapContext* context = reinterpret_cast<SwapContext*>(data);
+  context->block_time_ = g_get_monotonic_time();
+
+  if (!Swap(context))
+    PostResult(context, false, 0);
+  return GST_PAD_PROBE_REMOVE;
+}
+
+GstPadProbeReturn AudioSinkSwap::FirstBufferProbeFunc(GstPad* pad, GstPadProbeInfo* info, gpointer data) {
+  SwapContext* context = reinterpret_cast<SwapContext*>(data);
+  gint64 now = 0;
+
+  if (GST_PAD_PROBE_INFO_TYPE(info) & GST_PAD_PROBE_TYPE_BUFFER) {
+    now = g_get_monotonic_time();
+  } else {
+    // a flush or EOS before the first buffer still ends the swap, the sink is open but no gap is measured
+    GstEventType type = GST_EVENT_TYPE(GST_PAD_PROBE_INFO_EVENT(info));
+    if (type != GST_EVENT_FLUSH_START && type != GST_EVENT_EOS)
+      return GST_PAD_PROBE_OK;
+    LOG_INFO("audio sink swap ended by [%s] before the first buffer", GST_EVENT_TYPE_NAME(GST_PAD_PROBE_INFO_EVENT(info)));
+  }
+
+  g_object_set(G_OBJECT(context->sink_), "async", TRUE, nullptr);
+  PostResult(context, true, now);
+  return GST_PAD_PROBE_REMOVE;
+}
+
+}  // namespace genivimedia
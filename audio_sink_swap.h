@@ -0,0 +1,74 @@
+// @@@LICENSE
+//
+// Copyright (C) 2023, LG Electronics, All Right Reserved.
+//
+// No part of this source code may be communicated, distributed, reproduced
+// or transmitted in any form or by any means, electronic or mechanical or
+// otherwise, for any purpose, without the prior written permission of
+// LG Electronics.
+//
+// LICENSE@@@
+
+#ifndef GENIVIMEDIA_AUDIO_SINK_SWAP_H
+#define GENIVIMEDIA_AUDIO_SINK_SWAP_H
+
+#include <string>
+
+#include <glib.h>
+#include <gst/gst.h>
+
+namespace genivimedia {
+
+#define AUDIO_SINK_SWAP_MESSAGE "audio-sink-swap"
+
+/**
+ * @class      genivimedia::AudioSinkSwap
+ * @brief      Re-targets a running audio sink bin to another channel layout without a pipeline state change.
+ * @details    The ghost sink pad of the bin is blocked, the channel capsfilter is updated and the sink element
+ *             is re-opened on the new ALSA device while the rest of the pipeline keeps its state and position.
+ *             The sink bin itself is kept so that the clock it provides to the pipeline stays valid; the
+ *             caller fixes the pipeline to that clock for the time of the swap, see GstMedia::SwitchChannelLive.
+ *             When the first buffer, a flush or EOS reaches the re-opened sink, an application message named
+ *             AUDIO_SINK_SWAP_MESSAGE is posted on the pipeline bus with the fields
+ *             <ul>
+ *                 <li>"result" (boolean) : FALSE if the sink could not be re-opened
+ *                 <li>"channels" (int) : new channel count
+ *                 <li>"dsd" (boolean) : DSD state the swap was requested with, for the fallback path
+ *                 <li>"gap-us" (int64) : time between blocking the pad and the first buffer arriving at the sink
+ *                     pad of the re-opened sink; this is not audible output, which follows one ring buffer
+ *                     later. -1 if the swap failed or ended by a flush or EOS
+ *                 <li>"period-us" (int64) : latency-time of the sink, i.e. one audio period
+ *                 <li>"buffer-us" (int64) : buffer-time of the sink, the ring buffer to fill before audio is heard
+ *             </ul>
+ * @see        genivimedia::GstMedia::SwitchChannel
+ */
+class AudioSinkSwap {
+ public:
+  /**
+   * @fn Start
+   * @brief Blocks the sink bin and schedules the swap on its streaming thread.
+   * @param[in] sink_bin : audio sink bin created by GstMedia::CreateAudioSinkBin(), in PLAYING state
+   * @param[in] channels : new channel count
+   * @param[in] is_dsd : DSD state, reported back for the fallback path
+   * @param[in] caps : new caps of the channel capsfilter, e.g. "audio/x-raw,channels=2"
+   * @param[in] device : new ALSA device of the sink element
+   * @return bool (TRUE - swap scheduled, FALSE - bin layout not supported, caller shall use the legacy path)
+   */
+  static bool Start(GstElement* sink_bin, int channels, bool is_dsd, const std::string& caps,
+                    const std::string& device);
+
+ private:
+  struct SwapContext;
+
+  static GstElement* FindSink(GstElement* sink_bin);
+  static GstElement* FindCapsFilter(GstElement* sink);
+  static bool Swap(SwapContext* context);
+  static void PostResult(SwapContext* context, bool result, gint64 first_buffer_time);
+  static void FreeContext(gpointer data);
+  static GstPadProbeReturn BlockProbeFunc(GstPad* pad, GstPadProbeInfo* info, gpointer data);
+  static GstPadProbeReturn FirstBufferProbeFunc(GstPad* pad, GstPadProbeInfo* info, gpointer data);
+};
+
+}  // namespace genivimedia
+
+#endif  // GENIVIMEDIA_AUDIO_SINK_SWAP_H
@@ -0,0 +1,307 @@
+// @@@LICENSE
+//
+// Copyright (C) 2023, LG Electronics, All Right Reserved.
+//
+// No part of this source code may be communicated, distributed, reproduced
+// or transmitted in any form or by any means, electronic or mechanical or
+// otherwise, for any purpose, without the prior written permission of
+// LG Electronics.
+//
+// LICENSE@@@
+
+#include "player/pipeline/autoplug_policy.h"
+
+#include <stdlib.h>
+
+#include <algorithm>
+#include <sstream>
+
+#include "logger/player_logger.h"
+#include "player/pipeline/conf.h"
+
+namespace genivimedia {
+
+// the former if/else chain of VideoPipeline::HandleAutoplugSelect(), thumbnails kept TRY for everything
+const gchar* AutoplugPolicy::kDefaultRules =
+    "beepdec audio/mpeg stream-format=adts mpegversion=2,4 scope=video_pipeline;"
+    "nvmediampeg4viddec video/x-h263 scope=video_pipeline;"
+    "jpegdec image/jpeg scope=video_pipeline;"
+    "avdec_amrwb,avdec_amrnb audio/* scope=video_pipeline;"
+    "avdec_msmpeg4v2,avdec_msmpeg4,avdec_h263,avdec_mpeg4 video/* max-pixels=divx scope=video_pipeline;"
+    "sfdec audio/* scope=video_pipeline;"
+    "nvmwvl1* video/* scope=video_pipeline";
+
+AutoplugPolicy* AutoplugPolicy::instance_ = nullptr;
+
+AutoplugPolicy* AutoplugPolicy::Instance() {
+  if (instance_ == nullptr) {
+    instance_ = new AutoplugPolicy();
+  }
+  return instance_;
+}
+
+void AutoplugPolicy::Destroy() {
+  if (instance_) {
+    delete instance_;
+    instance_ = nullptr;
+  }
+}
+
+AutoplugPolicy::AutoplugPolicy()
+  : mutex_(),
+    rules_(),
+    by_factory_(),
+    by_prefix_(),
+    decisions_(),
+    inspected_fields_(),
+    pixel_limits_(),
+    hits_(0),
+    misses_(0) {
+  LoadRules(nullptr);
+}
+
+AutoplugPolicy::~AutoplugPolicy() {
+  LOG_INFO("hit=[%u] miss=[%u] decisions=[%u]", hits_, misses_, (guint)decisions_.size());
+}
+
+int AutoplugPolicy::LoadRules(const gchar* table) {
+  std::vector<AutoplugRule> rules;
+  std::stringstream stream(table ? table : kDefaultRules);
+  std::string entry;
+  while (std::getline(stream, entry, ';')) {
+    AutoplugRule rule;
+    if (ParseRule(entry, rule))
+      rules.push_back(rule);
+    else if (entry.find_first_not_of(" \t") != std::string::npos)
+      LOG_ERROR("Invalid autoplug rule [%s]", entry.c_str());
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  rules_.swap(rules);
+  by_factory_.clear();
+  by_prefix_.clear();
+  inspected_fields_.clear();
+  pixel_limits_.clear();
+  for (size_t i = 0; i < rules_.size(); i++) {
+    for (GQuark factory : rules_[i].factories_)
+      by_factory_[factory].push_back(i);
+    if (!rules_[i].factory_prefixes_.empty())
+      by_prefix_.push_back(i);
+    for (const AutoplugRule::Field& field : rules_[i].fields_)
+      inspected_fields_.push_back(field.name_);
+    if (rules_[i].max_pixels_ > 0)
+      pixel_limits_.push_back(rules_[i].max_pixels_);
+  }
+  std::sort(inspected_fields_.begin(), inspected_fields_.end());
+  inspected_fields_.erase(std::unique(inspected_fields_.begin(), inspected_fields_.end()), inspected_fields_.end());
+  std::sort(pixel_limits_.begin(), pixel_limits_.end());
+  pixel_limits_.erase(std::unique(pixel_limits_.begin(), pixel_limits_.end()), pixel_limits_.end());
+  decisions_.clear();
+  LOG_INFO("%u autoplug rules loaded%s", (guint)rules_.size(), table ? "" : " (default)");
+  return (int)rules_.size();
+}
+
+int AutoplugPolicy::Select(const gchar* scope, GstCaps* caps, GstElementFactory* factory) {
+  if (!caps || !factory || gst_caps_get_size(caps) == 0)
+    return GST_AUTOPLUG_SELECT_TRY;
+
+  const gchar* factory_name = gst_plugin_feature_get_name(GST_PLUGIN_FEATURE_CAST(factory));
+  GQuark scope_quark = g_quark_from_string(scope ? scope : "");
+  GQuark factory_quark = g_quark_from_string(factory_name);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::string key = std::to_string(scope_quark) + "|" + std::to_string(factory_quark) + "|" +
+                    DecisionKey(gst_caps_get_structure(caps, 0));
+  auto cached = decisions_.find(key);
+  if (cached != decisions_.end()) {
+    hits_++;
+    return cached->second;
+  }
+  misses_++;
+
+  int result = Evaluate(scope_quark, factory_quark, factory_name, caps);
+  decisions_[key] = result;
+  return result;
+}
+
+bool AutoplugPolicy::ParseRule(const std::string& text, AutoplugRule& rule) {
+  std::stringstream stream(text);
+  std::string factories;
+  std::string caps;
+  if (!(stream >> factories >> caps))
+    return false;
+
+  std::stringstream factory_stream(factories);
+  std::string factory;
+  while (std::getline(factory_stream, factory, ',')) {
+    if (factory.empty())
+      continue;
+    if (factory.back() == '*')
+      rule.factory_prefixes_.push_back(factory.substr(0, factory.size() - 1));
+    else
+      rule.factories_.push_back(g_quark_from_string(factory.c_str()));
+  }
+  if (rule.factories_.empty() && rule.factory_prefixes_.empty())
+    return false;
+
+  rule.caps_name_ = 0;
+  if (caps == "*")
+    rule.caps_prefix_.clear();
+  else if (caps.back() == '*')
+    rule.caps_prefix_ = caps.substr(0, caps.size() - 1);
+  else
+    rule.caps_name_ = g_quark_from_string(caps.c_str());
+
+  rule.max_pixels_ = 0;
+  rule.result_ = GST_AUTOPLUG_SELECT_SKIP;
+  rule.text_ = text;
+
+  std::string token;
+  while (stream >> token) {
+    size_t pos = token.find('=');
+    if (pos == std::string::npos)
+      return false;
+    std::string key = token.substr(0, pos);
+    std::string value = token.substr(pos + 1);
+
+    if (key == "max-pixels") {
+      rule.max_pixels_ = (value == "divx") ? (gint64)Conf::GetSpec(DIVX_MAX_WIDTH) * Conf::GetSpec(DIVX_MAX_HEIGHT)
+                                           : atoll(value.c_str());
+    } else if (key == "scope") {
+      std::stringstream scope_stream(value);
+      std::string scope;
+      while (std::getline(scope_stream, scope, ','))
+        rule.scopes_.push_back(g_quark_from_string(scope.c_str()));
+    } else if (key == "result") {
+      if (value == "skip")
+        rule.result_ = GST_AUTOPLUG_SELECT_SKIP;
+      else if (value == "try")
+        rule.result_ = GST_AUTOPLUG_SELECT_TRY;
+      else if (value == "expose")
+        rule.result_ = GST_AUTOPLUG_SELECT_EXPOSE;
+      else
+        return false;
+    } else {
+      AutoplugRule::Field field;
+      field.name_ = g_quark_from_string(key.c_str());
+      std::stringstream value_stream(value);
+      std::string item;
+      while (std::getline(value_stream, item, ','))
+        field.values_.push_back(item);
+      rule.fields_.push_back(field);
+    }
+  }
+  return true;
+}
+
+bool AutoplugPolicy::MatchCaps(const AutoplugRule& rule, GstStructure* structure) {
+  if (rule.caps_name_) {
+    if (gst_structure_get_name_id(structure) != rule.caps_name_)
+      return false;
+  } else if (!rule.caps_prefix_.empty() &&
+             !g_str_has_prefix(gst_structure_get_name(structure), rule.caps_prefix_.c_str())) {
+    return false;
+  }
+
+  for (const AutoplugRule::Field& field : rule.fields_) {
+    const GValue* value = gst_structure_id_get_value(structure, field.name_);
+    if (!value)
+      return false;
+    bool matched = false;
+    for (const std::string& expected : field.values_) {
+      if (G_VALUE_HOLDS_STRING(value))
+        matched = (g_strcmp0(g_value_get_string(value), expected.c_str()) == 0);
+      else if (G_VALUE_HOLDS_INT(value))
+        matched = (g_value_get_int(value) == atoi(expected.c_str()));
+      else if (G_VALUE_HOLDS_BOOLEAN(value))
+        matched = ((g_value_get_boolean(value) ? "true" : "false") == expected);
+      if (matched)
+        break;
+    }
+    if (!matched)
+      return false;
+  }
+
+  if (rule.max_pixels_ > 0) {
+    int width = 0;
+    int height = 0;
+    gst_structure_get_int(structure, "width", &width);
+    gst_structure_get_int(structure, "height", &height);
+    if (width <= 0 || height <= 0 || (gint64)width * height <= rule.max_pixels_)
+      return false;
+  }
+  return true;
+}
+
+bool AutoplugPolicy::MatchScope(const AutoplugRule& rule, GQuark scope) {
+  if (rule.scopes_.empty())
+    return true;
+  for (GQuark allowed : rule.scopes_) {
+    if (allowed == scope)
+      return true;
+  }
+  return false;
+}
+
+int AutoplugPolicy::Evaluate(GQuark scope, GQuark factory, const gchar* factory_name, GstCaps* caps) {
+  std::vector<size_t> candidates;
+  auto exact = by_factory_.find(factory);
+  if (exact != by_factory_.end())
+    candidates = exact->second;
+  for (size_t index : by_prefix_) {
+    for (const std::string& prefix : rules_[index].factory_prefixes_) {
+      if (g_str_has_prefix(factory_name, prefix.c_str())) {
+        candidates.push_back(index);
+        break;
+      }
+    }
+  }
+  if (candidates.empty())
+    return GST_AUTOPLUG_SELECT_TRY;
+
+  // the first rule in table order wins
+  std::sort(candidates.begin(), candidates.end());
+  GstStructure* structure = gst_caps_get_structure(caps, 0);
+  for (size_t index : candidates) {
+    const AutoplugRule& rule = rules_[index];
+    if (MatchScope(rule, scope) && MatchCaps(rule, structure)) {
+      LOG_INFO("autoplug rule [%s] matches %s for %s, result=[%d]",
+               rule.text_.c_str(), factory_name, gst_structure_get_name(structure), rule.result_);
+      return rule.result_;
+    }
+  }
+  return GST_AUTOPLUG_SELECT_TRY;
+}
+
+std::string AutoplugPolicy::DecisionKey(GstStructure* structure) {
+  // only what MatchCaps() looks at, so codec_data, framerate etc. do not multiply the entries
+  std::string key = std::to_string(gst_structure_get_name_id(structure));
+  for (GQuark name : inspected_fields_) {
+    key += "|";
+    // tagged by type, so an absent field, a NULL string and "" give different keys
+    const GValue* value = gst_structure_id_get_value(structure, name);
+    if (!value)
+      key += "-";
+    else if (G_VALUE_HOLDS_STRING(value))
+      key += g_value_get_string(value) ? std::string("s") + g_value_get_string(value) : std::string("n");
+    else if (G_VALUE_HOLDS_INT(value))
+      key += "i" + std::to_string(g_value_get_int(value));
+    else if (G_VALUE_HOLDS_BOOLEAN(value))
+      key += g_value_get_boolean(value) ? "btrue" : "bfalse";
+    else
+      key += "?";  // no rule value matches other types
+  }
+  if (!pixel_limits_.empty()) {
+    // the number of limits the frame size exceeds, not the size itself
+    int width = 0;
+    int height = 0;
+    gst_structure_get_int(structure, "width", &width);
+    gst_structure_get_int(structure, "height", &height);
+    gint64 pixels = (width > 0 && height > 0) ? (gint64)width * height : 0;
+    key += "|" + std::to_string(std::lower_bound(pixel_limits_.begin(), pixel_limits_.end(), pixels) -
+                                pixel_limits_.begin());
+  }
+  return key;
+}
+
+}  // namespace genivimedia
@@ -0,0 +1,112 @@
+// @@@LICENSE
+//
+// Copyright (C) 2023, LG Electronics, All Right Reserved.
+//
+// No part of this source code may be communicated, distributed, reproduced
+// or transmitted in any form or by any means, electronic or mechanical or
+// otherwise, for any purpose, without the prior written permission of
+// LG Electronics.
+//
+// LICENSE@@@
+
+#ifndef GENIVIMEDIA_AUTOPLUG_POLICY_H
+#define GENIVIMEDIA_AUTOPLUG_POLICY_H
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <glib.h>
+#include <gst/gst.h>
+
+namespace genivimedia {
+
+/**
+ * @struct     genivimedia::AutoplugRule
+ * @brief      One entry of the autoplug-select rule table.
+ * @details    A rule matches when the factory, the caps structure name, every field condition, the
+ *             optional resolution limit and the optional scope match. Names are interned as GQuarks.
+ */
+struct AutoplugRule {
+  struct Field {
+    GQuark name_;
+    std::vector<std::string> values_;   /**< any of the values, compared as string or int */
+  };
+
+  std::vector<GQuark> factories_;       /**< exact factory names */
+  std::vector<std::string> factory_prefixes_;  /**< from "name*" patterns */
+  GQuark caps_name_;                    /**< exact caps name, 0 if caps_prefix_ is used */
+  std::string caps_prefix_;             /**< from "audio/*", empty matches any caps */
+  std::vector<Field> fields_;
+  gint64 max_pixels_;                   /**< width * height above it matches, 0 disables */
+  std::vector<GQuark> scopes_;          /**< pipeline names, empty means all */
+  int result_;                          /**< GstAutoplugSelectResult */
+  std::string text_;
+};
+
+/**
+ * @class      genivimedia::AutoplugPolicy
+ * @brief      Rule table for the autoplug-select signal, shared by the video, audio and thumbnail pipelines.
+ * @details    The table is loaded from playerengine.conf (Conf::GetAutoplugRules()), or from kDefaultRules
+ *             when nothing is configured. Entries are separated by ';' and written as
+ *             "<factory[,factory|prefix*]> <caps-name|prefix/*> [field=v1,v2] [max-pixels=N|divx]
+ *             [scope=video_pipeline,...] [result=skip|try|expose]", result being skip by default.
+ *             Select() caches the decision per scope, factory and the caps fields the rules inspect
+ *             (structure name, the field conditions, the side of every max-pixels limit), so the table
+ *             stays bounded by the rules and is evaluated once per distinct combination.
+ *             The default rules are scoped to video_pipeline, thumbnails try every factory as before.
+ * @see        genivimedia::VideoPipeline::HandleAutoplugSelect
+ */
+class AutoplugPolicy {
+ public:
+  static AutoplugPolicy* Instance();
+  static void Destroy();
+
+  /**
+   * @fn LoadRules
+   * @brief Replaces the rule table and clears the decision cache.
+   * @param[in] table : rule string, nullptr loads kDefaultRules
+   * @return int (number of valid rules)
+   */
+  int LoadRules(const gchar* table);
+
+  /**
+   * @fn Select
+   * @brief Returns the autoplug-select result of the factory for the caps.
+   * @param[in] scope : pipeline name, e.g. "video_pipeline"
+   * @param[in] caps : caps of the pad being autoplugged
+   * @param[in] factory : candidate factory
+   * @return int (GstAutoplugSelectResult, GST_AUTOPLUG_SELECT_TRY when no rule matches)
+   */
+  int Select(const gchar* scope, GstCaps* caps, GstElementFactory* factory);
+
+ private:
+  static const gchar* kDefaultRules;
+
+  AutoplugPolicy();
+  ~AutoplugPolicy();
+
+  static bool ParseRule(const std::string& text, AutoplugRule& rule);
+  static bool MatchCaps(const AutoplugRule& rule, GstStructure* structure);
+  static bool MatchScope(const AutoplugRule& rule, GQuark scope);
+  int Evaluate(GQuark scope, GQuark factory, const gchar* factory_name, GstCaps* caps);
+  std::string DecisionKey(GstStructure* structure);
+
+  static AutoplugPolicy* instance_;
+
+  std::mutex mutex_;
+  std::vector<AutoplugRule> rules_;
+  std::map<GQuark, std::vector<size_t>> by_factory_;
+  std::vector<size_t> by_prefix_;
+  std::unordered_map<std::string, int> decisions_;
+  std::vector<GQuark> inspected_fields_;  /**< sorted field names of all rules */
+  std::vector<gint64> pixel_limits_;      /**< sorted max-pixels of all rules */
+  guint hits_;
+  guint misses_;
+};
+
+}  // namespace genivimedia
+
+#endif  // GENIVIMEDIA_AUTOPLUG_POLICY_H
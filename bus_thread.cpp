@@ -0,0 +1,273 @@
+// @@@LICENSE
+//
+// Copyright (C) 2023, LG Electronics, All Right Reserved.
+//
+// No part of this source code may be communicated, distributed, reproduced
+// or transmitted in any form or by any means, electronic or mechanical or
+// otherwise, for any purpose, without the prior written permission of
+// LG Electronics.
+//
+// LICENSE@@@
+
+#include "player/pipeline/bus_thread.h"
+
+#include "logger/player_logger.h"
+
+namespace genivimedia {
+
+struct BusThread::DispatchSource {
+  GSource source_;
+  BusThread* thread_;
+};
+
+struct BusThread::OwnerCall {
+  BusThread* thread_;
+  std::function<void()> func_;
+};
+
+struct QueuedMessage {
+  GstMessage* message_;
+  gint64 queued_time_;
+};
+
+GSourceFuncs BusThread::source_funcs_ = {
+  nullptr,
+  nullptr,
+  BusThread::Dispatch,
+  nullptr,
+};
+
+BusThread::BusThread()
+  : bus_(nullptr),
+    func_(nullptr),
+    user_data_(nullptr),
+    sync_hook_(nullptr),
+    sync_hook_data_(nullptr),
+    queue_(gst_atomic_queue_new(64)),
+    context_(nullptr),
+    loop_(nullptr),
+    source_(nullptr),
+    posting_(0),
+    owner_context_(nullptr),
+    thread_(),
+    owner_mutex_(),
+    owner_calls_(),
+    forwarded_(0),
+    dropped_(0),
+    latency_sum_us_(0),
+    latency_max_us_(0) {
+}
+
+BusThread::~BusThread() {
+  Stop();
+  gst_atomic_queue_unref(queue_);
+}
+
+bool BusThread::Start(GstBus* bus, GstBusFunc func, gpointer user_data) {
+  if (!bus || !func)
+    return false;
+  if (bus_)
+    Stop();
+
+  bus_ = GST_BUS(gst_object_ref(bus));
+  func_ = func;
+  user_data_ = user_data;
+  g_atomic_int_set(&forwarded_, 0);
+  g_atomic_int_set(&dropped_, 0);
+  latency_sum_us_ = 0;
+  latency_max_us_ = 0;
+  owner_context_ = g_main_context_ref_thread_default();
+
+  context_ = g_main_context_new();
+  loop_ = g_main_loop_new(context_, FALSE);
+  GSource* source = g_source_new(&source_funcs_, sizeof(DispatchSource));
+  reinterpret_cast<DispatchSource*>(source)->thread_ = this;
+  g_source_set_ready_time(source, -1);
+  g_source_attach(source, context_);
+  g_atomic_pointer_set(&source_, source);
+
+  // the thread keeps its own references, Stop() may run on the bus thread itself
+  thread_ = std::thread(&BusThread::Loop, g_main_context_ref(context_), g_main_loop_ref(loop_),
+                        g_source_ref(source));
+
+  gst_bus_set_sync_handler(bus_, SyncHandler, this, nullptr);
+  LOG_INFO("bus thread started");
+  return true;
+}
+
+void BusThread::Stop() {
+  if (!bus_)
+    return;
+
+  gst_bus_set_sync_handler(bus_, nullptr, nullptr, nullptr);
+  // a posting thread still inside SyncHandler either sees no source or is waited for here
+  GSource* source = reinterpret_cast<GSource*>(g_atomic_pointer_get(&source_));
+  g_atomic_pointer_set(&source_, nullptr);
+  while (g_atomic_int_get(&posting_) > 0)
+    g_thread_yield();
+
+  // quit from inside the loop, a quit before g_main_loop_run() started would be lost
+  g_main_context_invoke(context_, QuitLoop, loop_);
+  if (thread_.joinable()) {
+    if (thread_.get_id() == std::this_thread::get_id())
+      thread_.detach();  // the loop ends after the running handler, Loop() drops its references
+    else
+      thread_.join();
+  }
+  g_source_destroy(source);
+  g_source_unref(source);
+  g_main_loop_unref(loop_);
+  loop_ = nullptr;
+  g_main_context_unref(context_);
+  context_ = nullptr;
+
+  Drain(false);
+
+  {
+    std::lock_guard<std::mutex> lock(owner_mutex_);
+    for (GSource* call : owner_calls_) {
+      g_source_destroy(call);
+      g_source_unref(call);
+    }
+    owner_calls_.clear();
+  }
+  g_main_context_unref(owner_context_);
+  owner_context_ = nullptr;
+
+  gint forwarded = g_atomic_int_get(&forwarded_);
+  LOG_INFO("bus thread stopped, forwarded=[%d] dropped=[%d] queue latency avg=[%lld]us max=[%lld]us",
+           forwarded, g_atomic_int_get(&dropped_),
+           forwarded ? (latency_sum_us_ / forwarded) : 0ll, latency_max_us_);
+
+  gst_object_unref(bus_);
+  bus_ = nullptr;
+}
+
+void BusThread::SetSyncHook(GstBusSyncHandler hook, gpointer data) {
+  sync_hook_ = hook;
+  sync_hook_data_ = data;
+}
+
+void BusThread::InvokeOwner(const std::function<void()>& func) {
+  if (!bus_ || !owner_context_ || g_main_context_is_owner(owner_context_)) {
+    func();
+    return;
+  }
+
+  OwnerCall* call = new OwnerCall{this, func};
+  GSource* source = g_idle_source_new();
+  g_source_set_callback(source, OwnerCallFunc, call, FreeOwnerCall);
+  std::lock_guard<std::mutex> lock(owner_mutex_);
+  owner_calls_.push_back(source);
+  g_source_attach(source, owner_context_);
+}
+
+gboolean BusThread::OwnerCallFunc(gpointer data) {
+  OwnerCall* call = reinterpret_cast<OwnerCall*>(data);
+  BusThread* self = call->thread_;
+  call->func_();
+
+  // Stop() from within func already dropped every pending call
+  GSource* current = g_main_current_source();
+  std::lock_guard<std::mutex> lock(self->owner_mutex_);
+  for (auto it = self->owner_calls_.begin(); it != self->owner_calls_.end(); ++it) {
+    if (*it == current) {
+      self->owner_calls_.erase(it);
+      g_source_unref(current);
+      break;
+    }
+  }
+  return G_SOURCE_REMOVE;
+}
+
+void BusThread::FreeOwnerCall(gpointer data) {
+  delete reinterpret_cast<OwnerCall*>(data);
+}
+
+GstBusSyncReply BusThread::SyncHandler(GstBus* bus, GstMessage* message, gpointer data) {
+  BusThread* self = reinterpret_cast<BusThread*>(data);
+
+  if (self->sync_hook_ && self->sync_hook_(bus, message, self->sync_hook_data_) == GST_BUS_DROP) {
+    g_atomic_int_inc(&self->dropped_);
+    return GST_BUS_DROP;
+  }
+
+  if (!IsRelevant(message)) {
+    g_atomic_int_inc(&self->dropped_);
+    return GST_BUS_DROP;
+  }
+
+  g_atomic_int_inc(&self->posting_);
+  GSource* source = reinterpret_cast<GSource*>(g_atomic_pointer_get(&self->source_));
+  if (source) {
+    QueuedMessage* queued = g_slice_new(QueuedMessage);
+    queued->message_ = gst_message_ref(message);
+    queued->queued_time_ = g_get_monotonic_time();
+    gst_atomic_queue_push(self->queue_, queued);
+    g_source_set_ready_time(source, 0);
+  }
+  g_atomic_int_add(&self->posting_, -1);
+  return GST_BUS_DROP;
+}
+
+gboolean BusThread::Dispatch(GSource* source, GSourceFunc callback, gpointer data) {
+  BusThread* self = reinterpret_cast<DispatchSource*>(source)->thread_;
+  // re-armed by the next push, so nothing queued after this point is missed
+  g_source_set_ready_time(source, -1);
+  self->Drain(true);
+  return G_SOURCE_CONTINUE;
+}
+
+void BusThread::Loop(GMainContext* context, GMainLoop* loop, GSource* source) {
+  g_main_context_push_thread_default(context);
+  g_main_loop_run(loop);
+  g_main_context_pop_thread_default(context);
+  g_source_unref(source);
+  g_main_loop_unref(loop);
+  g_main_context_unref(context);
+}
+
+gboolean BusThread::QuitLoop(gpointer data) {
+  g_main_loop_quit(reinterpret_cast<GMainLoop*>(data));
+  return G_SOURCE_REMOVE;
+}
+
+bool BusThread::IsRelevant(GstMessage* message) {
+  switch (GST_MESSAGE_TYPE(message)) {
+    case GST_MESSAGE_STATE_CHANGED:
+      // only the pipeline's own state matters, children report the same transition many times
+      return GST_MESSAGE_SRC(message) && !GST_OBJECT_PARENT(GST_MESSAGE_SRC(message));
+    case GST_MESSAGE_QOS:
+    case GST_MESSAGE_TAG:
+    case GST_MESSAGE_STREAM_STATUS:
+    case GST_MESSAGE_PROGRESS:
+    case GST_MESSAGE_ASYNC_START:
+    case GST_MESSAGE_NEW_CLOCK:
+    case GST_MESSAGE_RESET_TIME:
+    case GST_MESSAGE_STEP_START:
+    case GST_MESSAGE_STEP_DONE:
+      return false;
+    default:
+      return true;
+  }
+}
+
+void BusThread::Drain(bool deliver) {
+  QueuedMessage* queued = nullptr;
+  while ((queued = reinterpret_cast<QueuedMessage*>(gst_atomic_queue_pop(queue_))) != nullptr) {
+    if (deliver && func_) {
+      gint64 latency = g_get_monotonic_time() - queued->queued_time_;
+      latency_sum_us_ += latency;
+      if (latency > latency_max_us_)
+        latency_max_us_ = latency;
+      g_atomic_int_inc(&forwarded_);
+      func_(bus_, queued->message_, user_data_);
+    }
+    gst_message_unref(queued->message_);
+    g_slice_free(QueuedMessage, queued);
+    if (deliver && !g_atomic_pointer_get(&source_))
+      deliver = false;  // a handler stopped the thread
+  }
+}
+
+}  // namespace genivimedia
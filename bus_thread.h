@@ -0,0 +1,120 @@
+// @@@LICENSE
+//
+// Copyright (C) 2023, LG Electronics, All Right Reserved.
+//
+// No part of this source code may be communicated, distributed, reproduced
+// or transmitted in any form or by any means, electronic or mechanical or
+// otherwise, for any purpose, without the prior written permission of
+// LG Electronics.
+//
+// LICENSE@@@
+
+#ifndef GENIVIMEDIA_BUS_THREAD_H
+#define GENIVIMEDIA_BUS_THREAD_H
+
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <glib.h>
+#include <gst/gst.h>
+
+namespace genivimedia {
+
+/**
+ * @class      genivimedia::BusThread
+ * @brief      Handles pipeline bus messages on a dedicated thread instead of the default main context.
+ * @details    A sync handler runs on the posting thread and drops messages no pipeline handler uses
+ *             (QoS, stream status, tags, child state changes, ...). The remaining ones are pushed into
+ *             a GstAtomicQueue and dispatched to the registered GstBusFunc from a GSource attached to
+ *             the GMainContext of the bus thread, so D-Bus commands on the default main context and
+ *             bus handling no longer wait for each other. The posting path takes no lock.
+ *             Handlers use InvokeOwner() for the few calls which touch state of the default main
+ *             context, e.g. its timers.
+ *             Queue latency and forwarded/dropped counts are logged when the thread stops.
+ * @see        genivimedia::GstMedia::RegisterWatchBus
+ */
+class BusThread {
+ public:
+  BusThread();
+  ~BusThread();
+
+  /**
+   * @fn Start
+   * @brief Installs the sync handler on the bus and starts the bus thread.
+   * @param[in] bus : pipeline bus
+   * @param[in] func : handler called on the bus thread for every forwarded message
+   * @param[in] user_data : data passed to func
+   * @return bool (TRUE - SUCCESS, FALSE - FAIL)
+   */
+  bool Start(GstBus* bus, GstBusFunc func, gpointer user_data);
+
+  /**
+   * @fn Stop
+   * @brief Removes the sync handler and stops the bus thread. Pending messages and owner calls are
+   *        dropped. May be called from a handler running on the bus thread.
+   * @return None
+   */
+  void Stop();
+
+  bool IsRunning() const { return bus_ != nullptr; }
+
+  /**
+   * @fn SetSyncHook
+   * @brief Sets a handler called on the posting thread for every message before it is filtered.
+   *        GST_BUS_DROP from the hook drops the message. Shall be set before Start().
+   * @param[in] hook : sync handler, nullptr removes it
+   * @param[in] data : data passed to hook
+   * @return None
+   */
+  void SetSyncHook(GstBusSyncHandler hook, gpointer data);
+
+  /**
+   * @fn InvokeOwner
+   * @brief Runs func on the thread-default context of the Start() caller, directly when called there
+   *        or when the thread is not running. Calls still pending at Stop() are dropped.
+   * @param[in] func : call touching main context state
+   * @return None
+   */
+  void InvokeOwner(const std::function<void()>& func);
+
+ private:
+  struct DispatchSource;
+  struct OwnerCall;
+  static GSourceFuncs source_funcs_;
+
+  static GstBusSyncReply SyncHandler(GstBus* bus, GstMessage* message, gpointer data);
+  static gboolean Dispatch(GSource* source, GSourceFunc callback, gpointer data);
+  static void Loop(GMainContext* context, GMainLoop* loop, GSource* source);
+  static gboolean QuitLoop(gpointer data);
+  static gboolean OwnerCallFunc(gpointer data);
+  static void FreeOwnerCall(gpointer data);
+  static bool IsRelevant(GstMessage* message);
+  void Drain(bool deliver);
+
+  GstBus* bus_;
+  GstBusFunc func_;
+  gpointer user_data_;
+  GstBusSyncHandler sync_hook_;
+  gpointer sync_hook_data_;
+  GstAtomicQueue* queue_;
+  GMainContext* context_;
+  GMainLoop* loop_;
+  GSource* source_;          /**< read by the posting threads, g_atomic_pointer_* only */
+  volatile gint posting_;    /**< posting threads between reading source_ and waking it */
+  GMainContext* owner_context_;
+  std::thread thread_;
+
+  std::mutex owner_mutex_;              /**< guards owner_calls_, not taken on the posting path */
+  std::vector<GSource*> owner_calls_;
+
+  volatile gint forwarded_;
+  volatile gint dropped_;
+  gint64 latency_sum_us_;
+  gint64 latency_max_us_;
+};
+
+}  // namespace genivimedia
+
+#endif  // GENIVIMEDIA_BUS_THREAD_H
@@ -11,14 +11,83 @@
 
 #include "service/dbus_player_service.h"
 
+#include <map>
+#include <mutex>
 #include <string>
 #include <iostream>
 
+#include <gio/gunixfdlist.h>
+#include <unistd.h>
+
 #include "logger/player_logger.h"
 #include "player/media_player.h"
+#include "player/pipeline/conf.h"
 
 namespace genivimedia {
 
+namespace {
+
+// time a method call waits for the default main context, which also runs the bus watch unless
+// SUPPORT_BUS_THREAD moves it to BusThread, so both setups can be compared from the log
+struct CommandLatency {
+  std::mutex mutex_;
+  std::map<std::pair<std::string, guint32>, gint64> arrivals_;  /**< (sender, serial) -> arrival */
+  guint count_;
+  gint64 sum_us_;
+  gint64 max_us_;
+  guint filter_id_;
+};
+
+const guint kCommandLatencyReport = 64;
+const size_t kMaxPendingCommands = 256;
+CommandLatency command_latency;
+
+// GDBus worker thread, before the call is queued to the main context
+GDBusMessage* CommandArrivalFilter(GDBusConnection* connection, GDBusMessage* message,
+                                   gboolean incoming, gpointer user_data) {
+  if (!incoming || g_dbus_message_get_message_type(message) != G_DBUS_MESSAGE_TYPE_METHOD_CALL ||
+      g_strcmp0(g_dbus_message_get_path(message), "/com/lge/PlayerEngine") != 0)
+    return message;
+
+  const gchar* sender = g_dbus_message_get_sender(message);
+  std::lock_guard<std::mutex> lock(command_latency.mutex_);
+  if (command_latency.arrivals_.size() >= kMaxPendingCommands)
+    command_latency.arrivals_.clear();  // calls refused before dispatch never come back
+  command_latency.arrivals_[std::make_pair(std::string(sender ? sender : ""),
+                                           g_dbus_message_get_serial(message))] = g_get_monotonic_time();
+  return message;
+}
+
+// main context, right before the handle-* signal of the call
+gboolean CommandDispatched(GDBusInterfaceSkeleton* skeleton, GDBusMethodInvocation* invocation,
+                           gpointer user_data) {
+  GDBusMessage* message = g_dbus_method_invocation_get_message(invocation);
+  const gchar* sender = g_dbus_message_get_sender(message);
+  std::lock_guard<std::mutex> lock(command_latency.mutex_);
+  auto it = command_latency.arrivals_.find(std::make_pair(std::string(sender ? sender : ""),
+                                                          g_dbus_message_get_serial(message)));
+  if (it == command_latency.arrivals_.end())
+    return TRUE;
+
+  gint64 latency = g_get_monotonic_time() - it->second;
+  command_latency.arrivals_.erase(it);
+  command_latency.count_++;
+  command_latency.sum_us_ += latency;
+  if (latency > command_latency.max_us_)
+    command_latency.max_us_ = latency;
+  if (command_latency.count_ == kCommandLatencyReport) {
+    LOG_INFO("D-Bus command latency bus_thread=[%s] commands=[%u] avg=[%lld]us max=[%lld]us",
+             Conf::GetFeatures(SUPPORT_BUS_THREAD) ? "on" : "off", command_latency.count_,
+             command_latency.sum_us_ / command_latency.count_, command_latency.max_us_);
+    command_latency.count_ = 0;
+    command_latency.sum_us_ = 0;
+    command_latency.max_us_ = 0;
+  }
+  return TRUE;
+}
+
+}  // namespace
+
 typedef std::function < void (const std::string& data) > EventCallbackHandler;
 
 std::vector<std::pair<const char*, GCallback>> DBusPlayerService::handler_table_ = {
@@ -43,7 +112,11 @@ std::vector<std::pair<const char*, GCallback>> DBusPlayerService::handler_table_
   {"handle-set-video-brightness",     G_CALLBACK(DBusPlayerService::SetVideoBrightness)},
   {"handle-set-video-contrast",     G_CALLBACK(DBusPlayerService::SetVideoContrast)},
   {"handle-set-video-saturation",     G_CALLBACK(DBusPlayerService::SetVideoSaturation)},
-  {"handle-get-channel-info",      G_CALLBACK(DBusPlayerService::GetChannelInfo)}
+  {"handle-get-channel-info",      G_CALLBACK(DBusPlayerService::GetChannelInfo)},
+  {"handle-get-thread-info",       G_CALLBACK(DBusPlayerService::GetThreadInfo)},
+  {"handle-get-qos-info",          G_CALLBACK(DBusPlayerService::GetQosInfo)},
+  {"handle-extract-thumbnails",    G_CALLBACK(DBusPlayerService::ExtractThumbnails)},
+  {"handle-take-thumbnail",        G_CALLBACK(DBusPlayerService::TakeThumbnail)}
 };
 
 ComLgePlayerEngine* DBusPlayerService::skeleton_ = nullptr;
@@ -320,6 +393,71 @@ gboolean DBusPlayerService::GetChannelInfo(ComLgePlayerEngine *skeleton,
     return true;
 }
 
+gboolean DBusPlayerService::GetThreadInfo(ComLgePlayerEngine *skeleton,
+                            GDBusMethodInvocation *invocation,
+                            gpointer user_data){
+    DBusPlayerService* instance  = (DBusPlayerService*)user_data;
+
+    std::string result = instance->player_->GetThreadInfo();
+
+    com_lge_player_engine_complete_get_thread_info(skeleton, invocation, result.c_str());
+    return true;
+}
+
+gboolean DBusPlayerService::GetQosInfo(ComLgePlayerEngine *skeleton,
+                            GDBusMethodInvocation *invocation,
+                            gpointer user_data){
+    DBusPlayerService* instance  = (DBusPlayerService*)user_data;
+
+    std::string result = instance->player_->GetQosInfo();
+
+    com_lge_player_engine_complete_get_qos_info(skeleton, invocation, result.c_str());
+    return true;
+}
+
+gboolean DBusPlayerService::ExtractThumbnails(ComLgePlayerEngine *skeleton,
+                            GDBusMethodInvocation *invocation,
+                            gchar* option,
+                            gpointer user_data){
+    DBusPlayerService* instance  = (DBusPlayerService*)user_data;
+
+    if (option == NULL)
+      return false;
+
+    bool result = instance->player_->ExtractThumbnails(option);
+
+    com_lge_player_engine_complete_extract_thumbnails(skeleton, invocation, result);
+    return result;
+}
+
+gboolean DBusPlayerService::TakeThumbnail(ComLgePlayerEngine *skeleton,
+                            GDBusMethodInvocation *invocation,
+                            GUnixFDList *fd_list,
+                            gchar* uri,
+                            gpointer user_data){
+    DBusPlayerService* instance  = (DBusPlayerService*)user_data;
+
+    if (uri == NULL)
+      return false;
+
+    gint64 size = 0;
+    int fd = instance->player_->TakeThumbnail(uri, &size);
+    if (fd < 0) {
+      g_dbus_method_invocation_return_error(invocation, G_IO_ERROR, G_IO_ERROR_NOT_FOUND,
+                                            "no thumbnail for %s", uri);
+      return true;
+    }
+
+    // the list holds its own duplicate, the receiver gets the same sealed memfd without a copy
+    GUnixFDList* out_fds = g_unix_fd_list_new();
+    gint index = g_unix_fd_list_append(out_fds, fd, nullptr);
+    close(fd);
+    com_lge_player_engine_complete_take_thumbnail(skeleton, invocation, out_fds,
+                                                  g_variant_new_handle(index), size);
+    g_object_unref(out_fds);
+    return true;
+}
+
 void DBusPlayerService::HandleEvent(const std::string& data) {
   com_lge_player_engine_emit_state_change(skeleton_, data.c_str());
 }
@@ -330,6 +468,11 @@ void DBusPlayerService::OnDBusNameLost(GDBusConnection *connection, const gchar
 
     LOG_INFO("");
     g_signal_handlers_disconnect_by_data(skeleton_,  user_data);
+    g_signal_handlers_disconnect_by_func(skeleton_, (gpointer)CommandDispatched, nullptr);
+    if (connection && command_latency.filter_id_) {
+      g_dbus_connection_remove_filter(connection, command_latency.filter_id_);
+      command_latency.filter_id_ = 0;
+    }
 
     g_dbus_interface_skeleton_unexport_from_connection(G_DBUS_INTERFACE_SKELETON(skeleton_),
                                                         instance->connection_id_);
@@ -352,6 +495,9 @@ void DBusPlayerService::OnDBusNameAcquired(GDBusConnection *connection, const gc
   instance->connection_id_ = connection;
   for (auto& handler : instance->handler_table_)
     g_signal_connect(skeleton_, std::get<0>(handler), std::get<1>(handler), user_data);
+  g_signal_connect(skeleton_, "g-authorize-method", G_CALLBACK(CommandDispatched), nullptr);
+  if (!command_latency.filter_id_)
+    command_latency.filter_id_ = g_dbus_connection_add_filter(connection, CommandArrivalFilter, nullptr, nullptr);
 
   if (g_dbus_interface_skeleton_export(G_DBUS_INTERFACE_SKELETON(skeleton_),
                                    connection,
@@ -0,0 +1,176 @@
+// @@@LICENSE
+//
+// Copyright (C) 2023, LG Electronics, All Right Reserved.
+//
+// No part of this source code may be communicated, distributed, reproduced
+// or transmitted in any form or by any means, electronic or mechanical or
+// otherwise, for any purpose, without the prior written permission of
+// LG Electronics.
+//
+// LICENSE@@@
+
+#include "player/pipeline/element_policy.h"
+
+#include <sstream>
+
+#include "logger/player_logger.h"
+
+namespace genivimedia {
+
+// the former VideoPipeline::ControlAsfContainer()
+const gchar* ElementPolicy::kDefaultRules =
+    "asfdemux ignore-eos=true scope=video_pipeline";
+
+ElementPolicy* ElementPolicy::instance_ = nullptr;
+
+ElementPolicy* ElementPolicy::Instance() {
+  if (instance_ == nullptr) {
+    instance_ = new ElementPolicy();
+  }
+  return instance_;
+}
+
+void ElementPolicy::Destroy() {
+  if (instance_) {
+    delete instance_;
+    instance_ = nullptr;
+  }
+}
+
+ElementPolicy::ElementPolicy()
+  : mutex_(),
+    rules_(),
+    by_factory_(),
+    by_prefix_(),
+    applied_(0) {
+  LoadRules(nullptr);
+}
+
+ElementPolicy::~ElementPolicy() {
+  LOG_INFO("applied=[%u]", applied_);
+}
+
+int ElementPolicy::LoadRules(const gchar* table) {
+  std::vector<ElementRule> rules;
+  std::stringstream stream(table ? table : kDefaultRules);
+  std::string entry;
+  while (std::getline(stream, entry, ';')) {
+    ElementRule rule;
+    if (ParseRule(entry, rule))
+      rules.push_back(rule);
+    else if (entry.find_first_not_of(" \t") != std::string::npos)
+      LOG_ERROR("Invalid element rule [%s]", entry.c_str());
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  rules_.swap(rules);
+  by_factory_.clear();
+  by_prefix_.clear();
+  for (size_t i = 0; i < rules_.size(); i++) {
+    for (GQuark factory : rules_[i].factories_)
+      by_factory_[factory].push_back(i);
+    if (!rules_[i].factory_prefixes_.empty())
+      by_prefix_.push_back(i);
+  }
+  LOG_INFO("%u element rules loaded%s", (guint)rules_.size(), table ? "" : " (default)");
+  return (int)rules_.size();
+}
+
+int ElementPolicy::Apply(const gchar* scope, GstElement* element) {
+  GstElementFactory* factory = element ? gst_element_get_factory(element) : nullptr;
+  if (!factory)
+    return 0;
+
+  const gchar* factory_name = gst_plugin_feature_get_name(GST_PLUGIN_FEATURE_CAST(factory));
+  GQuark scope_quark = g_quark_from_string(scope ? scope : "");
+  int count = 0;
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto exact = by_factory_.find(g_quark_from_string(factory_name));
+  if (exact != by_factory_.end()) {
+    for (size_t index : exact->second) {
+      if (MatchScope(rules_[index], scope_quark))
+        count += ApplyRule(rules_[index], element);
+    }
+  }
+  for (size_t index : by_prefix_) {
+    const ElementRule& rule = rules_[index];
+    if (!MatchScope(rule, scope_quark))
+      continue;
+    for (const std::string& prefix : rule.factory_prefixes_) {
+      if (g_str_has_prefix(factory_name, prefix.c_str())) {
+        count += ApplyRule(rule, element);
+        break;
+      }
+    }
+  }
+  applied_ += count;
+  return count;
+}
+
+bool ElementPolicy::ParseRule(const std::string& text, ElementRule& rule) {
+  std::stringstream stream(text);
+  std::string factories;
+  if (!(stream >> factories))
+    return false;
+
+  std::stringstream factory_stream(factories);
+  std::string factory;
+  while (std::getline(factory_stream, factory, ',')) {
+    if (factory.empty())
+      continue;
+    if (factory.back() == '*')
+      rule.factory_prefixes_.push_back(factory.substr(0, factory.size() - 1));
+    else
+      rule.factories_.push_back(g_quark_from_string(factory.c_str()));
+  }
+  if (rule.factories_.empty() && rule.factory_prefixes_.empty())
+    return false;
+  rule.text_ = text;
+
+  std::string token;
+  while (stream >> token) {
+    size_t pos = token.find('=');
+    if (pos == std::string::npos || pos == 0)
+      return false;
+    std::string key = token.substr(0, pos);
+    std::string value = token.substr(pos + 1);
+
+    if (key == "scope") {
+      std::stringstream scope_stream(value);
+      std::string scope;
+      while (std::getline(scope_stream, scope, ','))
+        rule.scopes_.push_back(g_quark_from_string(scope.c_str()));
+    } else {
+      rule.properties_.push_back(std::make_pair(key, value));
+    }
+  }
+  return !rule.properties_.empty();
+}
+
+bool ElementPolicy::MatchScope(const ElementRule& rule, GQuark scope) {
+  if (rule.scopes_.empty())
+    return true;
+  for (GQuark allowed : rule.scopes_) {
+    if (allowed == scope)
+      return true;
+  }
+  return false;
+}
+
+int ElementPolicy::ApplyRule(const ElementRule& rule, GstElement* element) {
+  int count = 0;
+  for (const auto& property : rule.properties_) {
+    if (!g_object_class_find_property(G_OBJECT_GET_CLASS(element), property.first.c_str())) {
+      LOG_ERROR("%s has no property [%s], rule [%s]", GST_ELEMENT_NAME(element),
+                property.first.c_str(), rule.text_.c_str());
+      continue;
+    }
+    gst_util_set_object_arg(G_OBJECT(element), property.first.c_str(), property.second.c_str());
+    LOG_INFO("%s: %s=%s", GST_ELEMENT_NAME(element), property.first.c_str(), property.second.c_str());
+    count++;
+  }
+  return count;
+}
+
+}  // namespace genivimedia
@@ -0,0 +1,95 @@
+// @@@LICENSE
+//
+// Copyright (C) 2023, LG Electronics, All Right Reserved.
+//
+// No part of this source code may be communicated, distributed, reproduced
+// or transmitted in any form or by any means, electronic or mechanical or
+// otherwise, for any purpose, without the prior written permission of
+// LG Electronics.
+//
+// LICENSE@@@
+
+#ifndef GENIVIMEDIA_ELEMENT_POLICY_H
+#define GENIVIMEDIA_ELEMENT_POLICY_H
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <glib.h>
+#include <gst/gst.h>
+
+namespace genivimedia {
+
+/**
+ * @struct     genivimedia::ElementRule
+ * @brief      Property set applied to the elements of the listed factories.
+ */
+struct ElementRule {
+  std::vector<GQuark> factories_;       /**< exact factory names */
+  std::vector<std::string> factory_prefixes_;  /**< from "name*" patterns */
+  std::vector<std::pair<std::string, std::string>> properties_;  /**< name, value as in gst-launch */
+  std::vector<GQuark> scopes_;          /**< pipeline names, empty means all */
+  std::string text_;
+};
+
+/**
+ * @class      genivimedia::ElementPolicy
+ * @brief      Sets configured properties on elements at the moment they are added to a pipeline.
+ * @details    GstMedia connects Apply() to "deep-element-added" of every pipeline it creates and runs
+ *             it once on the elements already inside (gst_parse_launch), so the properties are set
+ *             before the element leaves NULL state, including elements created inside uridecodebin,
+ *             decodebin and playsink. The thumbnail pipelines use the scope "thumbnail_pipeline". The table is loaded from playerengine.conf
+ *             (Conf::GetElementProperties()), or from kDefaultRules when nothing is configured. Entries
+ *             are separated by ';' and written as
+ *             "<factory[,factory|prefix*]> <property=value>... [scope=video_pipeline,...]".
+ *             Values are parsed against the property type like gst-launch does. A property the element
+ *             does not have is logged and skipped.
+ * @see        genivimedia::GstMedia::RegisterElementPolicy
+ */
+class ElementPolicy {
+ public:
+  static ElementPolicy* Instance();
+  static void Destroy();
+
+  /**
+   * @fn LoadRules
+   * @brief Replaces the rule table.
+   * @param[in] table : rule string, nullptr loads kDefaultRules
+   * @return int (number of valid rules)
+   */
+  int LoadRules(const gchar* table);
+
+  /**
+   * @fn Apply
+   * @brief Sets the properties of every matching rule on the element.
+   * @param[in] scope : pipeline name, e.g. "video_pipeline"
+   * @param[in] element : element just added
+   * @return int (number of properties set)
+   */
+  int Apply(const gchar* scope, GstElement* element);
+
+ private:
+  static const gchar* kDefaultRules;
+
+  ElementPolicy();
+  ~ElementPolicy();
+
+  static bool ParseRule(const std::string& text, ElementRule& rule);
+  static bool MatchScope(const ElementRule& rule, GQuark scope);
+  int ApplyRule(const ElementRule& rule, GstElement* element);
+
+  static ElementPolicy* instance_;
+
+  std::mutex mutex_;
+  std::vector<ElementRule> rules_;
+  std::map<GQuark, std::vector<size_t>> by_factory_;
+  std::vector<size_t> by_prefix_;
+  guint applied_;
+};
+
+}  // namespace genivimedia
+
+#endif  // GENIVIMEDIA_ELEMENT_POLICY_H
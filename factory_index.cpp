@@ -0,0 +1,171 @@
+// @@@LICENSE
+//
+// Copyright (C) 2023, LG Electronics, All Right Reserved.
+//
+// No part of this source code may be communicated, distributed, reproduced
+// or transmitted in any form or by any means, electronic or mechanical or
+// otherwise, for any purpose, without the prior written permission of
+// LG Electronics.
+//
+// LICENSE@@@
+
+#include "player/pipeline/factory_index.h"
+
+#include <algorithm>
+#include <set>
+
+#include "logger/player_logger.h"
+
+namespace genivimedia {
+
+FactoryIndex* FactoryIndex::instance_ = nullptr;
+
+FactoryIndex* FactoryIndex::Instance() {
+  if (instance_ == nullptr) {
+    instance_ = new FactoryIndex();
+  }
+  return instance_;
+}
+
+void FactoryIndex::Destroy() {
+  if (instance_) {
+    delete instance_;
+    instance_ = nullptr;
+  }
+}
+
+FactoryIndex::FactoryIndex()
+  : mutex_(),
+    index_(),
+    any_caps_(),
+    lookup_cache_(),
+    hits_(0),
+    misses_(0) {
+}
+
+FactoryIndex::~FactoryIndex() {
+  LOG_INFO("hit=[%u] miss=[%u]", hits_, misses_);
+  std::lock_guard<std::mutex> lock(mutex_);
+  ClearLocked();
+}
+
+void FactoryIndex::Build(GstElementFactoryListType type) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  BuildLocked(type);
+}
+
+GstElementFactory* FactoryIndex::Lookup(GstElementFactoryListType type, GstCaps* caps) {
+  if (!caps || gst_caps_is_empty(caps) || gst_caps_is_any(caps))
+    return nullptr;
+
+  gchar* caps_info = gst_caps_to_string(caps);
+  std::string key = std::to_string((guint64)type) + "|" + caps_info;
+  g_free(caps_info);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto cached = lookup_cache_.find(key);
+  if (cached != lookup_cache_.end()) {
+    hits_++;
+    return cached->second;
+  }
+  misses_++;
+
+  NameIndex& names = BuildLocked(type);
+  std::vector<GstElementFactory*> candidates;
+  std::set<GstElementFactory*> seen;
+  for (guint i = 0; i < gst_caps_get_size(caps); i++) {
+    auto iter = names.find(gst_structure_get_name(gst_caps_get_structure(caps, i)));
+    if (iter == names.end())
+      continue;
+    for (GstElementFactory* factory : iter->second) {
+      if (seen.insert(factory).second)
+        candidates.push_back(factory);
+    }
+  }
+  for (GstElementFactory* factory : any_caps_[type]) {
+    if (seen.insert(factory).second)
+      candidates.push_back(factory);
+  }
+
+  // candidates of several structures / ANY templates are merged, so restore the rank order
+  std::stable_sort(candidates.begin(), candidates.end(),
+                   [](GstElementFactory* a, GstElementFactory* b) {
+                     return gst_plugin_feature_rank_compare_func(a, b) < 0;
+                   });
+
+  GstElementFactory* found = nullptr;
+  for (GstElementFactory* factory : candidates) {
+    if (gst_element_factory_can_sink_any_caps(factory, caps)) {
+      found = factory;
+      break;
+    }
+  }
+  lookup_cache_[key] = found;
+  return found;
+}
+
+void FactoryIndex::Invalidate() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  LOG_INFO("factory index invalidated, hit=[%u] miss=[%u]", hits_, misses_);
+  ClearLocked();
+}
+
+FactoryIndex::NameIndex& FactoryIndex::BuildLocked(GstElementFactoryListType type) {
+  auto built = index_.find(type);
+  if (built != index_.end())
+    return built->second;
+
+  NameIndex& names = index_[type];
+  std::vector<GstElementFactory*>& any_caps = any_caps_[type];
+
+  GList* element_list = gst_element_factory_list_get_elements(type, GST_RANK_MARGINAL);
+  element_list = g_list_sort(element_list, (GCompareFunc)gst_plugin_feature_rank_compare_func);
+
+  guint count = 0;
+  for (GList* walk = element_list; walk; walk = walk->next) {
+    GstElementFactory* factory = GST_ELEMENT_FACTORY_CAST(walk->data);
+    const GList* templates = gst_element_factory_get_static_pad_templates(factory);
+    for (; templates; templates = templates->next) {
+      GstStaticPadTemplate* templ = reinterpret_cast<GstStaticPadTemplate*>(templates->data);
+      if (templ->direction != GST_PAD_SINK)
+        continue;
+
+      GstCaps* templ_caps = gst_static_caps_get(&templ->static_caps);
+      if (gst_caps_is_any(templ_caps)) {
+        any_caps.push_back(GST_ELEMENT_FACTORY_CAST(gst_object_ref(factory)));
+      } else {
+        for (guint i = 0; i < gst_caps_get_size(templ_caps); i++) {
+          std::vector<GstElementFactory*>& list =
+              names[gst_structure_get_name(gst_caps_get_structure(templ_caps, i))];
+          if (list.empty() || list.back() != factory)
+            list.push_back(GST_ELEMENT_FACTORY_CAST(gst_object_ref(factory)));
+        }
+      }
+      gst_caps_unref(templ_caps);
+    }
+    count++;
+  }
+  gst_plugin_feature_list_free(element_list);
+
+  LOG_INFO("indexed %u factories under %u caps names for type=[0x%llx]",
+           count, (guint)names.size(), (unsigned long long)type);
+  return names;
+}
+
+void FactoryIndex::ClearLocked() {
+  for (auto& type : index_) {
+    for (auto& entry : type.second) {
+      for (GstElementFactory* factory : entry.second)
+        gst_object_unref(factory);
+    }
+  }
+  for (auto& type : any_caps_) {
+    for (GstElementFactory* factory : type.second)
+      gst_object_unref(factory);
+  }
+  index_.clear();
+  any_caps_.clear();
+  lookup_cache_.clear();
+}
+
+}  // namespace genivimedia
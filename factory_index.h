@@ -0,0 +1,80 @@
+// @@@LICENSE
+//
+// Copyright (C) 2023, LG Electronics, All Right Reserved.
+//
+// No part of this source code may be communicated, distributed, reproduced
+// or transmitted in any form or by any means, electronic or mechanical or
+// otherwise, for any purpose, without the prior written permission of
+// LG Electronics.
+//
+// LICENSE@@@
+
+#ifndef GENIVIMEDIA_FACTORY_INDEX_H
+#define GENIVIMEDIA_FACTORY_INDEX_H
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <glib.h>
+#include <gst/gst.h>
+
+namespace genivimedia {
+
+/**
+ * @class      genivimedia::FactoryIndex
+ * @brief      Index of element factories by factory type and sink caps structure name.
+ * @details    The registry is walked once per factory type. Each factory is filed under the structure
+ *             names of its sink pad templates, in rank order. Lookup() checks only those candidates
+ *             against the caps and remembers the answer per caps string, so repeated lookups are
+ *             hash hits. Invalidate() shall be called whenever ranks change (Conf::SetRank()).
+ * @see        genivimedia::GstMedia::FindElementFactory
+ */
+class FactoryIndex {
+ public:
+  static FactoryIndex* Instance();
+  static void Destroy();
+
+  /**
+   * @fn Build
+   * @brief Indexes the factories of the given type if not done yet.
+   * @param[in] type : GstElementFactoryListType, e.g. GST_ELEMENT_FACTORY_TYPE_DECODABLE
+   * @return None
+   */
+  void Build(GstElementFactoryListType type);
+
+  /**
+   * @fn Lookup
+   * @brief Returns the highest ranked factory of the type which can sink the caps.
+   * @param[in] type : GstElementFactoryListType
+   * @param[in] caps : fixed or unfixed caps
+   * @return GstElementFactory* (owned by the registry) or nullptr
+   */
+  GstElementFactory* Lookup(GstElementFactoryListType type, GstCaps* caps);
+
+  void Invalidate();
+
+ private:
+  typedef std::unordered_map<std::string, std::vector<GstElementFactory*>> NameIndex;
+
+  FactoryIndex();
+  ~FactoryIndex();
+
+  NameIndex& BuildLocked(GstElementFactoryListType type);
+  void ClearLocked();
+
+  static FactoryIndex* instance_;
+
+  std::mutex mutex_;
+  std::map<GstElementFactoryListType, NameIndex> index_;
+  std::map<GstElementFactoryListType, std::vector<GstElementFactory*>> any_caps_;
+  std::unordered_map<std::string, GstElementFactory*> lookup_cache_;
+  guint hits_;
+  guint misses_;
+};
+
+}  // namespace genivimedia
+
+#endif  // GENIVIMEDIA_FACTORY_INDEX_H
@@ -0,0 +1,459 @@
+// @@@LICENSE
+//
+// Copyright (C) 2023, LG Electronics, All Right Reserved.
+//
+// No part of this source code may be communicated, distributed, reproduced
+// or transmitted in any form or by any means, electronic or mechanical or
+// otherwise, for any purpose, without the prior written permission of
+// LG Electronics.
+//
+// LICENSE@@@
+
+#include "player/pipeline/fast_path_bin.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include <map>
+#include <mutex>
+#include <string>
+
+#include "logger/player_logger.h"
+#include "player/pipeline/autoplug_policy.h"
+#include "player/pipeline/factory_index.h"
+
+namespace genivimedia {
+
+namespace {
+
+struct PathStats {
+  guint count_;
+  gint64 sum_us_;
+  gint64 max_us_;
+};
+
+// load-to-ASYNC_DONE per pipeline, path_[0] uridecodebin, path_[1] fast path
+struct LoadStats {
+  PathStats path_[2];
+};
+
+std::mutex load_stats_mutex;
+std::map<std::string, LoadStats> load_stats;
+
+}  // namespace
+
+struct FastPathBin::Context {
+  GstElement* bin_;
+  std::string scope_;
+  bool with_audio_;
+  guint video_count_;
+  guint audio_count_;
+  bool fallback_;
+};
+
+typedef struct _GeniviFastPathSrc {
+  GstBin parent_;
+  gchar* uri_;
+  bool built_;
+} GeniviFastPathSrc;
+
+typedef struct _GeniviFastPathSrcClass {
+  GstBinClass parent_class_;
+} GeniviFastPathSrcClass;
+
+GType genivi_fast_path_src_get_type(void);
+static void genivi_fast_path_src_uri_handler_init(gpointer g_iface, gpointer iface_data);
+G_DEFINE_TYPE_WITH_CODE(GeniviFastPathSrc, genivi_fast_path_src, GST_TYPE_BIN,
+                        G_IMPLEMENT_INTERFACE(GST_TYPE_URI_HANDLER, genivi_fast_path_src_uri_handler_init))
+
+#define GENIVI_FAST_PATH_SRC(obj) \
+  (G_TYPE_CHECK_INSTANCE_CAST((obj), genivi_fast_path_src_get_type(), GeniviFastPathSrc))
+
+static GstURIType genivi_fast_path_src_uri_get_type(GType type) {
+  return GST_URI_SRC;
+}
+
+static const gchar* const* genivi_fast_path_src_uri_get_protocols(GType type) {
+  static const gchar* protocols[] = {FAST_PATH_URI_PROTOCOL, nullptr};
+  return protocols;
+}
+
+static gchar* genivi_fast_path_src_uri_get_uri(GstURIHandler* handler) {
+  GeniviFastPathSrc* self = GENIVI_FAST_PATH_SRC(handler);
+  GST_OBJECT_LOCK(self);
+  gchar* uri = self->uri_ ? g_strconcat(FAST_PATH_URI_PROTOCOL, self->uri_ + strlen("file"), nullptr) : nullptr;
+  GST_OBJECT_UNLOCK(self);
+  return uri;
+}
+
+static gboolean genivi_fast_path_src_uri_set_uri(GstURIHandler* handler, const gchar* uri, GError** error) {
+  GeniviFastPathSrc* self = GENIVI_FAST_PATH_SRC(handler);
+  if (!g_str_has_prefix(uri, FAST_PATH_URI_PROTOCOL "://")) {
+    g_set_error(error, GST_URI_ERROR, GST_URI_ERROR_BAD_URI, "not a %s uri", FAST_PATH_URI_PROTOCOL);
+    return FALSE;
+  }
+  GST_OBJECT_LOCK(self);
+  g_free(self->uri_);
+  // the chain reads the file:// uri with the same path
+  self->uri_ = g_strconcat("file", uri + strlen(FAST_PATH_URI_PROTOCOL), nullptr);
+  GST_OBJECT_UNLOCK(self);
+  return TRUE;
+}
+
+static void genivi_fast_path_src_uri_handler_init(gpointer g_iface, gpointer iface_data) {
+  GstURIHandlerInterface* iface = reinterpret_cast<GstURIHandlerInterface*>(g_iface);
+  iface->get_type = genivi_fast_path_src_uri_get_type;
+  iface->get_protocols = genivi_fast_path_src_uri_get_protocols;
+  iface->get_uri = genivi_fast_path_src_uri_get_uri;
+  iface->set_uri = genivi_fast_path_src_uri_set_uri;
+}
+
+static GstStateChangeReturn genivi_fast_path_src_change_state(GstElement* element, GstStateChange transition) {
+  GeniviFastPathSrc* self = GENIVI_FAST_PATH_SRC(element);
+  if (transition == GST_STATE_CHANGE_NULL_TO_READY && !self->built_) {
+    // the scope of the autoplug policy is the playbin which owns the uridecodebin of this source
+    GstObject* top = GST_OBJECT(gst_object_ref(element));
+    GstObject* parent = nullptr;
+    while ((parent = gst_object_get_parent(top)) != nullptr) {
+      gst_object_unref(top);
+      top = parent;
+    }
+    gchar* scope = gst_object_get_name(top);
+    gst_object_unref(top);
+
+    self->built_ = true;
+    FastPathKind kind = FastPathBin::Probe(self->uri_);
+    if (!FastPathBin::Build(element, kind, self->uri_, scope, true)) {
+      // no pads will come, the owner reloads with the file:// uri
+      gst_element_post_message(element,
+                               gst_message_new_application(GST_OBJECT(element),
+                                   gst_structure_new(FAST_PATH_FALLBACK_MESSAGE,
+                                                     "reason", G_TYPE_STRING, "build", nullptr)));
+    }
+    g_free(scope);
+  }
+  return GST_ELEMENT_CLASS(genivi_fast_path_src_parent_class)->change_state(element, transition);
+}
+
+static void genivi_fast_path_src_finalize(GObject* object) {
+  GeniviFastPathSrc* self = GENIVI_FAST_PATH_SRC(object);
+  g_free(self->uri_);
+  G_OBJECT_CLASS(genivi_fast_path_src_parent_class)->finalize(object);
+}
+
+static void genivi_fast_path_src_class_init(GeniviFastPathSrcClass* klass) {
+  GObjectClass* gobject_class = G_OBJECT_CLASS(klass);
+  GstElementClass* element_class = GST_ELEMENT_CLASS(klass);
+
+  gobject_class->finalize = genivi_fast_path_src_finalize;
+  // sometimes pads make uridecodebin wait for pad-added and no-more-pads of the source
+  gst_element_class_add_pad_template(element_class,
+      gst_pad_template_new("video_%u", GST_PAD_SRC, GST_PAD_SOMETIMES, GST_CAPS_ANY));
+  gst_element_class_add_pad_template(element_class,
+      gst_pad_template_new("audio_%u", GST_PAD_SRC, GST_PAD_SOMETIMES, GST_CAPS_ANY));
+  gst_element_class_set_static_metadata(element_class, "Fast path source",
+      "Source/File", "Decodes local MP4 and MP3 files with a fixed chain instead of decodebin",
+      "LG Electronics");
+  element_class->change_state = genivi_fast_path_src_change_state;
+}
+
+static void genivi_fast_path_src_init(GeniviFastPathSrc* self) {
+  self->uri_ = nullptr;
+  self->built_ = false;
+}
+
+void FastPathBin::FreeContext(gpointer data) {
+  delete reinterpret_cast<Context*>(data);
+}
+
+FastPathKind FastPathBin::Probe(const gchar* uri) {
+  if (!uri || !g_str_has_prefix(uri, "file://"))
+    return FAST_PATH_NONE;
+
+  gchar* location = g_filename_from_uri(uri, nullptr, nullptr);
+  if (!location)
+    return FAST_PATH_NONE;
+
+  guint8 header[12] = {0,};
+  size_t size = 0;
+  FILE* fp = fopen(location, "rb");
+  if (fp) {
+    size = fread(header, 1, sizeof(header), fp);
+    fclose(fp);
+  }
+  g_free(location);
+  if (size < sizeof(header))
+    return FAST_PATH_NONE;
+
+  if (memcmp(header + 4, "ftyp", 4) == 0) {
+    static const char* brands[] = {"isom", "iso2", "mp41", "mp42", "avc1", "M4V ", "M4A "};
+    for (const char* brand : brands) {
+      if (memcmp(header + 8, brand, 4) == 0)
+        return FAST_PATH_MP4;
+    }
+    return FAST_PATH_NONE;
+  }
+
+  // ID3v2 tag, or a MPEG audio frame sync with layer III
+  if (memcmp(header, "ID3", 3) == 0 ||
+      (header[0] == 0xFF && (header[1] & 0xE0) == 0xE0 && (header[1] & 0x06) == 0x02))
+    return FAST_PATH_MP3;
+  return FAST_PATH_NONE;
+}
+
+GstElement* FastPathBin::Create(FastPathKind kind, const gchar* uri, const gchar* name,
+                                const gchar* scope, bool with_audio) {
+  GstElement* bin = gst_bin_new(name);
+  if (!bin) {
+    LOG_ERROR("Failed to create fast path bin");
+    return nullptr;
+  }
+  if (!Build(bin, kind, uri, scope, with_audio)) {
+    gst_object_unref(bin);
+    return nullptr;
+  }
+  return bin;
+}
+
+gchar* FastPathBin::GetSourceUri(const gchar* uri) {
+  static gsize registered = 0;
+  if (g_once_init_enter(&registered)) {
+    gboolean ret = gst_element_register(nullptr, FAST_PATH_SRC_FACTORY_NAME, GST_RANK_NONE,
+                                        genivi_fast_path_src_get_type());
+    if (!ret)
+      LOG_ERROR("Failed to register %s", FAST_PATH_SRC_FACTORY_NAME);
+    g_once_init_leave(&registered, ret ? 1 : 2);
+  }
+  if (registered != 1 || Probe(uri) == FAST_PATH_NONE)
+    return nullptr;
+  return g_strconcat(FAST_PATH_URI_PROTOCOL, uri + strlen("file"), nullptr);
+}
+
+void FastPathBin::ReportLoad(const gchar* scope, bool fast_path, gint64 elapsed_us) {
+  if (!scope)
+    scope = "";
+  std::lock_guard<std::mutex> lock(load_stats_mutex);
+  PathStats* stats = load_stats[scope].path_;
+  PathStats* path = &stats[fast_path ? 1 : 0];
+  path->count_++;
+  path->sum_us_ += elapsed_us;
+  if (elapsed_us > path->max_us_)
+    path->max_us_ = elapsed_us;
+  LOG_INFO("[%s] load-to-ASYNC_DONE path=[%s] [%lld]us, uridecodebin avg=[%lld]us max=[%lld]us n=[%u], "
+           "fast avg=[%lld]us max=[%lld]us n=[%u]", scope, fast_path ? "fast" : "uridecodebin", elapsed_us,
+           stats[0].count_ ? stats[0].sum_us_ / stats[0].count_ : 0ll, stats[0].max_us_, stats[0].count_,
+           stats[1].count_ ? stats[1].sum_us_ / stats[1].count_ : 0ll, stats[1].max_us_, stats[1].count_);
+}
+
+bool FastPathBin::Build(GstElement* bin, FastPathKind kind, const gchar* uri, const gchar* scope,
+                        bool with_audio) {
+  if (kind == FAST_PATH_NONE || !uri)
+    return false;
+
+  gchar* location = g_filename_from_uri(uri, nullptr, nullptr);
+  if (!location)
+    return false;
+
+  GstElement* src = gst_element_factory_make("filesrc", nullptr);
+  if (!src) {
+    LOG_ERROR("Failed to create fast path source");
+    g_free(location);
+    return false;
+  }
+  g_object_set(G_OBJECT(src), "location", location, nullptr);
+  gst_bin_add(GST_BIN(bin), src);
+
+  Context* context = new Context();
+  context->bin_ = bin;
+  context->scope_ = scope ? scope : "";
+  context->with_audio_ = with_audio;
+  context->video_count_ = 0;
+  context->audio_count_ = 0;
+  context->fallback_ = false;
+  g_object_set_data_full(G_OBJECT(bin), "fast-path-context", context, FreeContext);
+
+  bool ret = (kind == FAST_PATH_MP4) ? BuildMp4(context, src) : BuildMp3(context, src, location);
+  g_free(location);
+  if (ret)
+    LOG_INFO("fast path bin [%s] for kind=[%d]", GST_ELEMENT_NAME(bin), kind);
+  return ret;
+}
+
+bool FastPathBin::BuildMp4(Context* context, GstElement* src) {
+  GstCaps* caps = gst_caps_new_empty_simple("video/quicktime");
+  GstElement* demux = MakeFromRank(context, GST_ELEMENT_FACTORY_TYPE_DEMUXER, caps);
+  gst_caps_unref(caps);
+  if (!demux)
+    return false;
+
+  gst_bin_add(GST_BIN(context->bin_), demux);
+  if (!gst_element_link(src, demux))
+    return false;
+  g_signal_connect(demux, "pad-added", G_CALLBACK(PadAddedCallback), context);
+  g_signal_connect(demux, "no-more-pads", G_CALLBACK(NoMorePadsCallback), context);
+  return true;
+}
+
+bool FastPathBin::BuildMp3(Context* context, GstElement* src, const gchar* location) {
+  GstElement* upstream = src;
+  guint8 header[3] = {0,};
+  FILE* fp = fopen(location, "rb");
+  if (fp) {
+    if (fread(header, 1, sizeof(header), fp) != sizeof(header))
+      memset(header, 0, sizeof(header));
+    fclose(fp);
+  }
+
+  if (memcmp(header, "ID3", 3) == 0) {
+    GstCaps* caps = gst_caps_new_empty_simple("application/x-id3");
+    GstElement* tag_demux = MakeFromRank(context, GST_ELEMENT_FACTORY_TYPE_DEMUXER, caps);
+    gst_caps_unref(caps);
+    if (!tag_demux)
+      return false;
+    gst_bin_add(GST_BIN(context->bin_), tag_demux);
+    if (!gst_element_link(src, tag_demux))
+      return false;
+    upstream = tag_demux;
+  }
+
+  // the tag demuxer exposes its src pad only after reading the tag, so the chain is linked lazily
+  if (upstream != src) {
+    g_signal_connect(upstream, "pad-added", G_CALLBACK(PadAddedCallback), context);
+    g_signal_connect(upstream, "no-more-pads", G_CALLBACK(NoMorePadsCallback), context);
+    return true;
+  }
+
+  GstPad* pad = gst_element_get_static_pad(src, "src");
+  GstCaps* caps = gst_caps_new_simple("audio/mpeg", "mpegversion", G_TYPE_INT, 1,
+                                      "layer", G_TYPE_INT, 3, nullptr);
+  GstPad* decoded = LinkDecodeChain(context, pad, caps);
+  gst_caps_unref(caps);
+  gst_object_unref(pad);
+  if (!decoded)
+    return false;
+  ExposePad(context, decoded, false);
+  gst_object_unref(decoded);
+  gst_element_no_more_pads(context->bin_);
+  return true;
+}
+
+void FastPathBin::PadAddedCallback(GstElement* demux, GstPad* pad, gpointer data) {
+  Context* context = reinterpret_cast<Context*>(data);
+  if (context->fallback_)
+    return;
+
+  GstCaps* caps = gst_pad_get_current_caps(pad);
+  if (!caps)
+    caps = gst_pad_query_caps(pad, nullptr);
+  if (!caps || gst_caps_is_empty(caps)) {
+    if (caps)
+      gst_caps_unref(caps);
+    return;
+  }
+
+  const gchar* name = gst_structure_get_name(gst_caps_get_structure(caps, 0));
+  bool is_video = g_str_has_prefix(name, "video/");
+  bool is_audio = g_str_has_prefix(name, "audio/");
+
+  // only the first video stream is decoded, like a thumbnail or a single video sink needs
+  if ((is_audio && !context->with_audio_) || (is_video && context->video_count_ > 0) ||
+      (!is_video && !is_audio)) {
+    LOG_INFO("fast path ignores [%s]", name);
+  } else if (is_audio && context->audio_count_ > 0) {
+    // playbin switches audio languages between decoded streams, uridecodebin decodes them all
+    Fallback(context, "second audio stream");
+  } else if ((is_video && g_strcmp0(name, "video/x-h264") == 0) ||
+             (is_audio && g_strcmp0(name, "audio/mpeg") == 0)) {
+    GstPad* decoded = LinkDecodeChain(context, pad, caps);
+    if (decoded) {
+      ExposePad(context, decoded, is_video);
+      gst_object_unref(decoded);
+    } else {
+      Fallback(context, name);
+    }
+  } else {
+    Fallback(context, name);
+  }
+  gst_caps_unref(caps);
+}
+
+void FastPathBin::NoMorePadsCallback(GstElement* demux, gpointer data) {
+  Context* context = reinterpret_cast<Context*>(data);
+  if (!context->fallback_)
+    gst_element_no_more_pads(context->bin_);
+}
+
+GstPad* FastPathBin::LinkDecodeChain(Context* context, GstPad* pad, GstCaps* caps) {
+  GstElement* queue = gst_element_factory_make("queue", nullptr);
+  GstElement* parser = MakeFromRank(context, GST_ELEMENT_FACTORY_TYPE_PARSER, caps);
+  GstElement* decoder = MakeFromRank(context, GST_ELEMENT_FACTORY_TYPE_DECODER, caps);
+  if (!queue || !parser || !decoder) {
+    if (queue)
+      gst_object_unref(queue);
+    if (parser)
+      gst_object_unref(parser);
+    if (decoder)
+      gst_object_unref(decoder);
+    return nullptr;
+  }
+
+  gst_bin_add_many(GST_BIN(context->bin_), queue, parser, decoder, nullptr);
+  GstPad* sink = gst_element_get_static_pad(queue, "sink");
+  bool linked = gst_element_link_many(queue, parser, decoder, nullptr) &&
+                (gst_pad_link(pad, sink) == GST_PAD_LINK_OK);
+  gst_object_unref(sink);
+  if (!linked) {
+    LOG_ERROR("Failed to link fast path chain");
+    return nullptr;
+  }
+  gst_element_sync_state_with_parent(decoder);
+  gst_element_sync_state_with_parent(parser);
+  gst_element_sync_state_with_parent(queue);
+  return gst_element_get_static_pad(decoder, "src");
+}
+
+GstElement* FastPathBin::MakeFromRank(Context* context, GstElementFactoryListType type, GstCaps* caps) {
+  GstCaps* lookup_caps = gst_caps_ref(caps);
+  if (type == GST_ELEMENT_FACTORY_TYPE_DECODER) {
+    // the parser may change stream-format/alignment, only the media type has to match
+    gst_caps_unref(lookup_caps);
+    lookup_caps = gst_caps_new_empty_simple(gst_structure_get_name(gst_caps_get_structure(caps, 0)));
+  }
+  GstElementFactory* factory = FactoryIndex::Instance()->Lookup(type, lookup_caps);
+  gst_caps_unref(lookup_caps);
+  if (!factory) {
+    gchar* caps_info = gst_caps_to_string(caps);
+    LOG_INFO("no factory of type=[0x%llx] for [%s]", (unsigned long long)type, caps_info);
+    g_free(caps_info);
+    return nullptr;
+  }
+
+  if (type == GST_ELEMENT_FACTORY_TYPE_DECODER &&
+      AutoplugPolicy::Instance()->Select(context->scope_.c_str(), caps, factory) == GST_AUTOPLUG_SELECT_SKIP) {
+    LOG_INFO("%s is skipped by autoplug policy", GST_OBJECT_NAME(factory));
+    return nullptr;
+  }
+  return gst_element_factory_create(factory, nullptr);
+}
+
+void FastPathBin::ExposePad(Context* context, GstPad* pad, bool is_video) {
+  gchar* name = g_strdup_printf("%s_%u", is_video ? "video" : "audio",
+                                is_video ? context->video_count_++ : context->audio_count_++);
+  GstPad* ghost = gst_ghost_pad_new(name, pad);
+  gst_pad_set_active(ghost, TRUE);
+  gst_element_add_pad(context->bin_, ghost);
+  g_free(name);
+}
+
+void FastPathBin::Fallback(Context* context, const gchar* reason) {
+  if (context->fallback_)
+    return;
+  context->fallback_ = true;
+  LOG_INFO("fast path can not handle [%s], fall back to uridecodebin", reason);
+  gst_element_post_message(context->bin_,
+                           gst_message_new_application(GST_OBJECT(context->bin_),
+                               gst_structure_new(FAST_PATH_FALLBACK_MESSAGE,
+                                                 "reason", G_TYPE_STRING, reason, nullptr)));
+}
+
+}  // namespace genivimedia
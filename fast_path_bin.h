@@ -0,0 +1,112 @@
+// @@@LICENSE
+//
+// Copyright (C) 2023, LG Electronics, All Right Reserved.
+//
+// No part of this source code may be communicated, distributed, reproduced
+// or transmitted in any form or by any means, electronic or mechanical or
+// otherwise, for any purpose, without the prior written permission of
+// LG Electronics.
+//
+// LICENSE@@@
+
+#ifndef GENIVIMEDIA_FAST_PATH_BIN_H
+#define GENIVIMEDIA_FAST_PATH_BIN_H
+
+#include <glib.h>
+#include <gst/gst.h>
+
+namespace genivimedia {
+
+#define FAST_PATH_FALLBACK_MESSAGE "fast-path-fallback"
+#define FAST_PATH_SRC_FACTORY_NAME "genivifastpathsrc"
+#define FAST_PATH_URI_PROTOCOL "fastpath"
+
+typedef enum {
+  FAST_PATH_NONE = 0,
+  FAST_PATH_MP4,    /**< ftyp isom/iso2/mp41/mp42/avc1/M4V/M4A, H.264 video and AAC audio */
+  FAST_PATH_MP3,    /**< ID3v2 tag or MPEG-1/2 layer III frame sync */
+} FastPathKind;
+
+/**
+ * @class      genivimedia::FastPathBin
+ * @brief      Builds an explicit filesrc ! demux ! queue ! parse ! decoder bin for the common local files.
+ * @details    Probe() reads the first bytes of the file instead of running typefind. Create() returns a
+ *             bin which behaves like uridecodebin towards its owner: decoded "video_%u"/"audio_%u" ghost
+ *             pads appear through pad-added and no-more-pads is emitted after the demuxer's one.
+ *             Only the first video stream is decoded, further ones stay unlinked.
+ *             Demuxers, parsers and decoders are the highest ranked ones of FactoryIndex for the caps,
+ *             and decoders are checked against AutoplugPolicy like autoplug-select would do.
+ *             When a stream has no known chain (e.g. HEVC in MP4, or a second audio stream which
+ *             playbin would have to switch), FAST_PATH_FALLBACK_MESSAGE is posted as an application
+ *             message and the owner shall reload through uridecodebin.
+ *             For playbin the same chain is built by the FAST_PATH_SRC_FACTORY_NAME source element,
+ *             selected by the FAST_PATH_URI_PROTOCOL uri of GetSourceUri(): uridecodebin (urisourcebin
+ *             in playbin3) then gets raw pads from its source and plugs neither typefind nor decodebin.
+ * @see        genivimedia::GstMedia::CreateGstFastDecodebin, genivimedia::GstMedia::SetSourceURI
+ */
+class FastPathBin {
+ public:
+  /**
+   * @fn Probe
+   * @brief Returns the fast path kind of a local file uri, FAST_PATH_NONE for anything else.
+   * @param[in] uri : file:// uri
+   * @return FastPathKind
+   */
+  static FastPathKind Probe(const gchar* uri);
+
+  /**
+   * @fn Create
+   * @brief Creates the decode bin for the file.
+   * @param[in] kind : result of Probe()
+   * @param[in] uri : file:// uri
+   * @param[in] name : bin name
+   * @param[in] scope : pipeline name used for AutoplugPolicy
+   * @param[in] with_audio : FALSE leaves audio streams unlinked
+   * @return GstElement* (floating bin) or nullptr
+   */
+  static GstElement* Create(FastPathKind kind, const gchar* uri, const gchar* name,
+                            const gchar* scope, bool with_audio);
+
+  /**
+   * @fn GetSourceUri
+   * @brief Registers the source element on the first call and returns the uri which selects it.
+   * @param[in] uri : file:// uri
+   * @return gchar* (fastpath:// uri, free with g_free()) or nullptr if the file has no fast path
+   */
+  static gchar* GetSourceUri(const gchar* uri);
+
+  /**
+   * @fn ReportLoad
+   * @brief Adds a load-to-ASYNC_DONE time to the aggregates of the scope and path and logs them.
+   * @param[in] scope : pipeline name
+   * @param[in] fast_path : TRUE if the load used the fast path, FALSE for uridecodebin
+   * @param[in] elapsed_us : time from setting the uri to ASYNC_DONE
+   * @return None
+   */
+  static void ReportLoad(const gchar* scope, bool fast_path, gint64 elapsed_us);
+
+  /**
+   * @fn Build
+   * @brief Builds the chain of the file into bin. Used by Create() and the source element.
+   * @return bool (TRUE - SUCCESS, FALSE - FAIL)
+   */
+  static bool Build(GstElement* bin, FastPathKind kind, const gchar* uri, const gchar* scope,
+                    bool with_audio);
+
+ private:
+  struct Context;
+
+  static void FreeContext(gpointer data);
+  static bool BuildMp4(Context* context, GstElement* src);
+  static bool BuildMp3(Context* context, GstElement* src, const gchar* location);
+  static void PadAddedCallback(GstElement* demux, GstPad* pad, gpointer data);
+  static void NoMorePadsCallback(GstElement* demux, gpointer data);
+  static GstPad* LinkDecodeChain(Context* context, GstPad* pad, GstCaps* caps);
+  static GstElement* MakeFromRank(Context* context, GstElementFactoryListType type, GstCaps* caps);
+  static void ExposePad(Context* context, GstPad* pad, bool is_video);
+  static void Fallback(Context* context, const gchar* reason);
+};
+
+}  // namespace genivimedia
+
+#endif  // GENIVIMEDIA_FAST_PATH_BIN_H
@@ -10,11 +10,27 @@
 // LICENSE@@@
 
 #include "player/pipeline/gst_media.h"
+#include "player/pipeline/audio_sink_cache.h"
+#include "player/pipeline/audio_sink_swap.h"
+#include "player/pipeline/bus_thread.h"
 #include "player/pipeline/conf.h"
+#include "player/pipeline/element_policy.h"
+#include "player/pipeline/factory_index.h"
+#include "player/pipeline/fast_path_bin.h"
 
 #include <sys/resource.h>
 #include "logger/player_logger.h"
 #include "player/pipeline/keep_alive.h"
+#include "player/pipeline/playbin_pool.h"
+#include "player/pipeline/position_clock.h"
+#include "player/pipeline/qos_monitor.h"
+#include "player/pipeline/seek_scheduler.h"
+#include "player/pipeline/stream_selection.h"
+#include "player/pipeline/thread_registry.h"
+#include "player/pipeline/thumbnail_encoder.h"
+#include "player/pipeline/thumbnail_frame_selector.h"
+#include "player/pipeline/thumbnail_scaler.h"
+#include "player/pipeline/trick_mode_probe.h"
 
 namespace genivimedia {
 
@@ -41,7 +57,13 @@ GstMedia::GstMedia()
     playsink_(nullptr),
     bus_(nullptr),
     bus_signal_id_(0),
+    bus_thread_(),
+    position_clock_(),
+    qos_monitor_(),
+    stream_selection_(),
+    use_playbin3_(false),
     pipeline_element_add_signal_id_(0),
+    deep_element_add_signal_id_(0),
     uridecodebin_element_add_signal_id_(0),
     decodebin_element_add_signal_id_(0),
     playsink_element_add_signal_id_(0),
@@ -51,6 +73,7 @@ GstMedia::GstMedia()
     cache_location_signal_id_(0),
     remote_address_signal_id_(0),
     notify_atmos_signal_id_(0),
+    about_to_finish_signal_id_(0),
     lang_code_({0,}),
     media_type_(""),
     bus_callback_(),
@@ -63,10 +86,18 @@ GstMedia::GstMedia()
     nomorepads_callback_(),
     seek_callback_(),
     seek_control_(),
+    seek_scheduler_(new SeekScheduler(std::bind(&GstMedia::Seek, this,
+                                                std::placeholders::_1,
+                                                std::placeholders::_2,
+                                                std::placeholders::_3))),
     cache_location_callback_(),
     remote_address_callback_(),
     notify_atmos_callback_(),
-    isSeeking_(false) {
+    about_to_finish_callback_(),
+    isSeeking_(false),
+    sink_swap_pending_(FALSE),
+    fast_path_load_(false),
+    load_start_us_(0) {
 
 }
 
@@ -75,6 +106,8 @@ GstMedia::~GstMedia() {
 
   if (seek_control_)
     delete seek_control_;
+  if (seek_scheduler_)
+    delete seek_scheduler_;
 }
 
 bool GstMedia::AddElement(const char* factory_name, const char* name) {
@@ -170,45 +203,69 @@ bool GstMedia::CreateGstPipeline(const char* pipeline_name) {
   if (!pipeline_) {
     return false;
   }
+  RegisterElementPolicy();
   return true;
 }
 
 bool GstMedia::CreateGstPlaybin(const char* playbin_name) {
+  if (!pipeline_ && Conf::GetFeatures(SUPPORT_PLAYBIN3)) {
+    // decodebin3 plugs decoders only for the selected streams, the pool keeps playbin only
+    pipeline_ = gst_element_factory_make("playbin3", playbin_name);
+    use_playbin3_ = (pipeline_ != nullptr);
+    if (!use_playbin3_)
+      LOG_ERROR("playbin3 is not available, use playbin");
+  }
+  if (!pipeline_) {
+    pipeline_ = PlaybinPool::Instance()->Acquire(playbin_name);
+  }
   if (!pipeline_) {
     pipeline_ = gst_element_factory_make ("playbin", playbin_name);
     if (!pipeline_) {
       return false;
     }
   }
+  RegisterElementPolicy();
   return true;
 }
 
-GstElement* GstMedia::CreateAudioSinkBin(const char* audio_sink, char slot, char slot_6ch,
-                                         int channel, bool is_dsd, const std::string& media_type) {
-    GstElement* audio_sink_bin = nullptr;
-    std::string audio_entire_bin;
-    std::string audio_alsa_device = " device=";
+bool GstMedia::RegisterElementPolicy() {
+  if (deep_element_add_signal_id_ > 0)
+    return true;
 
-    if (!audio_sink)
-        return nullptr;
-    std::string alsa_name = (channel > 5) ? Conf::GetAlsaDeviceType("alsa_5_1")
-                                          : Conf::GetAlsaDeviceType(media_type.c_str());
+  deep_element_add_signal_id_ = g_signal_connect(pipeline_,
+                       "deep-element-added",
+                       G_CALLBACK(DeepElementAddCallbackFunc),
+                       static_cast<void*>(this));
+
+  // elements gst_parse_launch already put into the pipeline never emit deep-element-added
+  GstIterator* iter = gst_bin_iterate_recurse(GST_BIN(pipeline_));
+  GValue item = G_VALUE_INIT;
+  while (gst_iterator_next(iter, &item) == GST_ITERATOR_OK) {
+    ElementPolicy::Instance()->Apply(GST_OBJECT_NAME(pipeline_), GST_ELEMENT(g_value_get_object(&item)));
+    g_value_reset(&item);
+  }
+  g_value_unset(&item);
+  gst_iterator_free(iter);
+  return deep_element_add_signal_id_ > 0;
+}
+
+static std::string GetAlsaDevice(char slot, char slot_6ch, int channel,
+                                 const std::string& media_type, std::string& alsa_name) {
+    std::string alsa_device;
+
+    alsa_name = (channel > 5) ? Conf::GetAlsaDeviceType("alsa_5_1")
+                              : Conf::GetAlsaDeviceType(media_type.c_str());
     if (alsa_name.size() == 0) {
         LOG_ERROR("Cannot acquire alsa device name[%s], use default instead", media_type.c_str());
         alsa_name = "default";
     }
 
     LOG_INFO("Channel=[%d] Alsa device name[%s]", channel, alsa_name.c_str());
-    audio_alsa_device.append(alsa_name);
-
-    if (slot == (char)-1) {
-        LOG_ERROR("Invalid slot value, use default value 1");
-        slot = '1';
-    }
+    alsa_device.append(alsa_name);
 
     if (channel > 5) {
       if (slot_6ch == '1') { // ccRC case - device name is '6channel2'
-        audio_alsa_device.append("2");
+        alsa_device.append("2");
       }
     } else if (alsa_name.compare("default") == 0) {
         // Do nothing
@@ -216,9 +273,43 @@ GstElement* GstMedia::CreateAudioSinkBin(const char* audio_sink, char slot, char
     } else {
         // Ignore face_detection slot
         if (media_type.compare("face_detection") != 0) {
-            audio_alsa_device.append((const char*)&slot, 1);
+            alsa_device.append((const char*)&slot, 1);
         }
     }
+    return alsa_device;
+}
+
+static std::string GetChannelCaps(int channel, bool is_dsd, const std::string& media_type) {
+    std::string channel_caps;
+
+    if (channel > 5) {
+        channel_caps = "audio/x-raw,channels=6";
+    } else {
+        channel_caps = "audio/x-raw,channels=2"; // for 2channel down mixing
+    }
+
+    //add the sampling rate and format for welaaa case
+    if (!is_dsd && (media_type.compare("welaaa_audio_streaming") == 0)) {
+        channel_caps.append(",format=S16LE,rate=48000");
+    }
+    return channel_caps;
+}
+
+GstElement* GstMedia::CreateAudioSinkBin(const char* audio_sink, char slot, char slot_6ch,
+                                         int channel, bool is_dsd, const std::string& media_type) {
+    GstElement* audio_sink_bin = nullptr;
+    std::string audio_entire_bin;
+    std::string alsa_name;
+
+    if (!audio_sink)
+        return nullptr;
+
+    if (slot == (char)-1) {
+        LOG_ERROR("Invalid slot value, use default value 1");
+        slot = '1';
+    }
+    std::string audio_alsa_device = GetAlsaDevice(slot, slot_6ch, channel, media_type, alsa_name);
+
 #ifdef PLATFORM_TELECHIPS
     audio_entire_bin = "audioresample ! audio/x-raw, rate=48000 ! ";
 #else
@@ -234,24 +325,18 @@ GstElement* GstMedia::CreateAudioSinkBin(const char* audio_sink, char slot, char
     /* VisualOn will send 5.1 output, but some contents has multi track(AC3 + AAC + ...) in one contents.
      If user selects AAC tracks for playback, we need audioconvert. So we should always add audioconvert in pipeline.
      But AC3/DTS's actual downmix will be done by VisualOn plugin. */
-    if (channel > 5) {
-        audio_entire_bin.append("audioconvert ! audio/x-raw,channels=6");
-    } else {
-        audio_entire_bin.append("audioconvert ! audio/x-raw,channels=2"); // for 2channel down mixing
-    }
-
-    //add the sampling rate and format for welaaa case
-    if (!is_dsd && (media_type.compare("welaaa_audio_streaming") == 0)) {
-        audio_entire_bin.append(",format=S16LE,rate=48000");
-    }
+    audio_entire_bin.append("audioconvert ! ");
+    audio_entire_bin.append(GetChannelCaps(channel, is_dsd, media_type));
     audio_entire_bin.append(" ! ");
 
     audio_entire_bin.append(std::string(audio_sink));
+    audio_entire_bin.append(" device=");
     audio_entire_bin.append(audio_alsa_device);
     audio_entire_bin.append(" buffer-time=80000 latency-time=10000"); // for removing dmix
 
     LOG_INFO("audio-sink=[%s]", audio_entire_bin.c_str());
-    audio_sink_bin = gst_parse_bin_from_description(reinterpret_cast<const gchar*>(audio_entire_bin.c_str()), TRUE, NULL);
+    AudioSinkKey key = { std::string(audio_sink), channel, slot, slot_6ch, is_dsd, media_type, alsa_name };
+    audio_sink_bin = AudioSinkCache::Instance()->Take(key, audio_entire_bin);
 
     return audio_sink_bin;
 }
@@ -311,6 +396,9 @@ bool GstMedia::CreateGstUriDecodebin(const char* uri, const char* caps) {
     LOG_ERROR ("could not construct pipeline: %s\n", error->message);
     goto EXIT;
   } else {
+    // the pipeline name is the scope of the element and autoplug policies
+    gst_object_set_name(GST_OBJECT(pipeline_), "thumbnail_pipeline");
+    RegisterElementPolicy();
     ret = true;
   }
 
@@ -322,6 +410,85 @@ EXIT:
   return ret;
 }
 
+bool GstMedia::CreateGstFastDecodebin(const char* uri, const char* caps, int kind) {
+  bool ret = false;
+  gchar *descr = nullptr;
+  GError *error = nullptr;
+  GstElement* decode = nullptr;
+#if defined(PLATFORM_NVIDIA)
+  descr = g_strdup_printf ("%s%s%s",
+                           "nvmediasurfmixer name=convert ! videoconvert ! videoscale ! appsink name=sink caps=\"",
+                           caps,
+                           "\"");
+#else
+  descr = g_strdup_printf ("%s%s%s",
+                           "videoconvert name=convert ! videoscale ! appsink name=sink caps=\"",
+                           caps,
+                           "\"");
+#endif
+  pipeline_ = gst_parse_launch (descr, &error);
+  if (error) {
+    LOG_ERROR ("could not construct pipeline: %s\n", error->message);
+    goto EXIT;
+  }
+
+  // same pad-added/no-more-pads contract as uridecodebin, without typefind and autoplugging
+  decode = FastPathBin::Create((FastPathKind)kind, uri, "fastdecode", "thumbnail_pipeline", false);
+  if (!decode) {
+    gst_object_unref(GST_OBJECT(pipeline_));
+    pipeline_ = nullptr;
+    goto EXIT;
+  }
+  gst_bin_add(GST_BIN(pipeline_), decode);
+  gst_object_set_name(GST_OBJECT(pipeline_), "thumbnail_pipeline");
+  RegisterElementPolicy();
+  g_signal_connect(decode, "pad-added", G_CALLBACK(FastPathPadAddedFunc), static_cast<void*>(this));
+  ret = true;
+
+EXIT:
+  if (error)
+    g_error_free (error);
+  if (descr)
+    g_free(descr);
+  return ret;
+}
+
+void GstMedia::FastPathPadAddedFunc(GstElement* element, GstPad* pad, gpointer data) {
+  GstMedia* handler = reinterpret_cast<GstMedia*> (data);
+  gchar* pad_name = gst_pad_get_name(pad);
+  if (!g_str_has_prefix(pad_name, "video_")) {
+    g_free(pad_name);
+    return;
+  }
+
+  GstElement* convert = gst_bin_get_by_name(GST_BIN(handler->pipeline_), "convert");
+  GstPad* sink = convert ? gst_element_get_static_pad(convert, "sink") : nullptr;
+  if (sink && !gst_pad_is_linked(sink)) {
+    if (gst_pad_link(pad, sink) != GST_PAD_LINK_OK)
+      LOG_ERROR("Failed to link fast path pad %s", pad_name);
+  }
+  if (sink)
+    gst_object_unref(sink);
+  if (convert)
+    gst_object_unref(convert);
+  g_free(pad_name);
+}
+
+void GstMedia::SetSourceURI(const char* uri, bool allow_fast_path) {
+  if (!pipeline_ || !uri)
+    return;
+
+  // the fast path source hands decoded pads to uridecodebin, typefind and decodebin are skipped
+  gchar* source_uri = nullptr;
+  if (allow_fast_path && Conf::GetFeatures(SUPPORT_FAST_PATH))
+    source_uri = FastPathBin::GetSourceUri(uri);
+  fast_path_load_ = (source_uri != nullptr);
+  load_start_us_ = g_get_monotonic_time();
+  LOG_INFO("source uri=[%s]", source_uri ? source_uri : uri);
+  g_object_set(G_OBJECT(pipeline_), "uri", source_uri ? source_uri : uri, nullptr);
+  g_free(source_uri);
+}
+
 bool GstMedia::StopGstPipeline(bool destory_pipeline, bool use_keep_alive) {
   bool ret = false;
   if (!pipeline_) {
@@ -331,6 +498,13 @@ bool GstMedia::StopGstPipeline(bool destory_pipeline, bool use_keep_alive) {
 
   if (use_keep_alive)
     KeepAlive::Instance()->Start();
+  seek_scheduler_->Reset();
+  load_start_us_ = 0;
+  position_clock_.Reset();
+  stream_selection_.Reset();
+  trick_mode_probe_.Reset();
+  LOG_INFO("session qos %s", qos_monitor_.GetJson().c_str());
+  qos_monitor_.Reset();
 
   GstStateChangeReturn ret_gst = GST_STATE_CHANGE_SUCCESS;
   if (destory_pipeline) {
@@ -345,6 +519,8 @@ bool GstMedia::StopGstPipeline(bool destory_pipeline, bool use_keep_alive) {
 
       gst_object_unref(GST_OBJECT(pipeline_));
       pipeline_ = nullptr;
+      use_playbin3_ = false;
+      deep_element_add_signal_id_ = 0;
       ret = true;
     } else {
       LOG_INFO("Pipeline is already uninitialized ");
@@ -360,6 +536,17 @@ bool GstMedia::StopGstPipeline(bool destory_pipeline, bool use_keep_alive) {
       g_signal_handler_disconnect(bus_, bus_signal_id_);
       bus_signal_id_ = 0;
     }
+    if (!use_playbin3_ && PlaybinPool::Instance()->CanRelease(pipeline_)) {
+      UnRegisterWatchBus();
+      if (PlaybinPool::Instance()->Release(pipeline_)) {
+        pipeline_ = nullptr;
+      } else {
+        LOG_ERROR("Failed to return playbin to pool, destroy it");
+        gst_element_set_state(pipeline_, GST_STATE_NULL);
+        gst_object_unref(GST_OBJECT(pipeline_));
+        pipeline_ = nullptr;
+      }
+    }
     ret = true;
   }
 
@@ -375,9 +562,9 @@ bool GstMedia::DisconnectAllBinSignal() {
     pipeline_element_add_signal_id_ = 0;
   }
 
-  if (uridecodebin_element_add_signal_id_ > 0 && uridecodebin_ != nullptr) {
-    g_signal_handler_disconnect(uridecodebin_, uridecodebin_element_add_signal_id_);
-    uridecodebin_element_add_signal_id_ = 0;
+  if (deep_element_add_signal_id_ > 0 && pipeline_ != nullptr) {
+    g_signal_handler_disconnect(pipeline_, deep_element_add_signal_id_);
+    deep_element_add_signal_id_ = 0;
   }
 
   if (decodebin_element_add_signal_id_ > 0 && decodebin_ != nullptr) {
@@ -405,11 +592,15 @@ bool GstMedia::DisconnectAllBinSignal() {
     notify_atmos_signal_id_=0;
   }
 
-  if (uridecodebin_) {
-    g_signal_handler_disconnect(uridecodebin_, uridecodebin_sort_signal_id_);
-    g_signal_handler_disconnect(uridecodebin_, uridecodebin_select_signal_id_);
-    g_signal_handler_disconnect(uridecodebin_, uridecodebin_nomorepad_signal_id_);
+  if (about_to_finish_signal_id_ > 0 && pipeline_ != nullptr) {
+    g_signal_handler_disconnect(pipeline_, about_to_finish_signal_id_);
+    about_to_finish_signal_id_=0;
   }
+
+  // a recycled playbin registers every handler again on the next load
+  AttachUriDecodeBin(nullptr);
+  decodebin_ = nullptr;
+  playsink_ = nullptr;
   return true;
 }
 
@@ -424,34 +615,15 @@ bool GstMedia::GetCurPipelineState(GstState* state) {
 }
 
 GstElementFactory* GstMedia::FindElementFactory(GstElementFactoryListType type, GstCaps* caps) {
-  GList* element_list = nullptr;
-  GList* filtered = nullptr;
-  GstElementFactory* factories = nullptr;
   gchar* caps_info = gst_caps_to_string(caps);
-  gchar* name;
+  GstElementFactory* factories = FactoryIndex::Instance()->Lookup(type, caps);
 
-  element_list = gst_element_factory_list_get_elements(type, GST_RANK_MARGINAL);
-  if (!element_list) {
-    LOG_ERROR("Failed to find element list");
-    goto FAIL;
-  }
-
-  element_list = g_list_sort(element_list, (GCompareFunc)gst_plugin_feature_rank_compare_func);
-  filtered = gst_element_factory_list_filter(element_list, caps, GST_PAD_SINK, false);
-  if (!filtered) {
+  if (factories) {
+    LOG_INFO("Found element %s for caps %s",
+             gst_plugin_feature_get_name(reinterpret_cast<GstPluginFeature*>(factories)), caps_info);
+  } else {
     LOG_ERROR("Failed to find any element for caps %s", caps_info);
-    goto FAIL;
   }
-
-  name = gst_plugin_feature_get_name(reinterpret_cast<GstPluginFeature*>(filtered->data));
-  LOG_INFO("Found element %s for caps %s", name, caps_info);
-  factories = GST_ELEMENT_FACTORY_CAST(g_list_nth_data(filtered, 0));
-
-FAIL:
-  if (element_list)
-    gst_plugin_feature_list_free(element_list);
-  if (filtered)
-    gst_plugin_feature_list_free(filtered);
   g_free(caps_info);
   return factories;
 }
@@ -459,6 +631,18 @@ FAIL:
 bool GstMedia::RegisterWatchBus(BusCallback callback) {
   bus_callback_ = callback;
 
+  if (Conf::GetFeatures(SUPPORT_BUS_THREAD)) {
+    if (!bus_)
+      bus_ = gst_pipeline_get_bus(GST_PIPELINE(pipeline_));
+    if (!bus_)
+      return false;
+    if (bus_thread_.IsRunning())
+      return true;
+    bus_thread_.SetSyncHook(SyncBusCallbackFunc, static_cast<void*>(this));
+    return bus_thread_.Start(bus_, BusCallbackFunc, static_cast<void*>(this));
+  }
+
+  // the sync handler stays installed with bus_, replacing it is refused by GstBus
   if (bus_) {
     bus_signal_id_ = g_signal_connect(bus_,
                                       "message",
@@ -471,6 +655,8 @@ bool GstMedia::RegisterWatchBus(BusCallback callback) {
   if (!bus_) {
     return false;
   }
+  // streaming threads register themselves in ThreadRegistry from the sync handler
+  gst_bus_set_sync_handler(bus_, SyncBusCallbackFunc, static_cast<void*>(this), nullptr);
   gst_bus_add_signal_watch(bus_);
   bus_signal_id_ = g_signal_connect(bus_,
                                     "message",
@@ -483,13 +669,23 @@ bool GstMedia::RegisterWatchBus(BusCallback callback) {
   }
 }
 
+void GstMedia::InvokeOwner(const std::function<void()>& func) {
+  // without the bus thread every handler already runs on the main context
+  bus_thread_.InvokeOwner(func);
+}
+
 bool GstMedia::UnRegisterWatchBus() {
   if (bus_) {
     gst_bus_set_flushing(bus_, true);
-    if (bus_signal_id_) {
-      g_signal_handler_disconnect(bus_, bus_signal_id_);
+    if (bus_thread_.IsRunning()) {
+      bus_thread_.Stop();
+    } else {
+      gst_bus_set_sync_handler(bus_, nullptr, nullptr, nullptr);
+      if (bus_signal_id_) {
+        g_signal_handler_disconnect(bus_, bus_signal_id_);
+      }
+      gst_bus_remove_signal_watch(bus_);
     }
-    gst_bus_remove_signal_watch(bus_);
     gst_object_unref(bus_);
     bus_ = nullptr;
     return true;
@@ -515,12 +711,36 @@ bool GstMedia::RegisterElementAddBin(ElementAddCallback callback) {
   }
 }
 
+void GstMedia::AttachUriDecodeBin(GstElement* element) {
+  if (element == uridecodebin_)
+    return;
+
+  // gapless playback plugs a uridecodebin per track, the handlers move to the one just added
+  if (uridecodebin_) {
+    if (uridecodebin_element_add_signal_id_ > 0)
+      g_signal_handler_disconnect(uridecodebin_, uridecodebin_element_add_signal_id_);
+    if (uridecodebin_sort_signal_id_ > 0)
+      g_signal_handler_disconnect(uridecodebin_, uridecodebin_sort_signal_id_);
+    if (uridecodebin_select_signal_id_ > 0)
+      g_signal_handler_disconnect(uridecodebin_, uridecodebin_select_signal_id_);
+    if (uridecodebin_nomorepad_signal_id_ > 0)
+      g_signal_handler_disconnect(uridecodebin_, uridecodebin_nomorepad_signal_id_);
+    gst_object_unref(uridecodebin_);
+  }
+  uridecodebin_element_add_signal_id_ = 0;
+  uridecodebin_sort_signal_id_ = 0;
+  uridecodebin_select_signal_id_ = 0;
+  uridecodebin_nomorepad_signal_id_ = 0;
+  // held until the handlers are moved again, so they can always be disconnected
+  uridecodebin_ = element ? GST_ELEMENT(gst_object_ref(element)) : nullptr;
+}
+
 bool GstMedia::RegisterUriDecodeBinElementAddBin(ElementAddCallback callback, GstElement* element) {
+  AttachUriDecodeBin(element);
   if (uridecodebin_element_add_signal_id_ > 0) {
     return true;
   }
   uridecodebin_elementadd_callback_ = callback;
-  uridecodebin_ = element;
 
   uridecodebin_element_add_signal_id_ = g_signal_connect(uridecodebin_,
                        "element-added",
@@ -614,6 +834,26 @@ bool GstMedia::RegisterHandleNotifyAtmos(NotifyAtmosCallback callback) {
   }
 }
 
+void GstMedia::AboutToFinishCallbackFunc(GstElement* playbin, gpointer data) {
+  GstMedia* handler = reinterpret_cast<GstMedia*> (data);
+  handler->about_to_finish_callback_(playbin, data);
+}
+
+bool GstMedia::RegisterAboutToFinish(AboutToFinishCallback callback) {
+  if (about_to_finish_signal_id_ > 0) {
+    return true;
+  }
+  about_to_finish_callback_ = callback;
+  about_to_finish_signal_id_ = g_signal_connect (pipeline_, "about-to-finish",
+                                                 G_CALLBACK (AboutToFinishCallbackFunc),
+                                                 static_cast<void*>(this));
+  if (about_to_finish_signal_id_ > 0) {
+    return true;
+  } else {
+    return false;
+  }
+}
+
 bool GstMedia::RegisterDecodeBinElementAddBin(ElementAddCallback callback, GstElement* element) {
   if (decodebin_element_add_signal_id_ > 0) {
     return true;
@@ -633,59 +873,42 @@ bool GstMedia::RegisterDecodeBinElementAddBin(ElementAddCallback callback, GstEl
 }
 
 bool GstMedia::RegisterAutoPlugSort(AutoPlugSortCallback callback, GstElement* element) {
+  AttachUriDecodeBin(element);
   if (uridecodebin_sort_signal_id_ > 0) {
     return true;
   }
-  bool ret = false;
-  gchar *element_name = gst_element_get_name(element);
   autoplugsort_callback_ = callback;
-  uridecodebin_ = element;
-  uridecodebin_sort_signal_id_ = g_signal_connect(gst_bin_get_by_name(GST_BIN(pipeline_), element_name),
+  uridecodebin_sort_signal_id_ = g_signal_connect(uridecodebin_,
                                                   "autoplug-sort",
                                                   G_CALLBACK(AutoSortPlugCallbackFunc),
                                                   static_cast<void*>(this));
-  if (uridecodebin_sort_signal_id_ > 0) {
-    ret = true;
-  }
-  g_free(element_name);
-  return ret;
+  return uridecodebin_sort_signal_id_ > 0;
 }
 
 bool GstMedia::RegisterAutoPlugSelect(AutoPlugSelectCallback callback, GstElement* element) {
+  AttachUriDecodeBin(element);
   if (uridecodebin_select_signal_id_ > 0) {
     return true;
   }
-  bool ret = false;
-  gchar *element_name = gst_element_get_name(element);
   autoplugselect_callback_ = callback;
-  uridecodebin_ = element;
-  uridecodebin_select_signal_id_ = g_signal_connect(gst_bin_get_by_name(GST_BIN(pipeline_), element_name),
+  uridecodebin_select_signal_id_ = g_signal_connect(uridecodebin_,
                                                     "autoplug-select",
                                                     G_CALLBACK(AutoSelectPlugCallbackFunc),
                                                     static_cast<void*>(this));
-  if (uridecodebin_select_signal_id_ > 0) {
-    ret = true;
-  }
-  g_free(element_name);
-  return ret;
+  return uridecodebin_select_signal_id_ > 0;
 }
 
 bool GstMedia::RegisterNoMorePads(NoMorePadsCallback callback, GstElement* element) {
+  AttachUriDecodeBin(element);
   if (uridecodebin_nomorepad_signal_id_ > 0) {
     return true;
   }
-  bool ret = false;
-  gchar *element_name = gst_element_get_name(element);
   nomorepads_callback_ = callback;
-  uridecodebin_ = element;
-  uridecodebin_nomorepad_signal_id_ = g_signal_connect(gst_bin_get_by_name(GST_BIN(pipeline_), element_name),
+  uridecodebin_nomorepad_signal_id_ = g_signal_connect(uridecodebin_,
                                                        "no-more-pads",
                                                        G_CALLBACK(NoMorePadsCallbackFunc),
                                                        static_cast<void*>(this));
-  if (uridecodebin_nomorepad_signal_id_ > 0)
-    ret = true;
-  g_free(element_name);
-  return ret;
+  return uridecodebin_nomorepad_signal_id_ > 0;
 }
 
 void GstMedia::RegisterSeekControl(SeekControlCallback callback, int interval) {
@@ -830,7 +1053,7 @@ bool GstMedia::ChangeStateToPlay() {
   return ret;
 }
 
-bool GstMedia::Seek(gint64 position, GstSeekFlags flags) {
+bool GstMedia::Seek(gint64 position, GstSeekFlags flags, guint32 seqnum) {
   bool ret = false;
   if (!pipeline_) {
     LOG_ERROR("return with null pipeline");
@@ -846,6 +1069,11 @@ bool GstMedia::Seek(gint64 position, GstSeekFlags flags) {
                               flags,
                               GST_SEEK_TYPE_SET, (position*GST_MSECOND),
                               GST_SEEK_TYPE_SET, GST_CLOCK_TIME_NONE);
+  // flushes, segments and the ASYNC_DONE of this seek carry the seqnum
+  if (seqnum != GST_SEQNUM_INVALID)
+    gst_event_set_seqnum(seek, seqnum);
+  position_clock_.Invalidate("seek");
+  trick_mode_probe_.Reset();
   if (!gst_element_send_event (pipeline_, seek))
     LOG_ERROR("Error - gst_element_send_event");
   else {
@@ -857,10 +1085,27 @@ bool GstMedia::Seek(gint64 position, GstSeekFlags flags) {
   return ret;
 }
 
-bool GstMedia::SeekDone() {
+bool GstMedia::ScheduleSeek(gint64 position) {
+  if (!pipeline_) {
+    LOG_ERROR("return with null pipeline");
+    return false;
+  }
+  return seek_scheduler_->Request(position);
+}
+
+bool GstMedia::SeekDone(guint32 seqnum) {
+  // the timeout of the seek in flight keeps running
+  if (seek_scheduler_->IsStale(seqnum)) {
+    LOG_INFO("ASYNC_DONE seqnum=[%u] of an earlier seek is ignored", seqnum);
+    return false;
+  }
   if (seek_control_)
     seek_control_->Done();
-  return true;
+  return seek_scheduler_->OnDone(false, seqnum);
+}
+
+std::string GstMedia::GetSeekLatencyJson() {
+  return seek_scheduler_->GetLatencyJson();
 }
 
 bool GstMedia::SeekSimple(gint64 position) {
@@ -871,6 +1116,7 @@ bool GstMedia::SeekSimple(gint64 position) {
   }
 
   GstSeekFlags flags = GstSeekFlags(GST_SEEK_FLAG_KEY_UNIT | GST_SEEK_FLAG_SKIP | GST_SEEK_FLAG_FLUSH);
+  position_clock_.Invalidate("seek");
   ret = gst_element_seek_simple(pipeline_, GST_FORMAT_TIME, flags, position);
 
   return (bool)ret;
@@ -885,11 +1131,30 @@ bool GstMedia::SeekSegment(gint64 position, bool flush) {
 
   GstSeekFlags flags = (flush == true) ? GstSeekFlags(GST_SEEK_FLAG_FLUSH | GST_SEEK_FLAG_SEGMENT)
                                        : GstSeekFlags(GST_SEEK_FLAG_SEGMENT);
+  position_clock_.Invalidate("seek");
   ret = gst_element_seek_simple(pipeline_, GST_FORMAT_TIME, flags, position);
 
   return (bool)ret;
 }
 
+bool GstMedia::GetExtrapolatedPosition(gint64* position) {
+  if (!pipeline_)
+    return false;
+  return position_clock_.Get(pipeline_, position);
+}
+
+void GstMedia::AttachQosDecoder(GstElement* decoder) {
+  qos_monitor_.AttachDecoder(decoder);
+}
+
+void GstMedia::SetQosVideoSink(GstElement* sink) {
+  qos_monitor_.SetVideoSink(sink);
+}
+
+std::string GstMedia::GetQosJson() {
+  return qos_monitor_.GetJson();
+}
+
 bool GstMedia::GetCurPosition(gint64* position) {
   gint64 pts;
   if (!pipeline_)
@@ -908,16 +1173,24 @@ char* GstMedia::GetLanguage(int index, const gchar* tag){
     return nullptr;
 
   GstTagList* tags = nullptr;
+  g_signal_emit_by_name(G_OBJECT(pipeline_), tag, index, &tags);
+  ParseLanguage(tags);
+  if (tags)
+    gst_tag_list_free(tags);
+
+  LOG_INFO("%s : code[%s]", tag, lang_code_);
+  return lang_code_;
+}
+
+void GstMedia::ParseLanguage(GstTagList* tags) {
   gchar* lang_code = nullptr;
   bool found = false;
-  g_signal_emit_by_name(G_OBJECT(pipeline_), tag, index, &tags);
   if (tags) {
     if (gst_tag_list_get_string(tags, GST_TAG_LANGUAGE_CODE, &lang_code)) {
       found = true;
     } else if (gst_tag_list_get_string(tags, GST_TAG_CODEC, &lang_code)) {
       found = true;
     }
-    gst_tag_list_free(tags);
   }
 
   if (found && lang_code) {
@@ -937,11 +1210,140 @@ char* GstMedia::GetLanguage(int index, const gchar* tag){
   } else {
     snprintf(lang_code_, 3, "und");
   }
+}
 
-  LOG_INFO("%s : code[%s]", tag, lang_code_);
+char* GstMedia::GetTrackInfo(MediaFileInfo* info, size_t index, const gchar* type) {
+  if (!pipeline_ || !info || !type)
+    return nullptr;
+
+  GstStreamType stream_type = GetStreamType(type);
+  if (stream_type == GST_STREAM_TYPE_UNKNOWN)
+    return nullptr;
+  if (stream_type == GST_STREAM_TYPE_AUDIO && index >= info->audio_.size())
+    return nullptr;
+
+  if (use_playbin3_)
+    return GetStreamInfo(info, index, stream_type);
+
+  // one tag list and one pad per track, shared by language, format, codec and caps parsing
+  gchar* tags_signal = g_strdup_printf("get-%s-tags", type);
+  GstTagList* tags = nullptr;
+  GstPad* pad = nullptr;
+  g_signal_emit_by_name(G_OBJECT(pipeline_), tags_signal, (gint)index, &tags);
+  if (stream_type != GST_STREAM_TYPE_TEXT) {
+    // the caps of a text pad carry nothing MediaFileInfo keeps
+    gchar* pad_signal = g_strdup_printf("get-%s-pad", type);
+    g_signal_emit_by_name(G_OBJECT(pipeline_), pad_signal, (gint)index, &pad);
+    g_free(pad_signal);
+  }
+
+  ParseLanguage(tags);
+  if (stream_type == GST_STREAM_TYPE_AUDIO) {
+    GetFormatTagInfo(info, tags);
+    GetAudioTagInfo(info->audio_[index], tags);
+    GetAudioPadInfo(info->audio_[index], pad);
+  } else if (stream_type == GST_STREAM_TYPE_VIDEO) {
+    GetFormatTagInfo(info, tags);
+    GetVideoTagInfo(info->video_, tags);
+    GetVideoPadInfo(info->video_, pad);
+  }
+  LOG_INFO("%s[%u] : code[%s]", type, (guint)index, lang_code_);
+
+  if (tags)
+    gst_tag_list_free(tags);
+  if (pad)
+    gst_object_unref(pad);
+  g_free(tags_signal);
   return lang_code_;
 }
 
+char* GstMedia::GetStreamInfo(MediaFileInfo* info, size_t index, GstStreamType type) {
+  // playbin3 has no get-*-tags/get-*-pad, the collection carries tags and caps of every stream
+  GstStream* stream = stream_selection_.GetStream(type, (int)index);
+  GstTagList* tags = stream ? gst_stream_get_tags(stream) : nullptr;
+  GstCaps* caps = stream ? gst_stream_get_caps(stream) : nullptr;
+
+  ParseLanguage(tags);
+  if (type == GST_STREAM_TYPE_AUDIO) {
+    GetFormatTagInfo(info, tags);
+    GetAudioTagInfo(info->audio_[index], tags);
+    GetAudioCapsInfo(info->audio_[index], caps);
+  } else if (type == GST_STREAM_TYPE_VIDEO) {
+    GetFormatTagInfo(info, tags);
+    GetVideoTagInfo(info->video_, tags);
+    GetVideoCapsInfo(info->video_, caps);
+  }
+  LOG_INFO("%s stream[%u] : code[%s]", gst_stream_type_get_name(type), (guint)index, lang_code_);
+
+  if (tags)
+    gst_tag_list_unref(tags);
+  if (caps)
+    gst_caps_unref(caps);
+  if (stream)
+    gst_object_unref(stream);
+  return lang_code_;
+}
+
+int GstMedia::GetTrackCount(const gchar* type) {
+  if (!pipeline_ || !type)
+    return 0;
+
+  if (use_playbin3_)
+    return stream_selection_.GetCount(GetStreamType(type));
+
+  gint count = 0;
+  gchar* property = g_strdup_printf("n-%s", type);
+  g_object_get(G_OBJECT(pipeline_), property, &count, nullptr);
+  g_free(property);
+  return count;
+}
+
+int GstMedia::GetCurrentTrack(const gchar* type) {
+  if (!pipeline_ || !type)
+    return -1;
+
+  if (use_playbin3_)
+    return stream_selection_.GetCurrent(GetStreamType(type));
+
+  gint current = -1;
+  gchar* property = g_strdup_printf("current-%s", type);
+  g_object_get(G_OBJECT(pipeline_), property, &current, nullptr);
+  g_free(property);
+  return current;
+}
+
+bool GstMedia::HandleStreamCollection(GstMessage* message, bool with_audio, const StreamFilter& filter) {
+  if (!use_playbin3_ || !pipeline_)
+    return false;
+
+  GstStreamCollection* collection = nullptr;
+  gst_message_parse_stream_collection(message, &collection);
+  if (!collection)
+    return false;
+  stream_selection_.SetCollection(pipeline_, collection, with_audio, filter);
+  gst_object_unref(collection);
+  return true;
+}
+
+bool GstMedia::IsPlaybin3() const {
+  return use_playbin3_;
+}
+
+void GstMedia::HandleStreamsSelected(GstMessage* message) {
+  if (use_playbin3_)
+    stream_selection_.OnSelected(message);
+}
+
+GstStreamType GstMedia::GetStreamType(const gchar* type) {
+  if (g_strcmp0(type, "audio") == 0)
+    return GST_STREAM_TYPE_AUDIO;
+  if (g_strcmp0(type, "video") == 0)
+    return GST_STREAM_TYPE_VIDEO;
+  if (g_strcmp0(type, "text") == 0)
+    return GST_STREAM_TYPE_TEXT;
+  return GST_STREAM_TYPE_UNKNOWN;
+}
+
 void GstMedia::GetMediaInfo(MediaFileInfo* info, size_t index, const gchar* name) {
   if (!pipeline_ || !info || !name)
     return;
@@ -1053,7 +1455,17 @@ void GstMedia::GetAudioTagInfo(MediaFileAudioInfo& info, GstTagList* tags) {
 }
 
 void GstMedia::GetVideoPadInfo(MediaFileVideoInfo& info, GstPad* pad) {
-  GstCaps *caps = nullptr;
+  if (!pad)
+    return;
+
+  GstCaps* caps = gst_pad_get_current_caps(pad);
+  if (!caps)
+    return;
+  GetVideoCapsInfo(info, caps);
+  gst_caps_unref(caps);
+}
+
+void GstMedia::GetVideoCapsInfo(MediaFileVideoInfo& info, GstCaps* caps) {
   GstStructure *structure = nullptr;
   gchar *caps_str = nullptr;
   gint width = 0;
@@ -1061,11 +1473,7 @@ void GstMedia::GetVideoPadInfo(MediaFileVideoInfo& info, GstPad* pad) {
   gint num = 0;
   gint denom = 0;
 
-  if (!pad)
-    return;
-
-  caps = gst_pad_get_current_caps(pad);
-  if (!gst_caps_is_fixed(caps))
+  if (!caps || !gst_caps_is_fixed(caps))
     return;
 
   structure = gst_caps_get_structure (caps, 0);
@@ -1084,23 +1492,27 @@ void GstMedia::GetVideoPadInfo(MediaFileVideoInfo& info, GstPad* pad) {
   LOG_INFO("GST_PAD_VIDEO WIDTH[%d] HEIGHT[%d] Framerate[%d / %d]", width, height, num, denom);
   media_type_ = "video";
 
-  if(caps)
-    gst_caps_unref(caps);
   if(caps_str)
     g_free(caps_str);
 }
 
 void GstMedia::GetAudioPadInfo(MediaFileAudioInfo& info, GstPad* pad) {
-  GstCaps *caps = nullptr;
+  if(!pad)
+    return;
+
+  GstCaps* caps = gst_pad_get_current_caps(pad);
+  if (!caps)
+    return;
+  GetAudioCapsInfo(info, caps);
+  gst_caps_unref(caps);
+}
+
+void GstMedia::GetAudioCapsInfo(MediaFileAudioInfo& info, GstCaps* caps) {
   GstStructure *structure = nullptr;
   gchar *caps_str = nullptr;
   gint samplerate = 0;
 
-  if(!pad)
-    return;
-
-  caps = gst_pad_get_current_caps(pad);
-  if(!gst_caps_is_fixed(caps))
+  if (!caps || !gst_caps_is_fixed(caps))
     return;
 
   structure = gst_caps_get_structure (caps, 0);
@@ -1110,8 +1522,6 @@ void GstMedia::GetAudioPadInfo(MediaFileAudioInfo& info, GstPad* pad) {
   LOG_INFO("GST_CAPS_AUDIO SAMPLERATE[%d]", samplerate);
   media_type_ = "audio";
 
-  if(caps)
-    gst_caps_unref(caps);
   if(caps_str)
     g_free(caps_str);
 }
@@ -1130,6 +1540,8 @@ bool GstMedia::SetSubtitleEnable(bool show) {
   }
   g_object_set(G_OBJECT(pipeline_), "flags", flags, nullptr);
   LOG_INFO("Set flag value: %.4x",flags);
+  if (use_playbin3_ && !show)
+    stream_selection_.Select(pipeline_, GST_STREAM_TYPE_TEXT, -1);
   return true;
 }
 
@@ -1137,6 +1549,11 @@ bool GstMedia::SetSubtitleLanguageIndex(int index) {
   if (!pipeline_)
     return false;
 
+  if (use_playbin3_) {
+    SetSubtitleEnable(true);
+    return stream_selection_.Select(pipeline_, GST_STREAM_TYPE_TEXT, index);
+  }
+
   int num_text = 0;
   g_object_get(G_OBJECT(pipeline_), "n-text", &num_text, nullptr);
   LOG_INFO("n-text:%d, req-index:%d", num_text, index);
@@ -1153,6 +1570,10 @@ bool GstMedia::SetAudioLanguage(int index) {
   if (!pipeline_)
     return false;
 
+  // only the decoder of the new track is plugged, the pipeline keeps running
+  if (use_playbin3_)
+    return stream_selection_.Select(pipeline_, GST_STREAM_TYPE_AUDIO, index);
+
   int num_audio = 0;
   int cur_audio_index = -1;
   g_object_get(G_OBJECT(pipeline_), "current-audio", &cur_audio_index, nullptr);
@@ -1170,6 +1591,7 @@ bool GstMedia::SetAudioLanguage(int index) {
 bool GstMedia::SetPlaybackSpeed(double rate) {
 
   LOG_INFO("Set speed with (%lf) rate", rate);
+  trick_mode_probe_.Reset();
   gint64 position = 0;
   if (GetCurPosition(&position) == true) {
     GstEvent *seek;
@@ -1187,6 +1609,7 @@ bool GstMedia::SetPlaybackSpeed(double rate) {
                                   GST_SEEK_TYPE_SET, 0,
                                   GST_SEEK_TYPE_SET, position);
     }
+    position_clock_.Invalidate("rate");
     if (!gst_element_send_event (pipeline_, seek)) {
       LOG_ERROR("Error - gst_element_send_event speed");
       return false;
@@ -1197,6 +1620,43 @@ bool GstMedia::SetPlaybackSpeed(double rate) {
   return true;
 }
 
+bool GstMedia::SeekTrickMode(double rate, gint64 position) {
+  if (!pipeline_) {
+    LOG_ERROR("return with null pipeline");
+    return false;
+  }
+
+  // decode key frames only and let the audio sink drop out, so the demuxer paces the playback itself
+  GstSeekFlags flags = GstSeekFlags(GST_SEEK_FLAG_FLUSH | GST_SEEK_FLAG_TRICKMODE |
+                                    GST_SEEK_FLAG_TRICKMODE_KEY_UNITS | GST_SEEK_FLAG_TRICKMODE_NO_AUDIO);
+  GstEvent* seek = nullptr;
+  if (rate > 0) {
+    seek = gst_event_new_seek((gdouble)rate, GST_FORMAT_TIME, flags,
+                              GST_SEEK_TYPE_SET, position,
+                              GST_SEEK_TYPE_NONE, GST_CLOCK_TIME_NONE);
+  } else {
+    seek = gst_event_new_seek((gdouble)rate, GST_FORMAT_TIME, flags,
+                              GST_SEEK_TYPE_SET, 0,
+                              GST_SEEK_TYPE_SET, position);
+  }
+
+  // an accepted seek may still end in a normal segment, the probe reports that from the video sink
+  GstElement* video_sink = nullptr;
+  g_object_get(G_OBJECT(pipeline_), "video-sink", &video_sink, nullptr);
+  trick_mode_probe_.Watch(video_sink, rate);
+  if (video_sink)
+    gst_object_unref(video_sink);
+
+  position_clock_.Invalidate("rate");
+  if (!gst_element_send_event(pipeline_, seek)) {
+    LOG_INFO("trick mode seek rate=[%lf] is not handled by the demuxer", rate);
+    trick_mode_probe_.Reset();
+    return false;
+  }
+  LOG_INFO("trick mode seek rate=[%lf] position=[%lld]", rate, position);
+  return true;
+}
+
 bool GstMedia::SetAudioMute(bool mute) {
   if (!pipeline_)
     return false;
@@ -1225,10 +1685,19 @@ bool GstMedia::SetAudioVolume(double volume) {
   return true;
 }
 
-bool GstMedia::SwitchChannel(bool downmix, char slot, char slot_6ch, bool is_dsd, const std::string& media_type, bool provide_global_clock, GstElement* audio_sink, GstElement* parent) {
+bool GstMedia::SwitchChannel(bool downmix, char slot, char slot_6ch, bool is_dsd, const std::string& media_type, bool provide_global_clock, GstElement* audio_sink, GstElement* parent, bool allow_live) {
   if (!pipeline_)
     return false;
   LOG_INFO("downmix %s", downmix ? "enable" : "disable");
+  int mix_channel = 0;
+  if(downmix)
+    mix_channel = 2;
+  else
+    mix_channel = 6;
+
+  if (allow_live && Conf::GetFeatures(SUPPORT_LIVE_SINK_SWAP) && SwitchChannelLive(mix_channel, slot, slot_6ch, is_dsd, media_type))
+    return true;
+
   gint64 position = 0;
   if (GetCurPosition(&position)) {
     LOG_INFO("current position=[%lld]", position);
@@ -1239,12 +1708,6 @@ bool GstMedia::SwitchChannel(bool downmix, char slot, char slot_6ch, bool is_dsd
   ret = ChangeStateToReady();
   if(!ret)
    return false;
-  
-  int mix_channel = 0;
-  if(downmix)
-    mix_channel = 2;
-  else
-    mix_channel = 6;
 
   gchar* audio_sink_ = Conf::GetSink(AUDIO_SINK);
   if (strlen(audio_sink_)) {
@@ -1269,6 +1732,57 @@ bool GstMedia::SwitchChannel(bool downmix, char slot, char slot_6ch, bool is_dsd
   return true;
 }
 
+bool GstMedia::SwitchChannelLive(int channel, char slot, char slot_6ch, bool is_dsd, const std::string& media_type) {
+  GstState state = GST_STATE_VOID_PENDING;
+  GstState pending = GST_STATE_VOID_PENDING;
+  gst_element_get_state(pipeline_, &state, &pending, 0);
+  if (state != GST_STATE_PLAYING || pending != GST_STATE_VOID_PENDING) {
+    LOG_INFO("live sink swap needs a settled PLAYING pipeline, state=[%s]", gst_element_state_get_name(state));
+    return false;
+  }
+
+  // the caller's pointer is stale after a legacy switch, playbin always holds the bin in use
+  GstElement* current_sink = nullptr;
+  g_object_get(G_OBJECT(pipeline_), "audio-sink", &current_sink, nullptr);
+  if (!current_sink)
+    return false;
+
+  if (slot == (char)-1)
+    slot = '1';
+  std::string alsa_name;
+  std::string device = GetAlsaDevice(slot, slot_6ch, channel, media_type, alsa_name);
+
+  // the re-opened sink goes through NULL and posts CLOCK_LOST for the clock it provides. Fixing the
+  // pipeline to the clock in use keeps it selected, the audio clock holds its last time during the gap
+  // and continues from there, so no PAUSED->PLAYING is needed to pick a clock again.
+  GstClock* clock = gst_element_get_clock(pipeline_);
+  if (clock) {
+    gst_pipeline_use_clock(GST_PIPELINE(pipeline_), clock);
+    gst_object_unref(clock);
+  }
+  g_atomic_int_set(&sink_swap_pending_, TRUE);
+
+  bool ret = AudioSinkSwap::Start(current_sink, channel, is_dsd, GetChannelCaps(channel, is_dsd, media_type), device);
+  gst_object_unref(current_sink);
+  // the result arrives as AUDIO_SINK_SWAP_MESSAGE, the caller notifies the channel from there
+  if (!ret)
+    SinkSwapDone();
+  return ret;
+}
+
+bool GstMedia::IsSinkSwapPending() {
+  return g_atomic_int_get(&sink_swap_pending_) != FALSE;
+}
+
+bool GstMedia::SinkSwapDone() {
+  // called for the result message on the bus thread and for timeout and unload on the main context
+  if (!g_atomic_int_compare_and_exchange(&sink_swap_pending_, TRUE, FALSE))
+    return false;
+  if (pipeline_)
+    gst_pipeline_auto_clock(GST_PIPELINE(pipeline_));
+  return true;
+}
+
 bool GstMedia::SetTag(const std::string& key, const std::string& value) {
   GstElement* tag_setter_element = nullptr;
   GstTagSetter *tagsetter = nullptr;
@@ -1327,68 +1841,46 @@ void GstMedia::SetSeekStatus(bool status) {
 }
 
 bool GstMedia::ExtractThumbnail(const char* uri, const char* format) {
-/*
-  GstElement *sink;
-  gint width;
-  gint height;
-  GstSample *sample = nullptr;
-  GError *error = nullptr;
-  GdkPixbuf *pixbuf;
-  gboolean res;
-  GstMapInfo map;
-
-  sink = gst_bin_get_by_name(GST_BIN(pipeline_), "sink");
-  if (!sink) {
-    LOG_ERROR ("could not get sink element! \n");
+  GstSample* sample = PullThumbnailSample();
+  if (!sample)
     return false;
-  }
-
-  g_signal_emit_by_name (sink, "pull-preroll", &sample, nullptr);
-  gst_object_unref (sink);
-
-  if (sample) {
-    GstBuffer *buffer;
-    GstCaps *caps;
-    GstStructure *s;
-
-    caps = gst_sample_get_caps (sample);
-    if (!caps) {
-      LOG_ERROR ("could not get snapshot format\n");
-      return false;
-    }
-
-    s = gst_caps_get_structure (caps, 0);
-    res = gst_structure_get_int (s, "width", &width);
-    res |= gst_structure_get_int (s, "height", &height);
-    if (!res) {
-      LOG_ERROR ("could not get snapshot dimension\n");
-      return false;
-    }
-
-    buffer = gst_sample_get_buffer (sample);
-    res = gst_buffer_map (buffer, &map, GST_MAP_READ);
-    pixbuf = gdk_pixbuf_new_from_data (map.data,
-                                       GDK_COLORSPACE_RGB, false, 8, width, height,
-                                       GST_ROUND_UP_4 (width * 3), nullptr, nullptr);
+  bool ret = ThumbnailEncoder::EncodeToFile(sample, format, uri);
+  gst_sample_unref(sample);
+  return ret;
+}
 
-    if (g_strcmp0(format,"jpeg") == 0) {
-      if (!gdk_pixbuf_save (pixbuf, uri, format, &error, "quality", "100", nullptr))
-        LOG_ERROR ("failed to save pixbuf");
-    }
-    else {
-      if (!gdk_pixbuf_save (pixbuf, uri, format, &error, nullptr))
-        LOG_ERROR ("failed to save pixbuf");
-    }
+bool GstMedia::ExtractThumbnail(const char* format, ThumbnailImage* image) {
+  GstSample* sample = PullThumbnailSample();
+  if (!sample)
+    return false;
+  bool ret = ThumbnailEncoder::EncodeToMemfd(sample, format, image);
+  gst_sample_unref(sample);
+  return ret;
+}
 
-    gst_buffer_unmap (buffer, &map);
+GstSample* GstMedia::PullThumbnailSample() {
+  GstSample* sample = nullptr;
+  GstElement* sink = gst_bin_get_by_name(GST_BIN(pipeline_), "sink");
+  if (!sink) {
+    LOG_ERROR("could not get sink element!");
+    return nullptr;
   }
-  else {
-    LOG_ERROR ("could not make thumbnail\n");
-    return false;
+
+  if (Conf::GetFeatures(SUPPORT_THUMBNAIL_KEYFRAME))
+    sample = ThumbnailFrameSelector::Capture(pipeline_, sink, Conf::GetSpec(THUMBNAIL_POSITION),
+                                             (gint)g_ascii_strtoll(Conf::GetThumbnail(THUMBNAIL_WIDTH),
+                                                                   nullptr, 10));
+  else
+    g_signal_emit_by_name(sink, "pull-preroll", &sample, nullptr);
+  gst_object_unref(sink);
+  if (!sample) {
+    LOG_ERROR("could not make thumbnail");
+    return nullptr;
   }
 
-*/
-  return true;
+  // with SUPPORT_THUMBNAIL_SCALER the sink takes the decoded frame as it is
+  gint width = (gint)g_ascii_strtoll(Conf::GetThumbnail(THUMBNAIL_WIDTH), nullptr, 10);
+  return ThumbnailScaler::ToRgb(sample, width);
 }
 
 std::string GstMedia::GetRawURI(const std::string& uri) {
@@ -1454,42 +1946,10 @@ bool GstMedia::IsMtpFile(const std::string& uri) {
 }
 
 void GstMedia::SetTaskPriority(const gchar* name, gint priority) {
-  gchar* dir_path = nullptr;
-  GDir *process_dir = nullptr;
-  GError *error = nullptr;
-  const gchar *task_filename = nullptr;
-
-  dir_path = g_strdup_printf ("/proc/%d/task", getpid ());
-  if (!dir_path){
-    LOG_ERROR ("g_strdup_printf() failed in path");
-    goto _EXIT;
-  }
-  process_dir = g_dir_open (dir_path, 0, &error);
-  if (!process_dir) {
-    if (error) {
-      if (error->message) {
-        LOG_ERROR ("g_dir_open() failed in path-%s", error->message);
-      } else {
-        LOG_ERROR ("g_dir_open() failed in path");
-      }
-      g_clear_error (&error);
-    }
-    goto _EXIT;
-  }
-
+  // streaming threads are registered on STREAM_STATUS ENTER, no need to scan /proc/{pid}/task
   LOG_INFO ("try to increase priority of %s", name);
-
-  while ((task_filename = g_dir_read_name (process_dir))) {
-    // try to find 'taskname' in /proc/{pid}/task/{tid}/comm files
-    SetTaskPriorityInternal(name, task_filename, dir_path, process_dir, priority);
-  }
-
-_EXIT:
-  if (dir_path)
-    g_free (dir_path);
-  if (process_dir)
-    g_dir_close (process_dir);
-  return;
+  if (ThreadRegistry::Instance()->SetNice(name, priority) == 0)
+    LOG_INFO ("no registered task (%s)", name);
 }
 
 void GstMedia::PrintGstDot(const gchar* name) {
@@ -1499,14 +1959,59 @@ void GstMedia::PrintGstDot(const gchar* name) {
 
 gboolean GstMedia::BusCallbackFunc(GstBus* bus, GstMessage* message, gpointer data) {
   GstMedia* handler = reinterpret_cast<GstMedia*> (data);
+  // the first ASYNC_DONE after SetSourceURI() ends the load of the path it selected
+  if (GST_MESSAGE_TYPE(message) == GST_MESSAGE_ASYNC_DONE && handler->load_start_us_ &&
+      GST_MESSAGE_SRC(message) == GST_OBJECT_CAST(handler->pipeline_)) {
+    FastPathBin::ReportLoad(GST_ELEMENT_NAME(handler->pipeline_), handler->fast_path_load_,
+                            g_get_monotonic_time() - handler->load_start_us_);
+    handler->load_start_us_ = 0;
+  }
   return handler->bus_callback_(bus, message, data);
 }
 
+GstBusSyncReply GstMedia::SyncBusCallbackFunc(GstBus* bus, GstMessage* message, gpointer data) {
+  GstMedia* handler = reinterpret_cast<GstMedia*> (data);
+  ThreadRegistry::Instance()->HandleSyncMessage(message);
+
+  // discontinuities of the running-time, seen before any message filtering
+  switch (GST_MESSAGE_TYPE(message)) {
+    case GST_MESSAGE_STATE_CHANGED:
+      if (GST_MESSAGE_SRC(message) == GST_OBJECT_CAST(handler->pipeline_))
+        handler->position_clock_.Invalidate("state-changed");
+      break;
+    case GST_MESSAGE_ASYNC_DONE:
+      handler->position_clock_.Invalidate("async-done");
+      break;
+    case GST_MESSAGE_NEW_CLOCK:
+    case GST_MESSAGE_CLOCK_LOST:
+      handler->position_clock_.Invalidate("clock");
+      break;
+    case GST_MESSAGE_STREAM_START:
+      handler->position_clock_.Invalidate("stream-start");
+      break;
+    case GST_MESSAGE_BUFFERING:
+      handler->position_clock_.Invalidate("buffering");
+      break;
+    case GST_MESSAGE_QOS:
+      // the bus thread drops QoS messages, they are only counted here
+      handler->qos_monitor_.HandleSyncMessage(message);
+      break;
+    default:
+      break;
+  }
+  return GST_BUS_PASS;
+}
+
 void GstMedia::ElementAddCallbackFunc(GstBin* bin, GstElement *element, gpointer data) {
   GstMedia* handler = reinterpret_cast<GstMedia*> (data);
   handler->pipeline_elementadd_callback_(bin, element, data);
 }
 
+void GstMedia::DeepElementAddCallbackFunc(GstBin* bin, GstBin* sub_bin, GstElement *element, gpointer data) {
+  // the pipeline name is the policy scope, e.g. "video_pipeline"
+  ElementPolicy::Instance()->Apply(GST_OBJECT_NAME(bin), element);
+}
+
 void GstMedia::UriDecodeBinElementAddCallbackFunc(GstBin* bin, GstElement *element, gpointer data) {
   GstMedia* handler = reinterpret_cast<GstMedia*> (data);
   handler->uridecodebin_elementadd_callback_(bin, element, data);
@@ -1538,40 +2043,13 @@ void GstMedia::NoMorePadsCallbackFunc(GstElement *element, gpointer data) {
 }
 
 void GstMedia::HandleSeekControl(int message) {
+  // a timed out drag seek is only reported once the coalesced target is reached
+  if (!seek_scheduler_->OnDone(true))
+    return;
   if (seek_callback_)
     seek_callback_(message);
 }
 
-void GstMedia::SetTaskPriorityInternal(const gchar* name, const gchar* task_filename,
-                                       const gchar* dir_path, GDir* directory, gint priority) {
-  FILE *fp = nullptr;
-  size_t size;
-  ssize_t readsize;
-  gchar *line_str = nullptr;
-  gchar* file_path = nullptr;
-
-  file_path = g_strdup_printf ("%s/%s/comm", dir_path, task_filename);
-  if (!file_path)
-    return;
-  fp = fopen (file_path, "r");
-  if (fp) {
-    readsize = getdelim (&line_str, &size, '\n', fp);
-    if ((readsize > 0) &&
-        (nullptr != g_strrstr (line_str, name))) {
-
-      LOG_INFO ("found  task (%s:%d)\n", name, atoi (task_filename));
-      if (setpriority (PRIO_PROCESS, atoi (task_filename), priority) != -1)
-        LOG_INFO ("set the (tid:%s) priority to %d\n", name, priority);
-    }
-    if (line_str)
-      g_free (line_str);
-    fclose (fp);
-  } else {
-    LOG_ERROR ("failed to open [%s] \n", file_path);
-  }
-  g_free (file_path);
-}
-
 
 } // namespace genivimedia
 
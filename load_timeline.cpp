@@ -0,0 +1,250 @@
+// @@@LICENSE
+//
+// Copyright (C) 2023, LG Electronics, All Right Reserved.
+//
+// No part of this source code may be communicated, distributed, reproduced
+// or transmitted in any form or by any means, electronic or mechanical or
+// otherwise, for any purpose, without the prior written permission of
+// LG Electronics.
+//
+// LICENSE@@@
+
+#include "player/pipeline/load_timeline.h"
+
+#include <boost/property_tree/json_parser.hpp>
+#include <boost/property_tree/ptree.hpp>
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <sstream>
+
+#include "logger/player_logger.h"
+#include "player/pipeline/conf.h"
+
+namespace genivimedia {
+
+LoadTimeline* LoadTimeline::instance_ = nullptr;
+
+LoadTimeline* LoadTimeline::Instance() {
+  if (instance_ == nullptr) {
+    instance_ = new LoadTimeline();
+  }
+  return instance_;
+}
+
+void LoadTimeline::Destroy() {
+  if (instance_) {
+    delete instance_;
+    instance_ = nullptr;
+  }
+}
+
+LoadTimeline::LoadTimeline()
+  : mutex_(),
+    callback_(),
+    uri_(),
+    points_(),
+    count_(0),
+    dropped_(0),
+    running_(false),
+    generation_(0),
+    watches_(0),
+    watched_(0),
+    emit_source_id_(0),
+    settle_source_id_(0) {
+}
+
+LoadTimeline::~LoadTimeline() {
+  if (emit_source_id_)
+    g_source_remove(emit_source_id_);
+  if (settle_source_id_)
+    g_source_remove(settle_source_id_);
+}
+
+void LoadTimeline::Begin(const std::string& uri) {
+  gint64 now = g_get_monotonic_time();
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (emit_source_id_) {
+    g_source_remove(emit_source_id_);
+    emit_source_id_ = 0;
+  }
+  if (settle_source_id_) {
+    g_source_remove(settle_source_id_);
+    settle_source_id_ = 0;
+  }
+  uri_ = uri;
+  count_ = 0;
+  dropped_ = 0;
+  running_ = true;
+  generation_++;
+  watches_ = 0;
+  watched_ = 0;
+  MarkLocked("set-uri", now);
+}
+
+void LoadTimeline::Mark(const gchar* name) {
+  gint64 now = g_get_monotonic_time();
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (running_)
+    MarkLocked(name, now);
+}
+
+void LoadTimeline::WatchFirstBuffer(GstElement* sink, const gchar* name) {
+  if (!sink)
+    return;
+  GstPad* pad = gst_element_get_static_pad(sink, "sink");
+  if (!pad) {
+    LOG_ERROR("%s has no sink pad", GST_ELEMENT_NAME(sink));
+    return;
+  }
+
+  Watch* watch = new Watch();
+  watch->name_ = name;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    watch->generation_ = generation_;
+    watches_++;
+  }
+  gst_pad_add_probe(pad, GST_PAD_PROBE_TYPE_BUFFER, FirstBufferProbe, watch, FreeWatch);
+  gst_object_unref(pad);
+}
+
+void LoadTimeline::SetCallback(LoadTimelineCallback callback) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  callback_ = callback;
+  if (!callback_ && emit_source_id_) {
+    g_source_remove(emit_source_id_);
+    emit_source_id_ = 0;
+  }
+}
+
+GstPadProbeReturn LoadTimeline::FirstBufferProbe(GstPad* pad, GstPadProbeInfo* info, gpointer data) {
+  Watch* watch = reinterpret_cast<Watch*>(data);
+  gint64 now = g_get_monotonic_time();
+  LoadTimeline* timeline = LoadTimeline::Instance();
+
+  std::lock_guard<std::mutex> lock(timeline->mutex_);
+  if (!timeline->running_ || watch->generation_ != timeline->generation_)
+    return GST_PAD_PROBE_REMOVE;
+
+  timeline->MarkLocked(watch->name_, now);
+  timeline->watched_++;
+  if (timeline->watched_ >= timeline->watches_) {
+    timeline->FinishLocked();
+  } else if (!timeline->settle_source_id_) {
+    // a stream the file does not have never marks, e.g. the video of an audio-only file
+    timeline->settle_source_id_ = g_timeout_add(kSettleTimeoutMs, SettleTimeoutFunc, timeline);
+  }
+  return GST_PAD_PROBE_REMOVE;
+}
+
+gboolean LoadTimeline::SettleTimeoutFunc(gpointer data) {
+  LoadTimeline* timeline = reinterpret_cast<LoadTimeline*>(data);
+  std::lock_guard<std::mutex> lock(timeline->mutex_);
+  timeline->settle_source_id_ = 0;
+  if (timeline->running_) {
+    LOG_INFO("%u of %u sinks got a buffer", timeline->watched_, timeline->watches_);
+    timeline->FinishLocked();
+  }
+  return G_SOURCE_REMOVE;
+}
+
+gboolean LoadTimeline::EmitCallbackFunc(gpointer data) {
+  LoadTimeline* timeline = reinterpret_cast<LoadTimeline*>(data);
+  LoadTimelineCallback callback;
+  std::string uri;
+  std::vector<Point> points;
+  guint dropped = 0;
+  {
+    std::lock_guard<std::mutex> lock(timeline->mutex_);
+    timeline->emit_source_id_ = 0;
+    uri = timeline->uri_;
+    points.assign(timeline->points_, timeline->points_ + timeline->count_);
+    dropped = timeline->dropped_;
+    callback = timeline->callback_;
+  }
+
+  // streaming threads mark the next load meanwhile, the file is written without the lock
+  std::string json = MakeJson(uri, points, dropped);
+  gchar* path = Conf::GetLoadTracePath();
+  if (path && strlen(path))
+    WriteTrace(path, points);
+  LOG_INFO("%s", json.c_str());
+  if (callback)
+    callback(json);
+  return G_SOURCE_REMOVE;
+}
+
+void LoadTimeline::FreeWatch(gpointer data) {
+  delete reinterpret_cast<Watch*>(data);
+}
+
+void LoadTimeline::MarkLocked(const gchar* name, gint64 time_us) {
+  if (count_ >= kMaxMarks) {
+    dropped_++;
+    return;
+  }
+  points_[count_].name_ = name;
+  points_[count_].time_us_ = time_us;
+  count_++;
+}
+
+void LoadTimeline::FinishLocked() {
+  running_ = false;
+  if (settle_source_id_) {
+    g_source_remove(settle_source_id_);
+    settle_source_id_ = 0;
+  }
+  if (!emit_source_id_)
+    emit_source_id_ = g_idle_add(EmitCallbackFunc, this);
+}
+
+std::string LoadTimeline::MakeJson(const std::string& uri, const std::vector<Point>& points, guint dropped) {
+  using boost::property_tree::ptree;
+  ptree marks;
+  gint64 start = points.empty() ? 0 : points.front().time_us_;
+  for (const Point& point : points) {
+    ptree mark;
+    mark.put("name", point.name_);
+    mark.put("us", point.time_us_ - start);
+    marks.push_back(std::make_pair("", mark));
+  }
+
+  ptree timeline;
+  timeline.put("uri", uri);
+  timeline.put("total_us", points.empty() ? 0 : points.back().time_us_ - start);
+  timeline.put("dropped", dropped);
+  timeline.add_child("marks", marks);
+  ptree tree;
+  tree.add_child("LoadTimeline", timeline);
+
+  std::stringstream stream;
+  boost::property_tree::write_json(stream, tree, false);
+  return stream.str();
+}
+
+void LoadTimeline::WriteTrace(const gchar* path, const std::vector<Point>& points) {
+  FILE* fp = fopen(path, "w");
+  if (!fp) {
+    LOG_ERROR("Failed to open trace file %s", path);
+    return;
+  }
+
+  // one complete event for the whole load and one instant event per mark, timestamps in us
+  int pid = (int)getpid();
+  gint64 start = points.empty() ? 0 : points.front().time_us_;
+  gint64 end = points.empty() ? 0 : points.back().time_us_;
+  fprintf(fp, "{\"traceEvents\":[\n");
+  fprintf(fp, "{\"name\":\"load\",\"ph\":\"X\",\"pid\":%d,\"tid\":0,\"ts\":%lld,\"dur\":%lld}",
+          pid, (long long)start, (long long)(end - start));
+  for (const Point& point : points) {
+    fprintf(fp, ",\n{\"name\":\"%s\",\"ph\":\"i\",\"s\":\"p\",\"pid\":%d,\"tid\":0,\"ts\":%lld}",
+            point.name_, pid, (long long)point.time_us_);
+  }
+  fprintf(fp, "\n]}\n");
+  fclose(fp);
+}
+
+}  // namespace genivimedia
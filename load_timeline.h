@@ -0,0 +1,122 @@
+// @@@LICENSE
+//
+// Copyright (C) 2023, LG Electronics, All Right Reserved.
+//
+// No part of this source code may be communicated, distributed, reproduced
+// or transmitted in any form or by any means, electronic or mechanical or
+// otherwise, for any purpose, without the prior written permission of
+// LG Electronics.
+//
+// LICENSE@@@
+
+#ifndef GENIVIMEDIA_LOAD_TIMELINE_H
+#define GENIVIMEDIA_LOAD_TIMELINE_H
+
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <glib.h>
+#include <gst/gst.h>
+
+namespace genivimedia {
+
+typedef std::function<void(const std::string& json)> LoadTimelineCallback;
+
+/**
+ * @class      genivimedia::LoadTimeline
+ * @brief      Monotonic timestamps of the load path, from SetURI to the first rendered frame.
+ * @details    Begin() starts a timeline, Mark() appends a named point from any thread, and it ends when
+ *             every sink watched with WatchFirstBuffer() has seen its first buffer, or kSettleTimeoutMs
+ *             after the first of them when another never gets one (audio-only or video-only files).
+ *             The timeline is then emitted once from the main
+ *             context as {"LoadTimeline":{"uri":...,"total_us":N,"marks":[{"name":...,"us":N},...]}}
+ *             and, when Conf::GetLoadTracePath() is set, written to that file in Chrome trace format
+ *             (chrome://tracing, Perfetto). A mark is a lock and two stores into a fixed array of
+ *             kMaxMarks entries; names must be static or interned strings. The first buffer probes
+ *             remove themselves, so nothing stays on the streaming path after the first frame. The
+ *             marks are copied out before the JSON and the trace file are written.
+ * @see        genivimedia::VideoPipeline
+ */
+class LoadTimeline {
+ public:
+  static LoadTimeline* Instance();
+  static void Destroy();
+
+  /**
+   * @fn Begin
+   * @brief Drops the previous timeline and starts a new one with a "set-uri" mark.
+   * @param[in] uri : uri being loaded
+   * @return None
+   */
+  void Begin(const std::string& uri);
+
+  /**
+   * @fn Mark
+   * @brief Appends a point to the running timeline, ignored before Begin() and after the end.
+   * @param[in] name : static or interned string
+   * @return None
+   */
+  void Mark(const gchar* name);
+
+  /**
+   * @fn WatchFirstBuffer
+   * @brief Marks the first buffer arriving at the sink pad of the element.
+   * @param[in] sink : video or audio sink (or sink bin), expected to receive data in this load
+   * @param[in] name : mark name
+   * @return None
+   */
+  void WatchFirstBuffer(GstElement* sink, const gchar* name);
+
+  /**
+   * @fn SetCallback
+   * @brief Sets the receiver of the finished timeline, an empty callback cancels the emission.
+   */
+  void SetCallback(LoadTimelineCallback callback);
+
+ private:
+  static const guint kMaxMarks = 64;
+  static const guint kSettleTimeoutMs = 2000;
+
+  struct Point {
+    const gchar* name_;
+    gint64 time_us_;
+  };
+
+  struct Watch {
+    const gchar* name_;
+    guint generation_;
+  };
+
+  LoadTimeline();
+  ~LoadTimeline();
+
+  static GstPadProbeReturn FirstBufferProbe(GstPad* pad, GstPadProbeInfo* info, gpointer data);
+  static gboolean EmitCallbackFunc(gpointer data);
+  static gboolean SettleTimeoutFunc(gpointer data);
+  static void FreeWatch(gpointer data);
+  static std::string MakeJson(const std::string& uri, const std::vector<Point>& points, guint dropped);
+  static void WriteTrace(const gchar* path, const std::vector<Point>& points);
+  void MarkLocked(const gchar* name, gint64 time_us);
+  void FinishLocked();
+
+  static LoadTimeline* instance_;
+
+  std::mutex mutex_;
+  LoadTimelineCallback callback_;
+  std::string uri_;
+  Point points_[kMaxMarks];
+  guint count_;
+  guint dropped_;
+  bool running_;
+  guint generation_;
+  guint watches_;     /**< sinks watched in this generation */
+  guint watched_;     /**< of them, those which have seen their first buffer */
+  guint emit_source_id_;
+  guint settle_source_id_;
+};
+
+}  // namespace genivimedia
+
+#endif  // GENIVIMEDIA_LOAD_TIMELINE_H
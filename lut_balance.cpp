@@ -0,0 +1,420 @@
+// @@@LICENSE
+//
+// Copyright (C) 2023, LG Electronics, All Right Reserved.
+//
+// No part of this source code may be communicated, distributed, reproduced
+// or transmitted in any form or by any means, electronic or mechanical or
+// otherwise, for any purpose, without the prior written permission of
+// LG Electronics.
+//
+// LICENSE@@@
+
+#include "player/pipeline/lut_balance.h"
+
+#include <gst/video/video.h>
+#include <gst/video/gstvideofilter.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
+#include "logger/player_logger.h"
+
+namespace genivimedia {
+
+namespace {
+
+// Q9: out = ((in - center) * k >> 9) + center + add, k = 512 is identity
+const gint kFixedOne = 512;
+
+enum {
+  PROP_0,
+  PROP_BRIGHTNESS,
+  PROP_CONTRAST,
+  PROP_SATURATION
+};
+
+struct Plane {
+  gint center_;
+  gint k_;
+  gint add_;
+  guint8 lut_[256];
+};
+
+}  // namespace
+
+typedef struct _GeniviLutBalance {
+  GstVideoFilter parent_;
+  gdouble brightness_;
+  gdouble contrast_;
+  gdouble saturation_;
+  Plane luma_;
+  Plane chroma_;
+} GeniviLutBalance;
+
+typedef struct _GeniviLutBalanceClass {
+  GstVideoFilterClass parent_class_;
+} GeniviLutBalanceClass;
+
+GType genivi_lut_balance_get_type(void);
+G_DEFINE_TYPE(GeniviLutBalance, genivi_lut_balance, GST_TYPE_VIDEO_FILTER)
+
+#define GENIVI_LUT_BALANCE(obj) \
+  (G_TYPE_CHECK_INSTANCE_CAST((obj), genivi_lut_balance_get_type(), GeniviLutBalance))
+
+namespace {
+
+void BuildPlane(Plane* plane, gint center, gdouble gain, gint add) {
+  plane->center_ = center;
+  plane->k_ = (gint)(gain * kFixedOne + 0.5);
+  plane->add_ = add;
+  for (gint i = 0; i < 256; i++) {
+    gint value = (((i - center) * plane->k_) >> 9) + center + add;
+    plane->lut_[i] = (guint8)CLAMP(value, 0, 255);
+  }
+}
+
+bool IsIdentity(const Plane& plane) {
+  return plane.k_ == kFixedOne && plane.add_ == 0;
+}
+
+void ApplyLut(const Plane& plane, guint8* data, gint size) {
+  for (gint i = 0; i < size; i++)
+    data[i] = plane.lut_[data[i]];
+}
+
+// (x << 7) * k >> 16 equals x * k >> 9, and x << 7 fits in int16 for x in [-128, 239]
+#if defined(__SSE2__)
+gint ApplySse2(const Plane& plane, guint8* data, gint size) {
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i center = _mm_set1_epi16((short)plane.center_);
+  const __m128i k = _mm_set1_epi16((short)plane.k_);
+  const __m128i add = _mm_set1_epi16((short)(plane.center_ + plane.add_));
+  gint i = 0;
+  for (; i + 16 <= size; i += 16) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<__m128i*>(data + i));
+    __m128i lo = _mm_slli_epi16(_mm_sub_epi16(_mm_unpacklo_epi8(v, zero), center), 7);
+    __m128i hi = _mm_slli_epi16(_mm_sub_epi16(_mm_unpackhi_epi8(v, zero), center), 7);
+    lo = _mm_add_epi16(_mm_mulhi_epi16(lo, k), add);
+    hi = _mm_add_epi16(_mm_mulhi_epi16(hi, k), add);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(data + i), _mm_packus_epi16(lo, hi));
+  }
+  return i;
+}
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+// unpack and packus both work per 128 bit lane, so the byte order is kept
+__attribute__((target("avx2")))
+gint ApplyAvx2(const Plane& plane, guint8* data, gint size) {
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i center = _mm256_set1_epi16((short)plane.center_);
+  const __m256i k = _mm256_set1_epi16((short)plane.k_);
+  const __m256i add = _mm256_set1_epi16((short)(plane.center_ + plane.add_));
+  gint i = 0;
+  for (; i + 32 <= size; i += 32) {
+    __m256i v = _mm256_loadu_si256(reinterpret_cast<__m256i*>(data + i));
+    __m256i lo = _mm256_slli_epi16(_mm256_sub_epi16(_mm256_unpacklo_epi8(v, zero), center), 7);
+    __m256i hi = _mm256_slli_epi16(_mm256_sub_epi16(_mm256_unpackhi_epi8(v, zero), center), 7);
+    lo = _mm256_add_epi16(_mm256_mulhi_epi16(lo, k), add);
+    hi = _mm256_add_epi16(_mm256_mulhi_epi16(hi, k), add);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(data + i), _mm256_packus_epi16(lo, hi));
+  }
+  return i;
+}
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+gint ApplyNeon(const Plane& plane, guint8* data, gint size) {
+  const int16x8_t center = vdupq_n_s16((int16_t)plane.center_);
+  const int16x4_t k = vdup_n_s16((int16_t)plane.k_);
+  const int16x8_t add = vdupq_n_s16((int16_t)(plane.center_ + plane.add_));
+  gint i = 0;
+  for (; i + 16 <= size; i += 16) {
+    uint8x16_t v = vld1q_u8(data + i);
+    int16x8_t lo = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(vget_low_u8(v))), center);
+    int16x8_t hi = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(vget_high_u8(v))), center);
+    lo = vaddq_s16(vcombine_s16(vshrn_n_s32(vmull_s16(vget_low_s16(lo), k), 9),
+                                vshrn_n_s32(vmull_s16(vget_high_s16(lo), k), 9)), add);
+    hi = vaddq_s16(vcombine_s16(vshrn_n_s32(vmull_s16(vget_low_s16(hi), k), 9),
+                                vshrn_n_s32(vmull_s16(vget_high_s16(hi), k), 9)), add);
+    vst1q_u8(data + i, vcombine_u8(vqmovun_s16(lo), vqmovun_s16(hi)));
+  }
+  return i;
+}
+#endif
+
+typedef gint (*KernelFunc)(const Plane& plane, guint8* data, gint size);
+
+#if !defined(__SSE2__) && !defined(__ARM_NEON) && !defined(__ARM_NEON__)
+gint ApplyNone(const Plane& plane, guint8* data, gint size) {
+  return 0;
+}
+#endif
+
+KernelFunc SelectKernel() {
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) {
+    LOG_INFO("lut balance uses AVX2");
+    return ApplyAvx2;
+  }
+#endif
+#if defined(__SSE2__)
+  LOG_INFO("lut balance uses SSE2");
+  return ApplySse2;
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+  LOG_INFO("lut balance uses NEON");
+  return ApplyNeon;
+#else
+  LOG_INFO("lut balance uses the tables only");
+  return ApplyNone;
+#endif
+}
+
+KernelFunc kernel = nullptr;
+
+void ApplyPlane(const Plane& plane, guint8* data, gint stride, gint row_bytes, gint rows) {
+  for (gint y = 0; y < rows; y++) {
+    guint8* row = data + (gsize)y * stride;
+    gint done = kernel(plane, row, row_bytes);
+    ApplyLut(plane, row + done, row_bytes - done);
+  }
+}
+
+// called with the object lock held
+void UpdateTables(GeniviLutBalance* self) {
+  BuildPlane(&self->luma_, 16, self->contrast_, (gint)(self->brightness_ * 255));
+  BuildPlane(&self->chroma_, 128, self->saturation_, 0);
+}
+
+}  // namespace
+
+static void genivi_lut_balance_set_property(GObject* object, guint prop_id,
+                                            const GValue* value, GParamSpec* pspec) {
+  GeniviLutBalance* self = GENIVI_LUT_BALANCE(object);
+  GST_OBJECT_LOCK(self);
+  switch (prop_id) {
+    case PROP_BRIGHTNESS:
+      self->brightness_ = g_value_get_double(value);
+      break;
+    case PROP_CONTRAST:
+      self->contrast_ = g_value_get_double(value);
+      break;
+    case PROP_SATURATION:
+      self->saturation_ = g_value_get_double(value);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+      GST_OBJECT_UNLOCK(self);
+      return;
+  }
+  UpdateTables(self);
+  bool passthrough = IsIdentity(self->luma_) && IsIdentity(self->chroma_);
+  GST_OBJECT_UNLOCK(self);
+
+  gst_base_transform_set_passthrough(GST_BASE_TRANSFORM(self), passthrough);
+  LOG_DEBUG("lut balance b=%f c=%f s=%f passthrough=%d",
+            self->brightness_, self->contrast_, self->saturation_, passthrough);
+}
+
+static void genivi_lut_balance_get_property(GObject* object, guint prop_id,
+                                            GValue* value, GParamSpec* pspec) {
+  GeniviLutBalance* self = GENIVI_LUT_BALANCE(object);
+  GST_OBJECT_LOCK(self);
+  switch (prop_id) {
+    case PROP_BRIGHTNESS:
+      g_value_set_double(value, self->brightness_);
+      break;
+    case PROP_CONTRAST:
+      g_value_set_double(value, self->contrast_);
+      break;
+    case PROP_SATURATION:
+      g_value_set_double(value, self->saturation_);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+      break;
+  }
+  GST_OBJECT_UNLOCK(self);
+}
+
+static GstFlowReturn genivi_lut_balance_transform_frame_ip(GstVideoFilter* filter, GstVideoFrame* frame) {
+  GeniviLutBalance* self = GENIVI_LUT_BALANCE(filter);
+  Plane luma;
+  Plane chroma;
+  GST_OBJECT_LOCK(self);
+  luma = self->luma_;
+  chroma = self->chroma_;
+  GST_OBJECT_UNLOCK(self);
+
+  guint components = GST_VIDEO_FRAME_N_COMPONENTS(frame);
+  for (guint comp = 0; comp < components; comp++) {
+    guint plane = GST_VIDEO_FRAME_COMP_PLANE(frame, comp);
+    // NV12/NV21 keep U and V in one plane, it is processed once with the first of them
+    if (comp > 0 && plane == GST_VIDEO_FRAME_COMP_PLANE(frame, comp - 1))
+      continue;
+    const Plane& table = (comp == 0) ? luma : chroma;
+    if (IsIdentity(table))
+      continue;
+    ApplyPlane(table, reinterpret_cast<guint8*>(GST_VIDEO_FRAME_PLANE_DATA(frame, plane)),
+               GST_VIDEO_FRAME_PLANE_STRIDE(frame, plane),
+               GST_VIDEO_FRAME_COMP_WIDTH(frame, comp) * GST_VIDEO_FRAME_COMP_PSTRIDE(frame, comp),
+               GST_VIDEO_FRAME_COMP_HEIGHT(frame, comp));
+  }
+  return GST_FLOW_OK;
+}
+
+static void genivi_lut_balance_class_init(GeniviLutBalanceClass* klass) {
+  GObjectClass* gobject_class = G_OBJECT_CLASS(klass);
+  GstElementClass* element_class = GST_ELEMENT_CLASS(klass);
+  GstVideoFilterClass* filter_class = GST_VIDEO_FILTER_CLASS(klass);
+
+  gobject_class->set_property = genivi_lut_balance_set_property;
+  gobject_class->get_property = genivi_lut_balance_get_property;
+  GParamFlags flags = GParamFlags(G_PARAM_READWRITE | GST_PARAM_CONTROLLABLE | G_PARAM_STATIC_STRINGS);
+  g_object_class_install_property(gobject_class, PROP_BRIGHTNESS,
+      g_param_spec_double("brightness", "Brightness", "brightness", -1.0, 1.0, 0.0, flags));
+  g_object_class_install_property(gobject_class, PROP_CONTRAST,
+      g_param_spec_double("contrast", "Contrast", "contrast", 0.0, 2.0, 1.0, flags));
+  g_object_class_install_property(gobject_class, PROP_SATURATION,
+      g_param_spec_double("saturation", "Saturation", "saturation", 0.0, 2.0, 1.0, flags));
+
+  GstCaps* caps = gst_caps_from_string(GST_VIDEO_CAPS_MAKE("{ I420, YV12, NV12, NV21 }"));
+  gst_element_class_add_pad_template(element_class,
+      gst_pad_template_new("sink", GST_PAD_SINK, GST_PAD_ALWAYS, caps));
+  gst_element_class_add_pad_template(element_class,
+      gst_pad_template_new("src", GST_PAD_SRC, GST_PAD_ALWAYS, caps));
+  gst_caps_unref(caps);
+  gst_element_class_set_static_metadata(element_class, "LUT video balance",
+      "Filter/Effect/Video", "Brightness, contrast and saturation with fixed point tables",
+      "LG Electronics");
+
+  filter_class->transform_frame_ip = genivi_lut_balance_transform_frame_ip;
+}
+
+static void genivi_lut_balance_init(GeniviLutBalance* self) {
+  self->brightness_ = 0.0;
+  self->contrast_ = 1.0;
+  self->saturation_ = 1.0;
+  UpdateTables(self);
+  gst_base_transform_set_passthrough(GST_BASE_TRANSFORM(self), TRUE);
+}
+
+GstElement* LutBalance::Create(const gchar* name) {
+  static gsize registered = 0;
+  if (g_once_init_enter(&registered)) {
+    kernel = SelectKernel();
+    gboolean ret = gst_element_register(nullptr, LUT_BALANCE_FACTORY_NAME, GST_RANK_NONE,
+                                        genivi_lut_balance_get_type());
+    if (!ret)
+      LOG_ERROR("Failed to register %s", LUT_BALANCE_FACTORY_NAME);
+    g_once_init_leave(&registered, 1);
+  }
+  return gst_element_factory_make(LUT_BALANCE_FACTORY_NAME, name);
+}
+
+namespace {
+
+// shared by the sink and the src probe, the last one removed logs and frees it
+struct FrameTime {
+  GstBaseTransform* trans_;
+  gchar* name_;
+  volatile gint ref_;
+  GstVideoInfo info_;
+  bool has_info_;
+  gint64 start_;
+  guint64 frames_;
+  gint64 sum_us_;
+};
+
+void ReportFrameTime(FrameTime* timing) {
+  if (timing->frames_ && timing->has_info_)
+    LOG_INFO("%s [%s %dx%d] processed [%llu] frames, average [%lld]us per frame", timing->name_,
+             GST_VIDEO_INFO_NAME(&timing->info_), GST_VIDEO_INFO_WIDTH(&timing->info_),
+             GST_VIDEO_INFO_HEIGHT(&timing->info_), (unsigned long long)timing->frames_,
+             timing->sum_us_ / (gint64)timing->frames_);
+  timing->frames_ = 0;
+  timing->sum_us_ = 0;
+}
+
+void UnrefFrameTime(gpointer data) {
+  FrameTime* timing = reinterpret_cast<FrameTime*>(data);
+  if (!g_atomic_int_dec_and_test(&timing->ref_))
+    return;
+  ReportFrameTime(timing);
+  g_free(timing->name_);
+  delete timing;
+}
+
+GstPadProbeReturn FrameTimeSinkProbe(GstPad* pad, GstPadProbeInfo* info, gpointer data) {
+  FrameTime* timing = reinterpret_cast<FrameTime*>(data);
+  if (GST_PAD_PROBE_INFO_TYPE(info) & GST_PAD_PROBE_TYPE_BUFFER) {
+    // frames in passthrough are not processed by the element
+    timing->start_ = gst_base_transform_is_passthrough(timing->trans_) ? 0 : g_get_monotonic_time();
+    return GST_PAD_PROBE_OK;
+  }
+
+  GstEvent* event = GST_PAD_PROBE_INFO_EVENT(info);
+  if (GST_EVENT_TYPE(event) == GST_EVENT_CAPS) {
+    GstCaps* caps = nullptr;
+    GstVideoInfo video_info;
+    gst_event_parse_caps(event, &caps);
+    if (!gst_video_info_from_caps(&video_info, caps))
+      return GST_PAD_PROBE_OK;
+    // one average per format and size
+    if (!timing->has_info_ || !gst_video_info_is_equal(&video_info, &timing->info_))
+      ReportFrameTime(timing);
+    timing->info_ = video_info;
+    timing->has_info_ = true;
+  } else if (GST_EVENT_TYPE(event) == GST_EVENT_EOS) {
+    ReportFrameTime(timing);
+  }
+  return GST_PAD_PROBE_OK;
+}
+
+// an in-place transform pushes the frame from the same thread right after processing it
+GstPadProbeReturn FrameTimeSrcProbe(GstPad* pad, GstPadProbeInfo* info, gpointer data) {
+  FrameTime* timing = reinterpret_cast<FrameTime*>(data);
+  if (timing->start_) {
+    timing->sum_us_ += g_get_monotonic_time() - timing->start_;
+    timing->frames_++;
+    timing->start_ = 0;
+  }
+  return GST_PAD_PROBE_OK;
+}
+
+}  // namespace
+
+void LutBalance::WatchFrameTime(GstElement* element) {
+  if (!GST_IS_BASE_TRANSFORM(element))
+    return;
+
+  GstPad* sink = gst_element_get_static_pad(element, "sink");
+  GstPad* src = gst_element_get_static_pad(element, "src");
+  if (sink && src) {
+    FrameTime* timing = new FrameTime();
+    timing->trans_ = GST_BASE_TRANSFORM(element);
+    timing->name_ = gst_element_get_name(element);
+    timing->ref_ = 2;
+    timing->has_info_ = false;
+    timing->start_ = 0;
+    timing->frames_ = 0;
+    timing->sum_us_ = 0;
+    gst_pad_add_probe(sink, GstPadProbeType(GST_PAD_PROBE_TYPE_BUFFER | GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM),
+                      FrameTimeSinkProbe, timing, UnrefFrameTime);
+    gst_pad_add_probe(src, GST_PAD_PROBE_TYPE_BUFFER, FrameTimeSrcProbe, timing, UnrefFrameTime);
+  }
+  if (sink)
+    gst_object_unref(sink);
+  if (src)
+    gst_object_unref(src);
+}
+
+}  // namespace genivimedia
@@ -0,0 +1,59 @@
+// @@@LICENSE
+//
+// Copyright (C) 2023, LG Electronics, All Right Reserved.
+//
+// No part of this source code may be communicated, distributed, reproduced
+// or transmitted in any form or by any means, electronic or mechanical or
+// otherwise, for any purpose, without the prior written permission of
+// LG Electronics.
+//
+// LICENSE@@@
+
+#ifndef GENIVIMEDIA_LUT_BALANCE_H
+#define GENIVIMEDIA_LUT_BALANCE_H
+
+#include <glib.h>
+#include <gst/gst.h>
+
+namespace genivimedia {
+
+#define LUT_BALANCE_FACTORY_NAME "genivilutbalance"
+
+/**
+ * @class      genivimedia::LutBalance
+ * @brief      In-place brightness/contrast/saturation filter for planar and semi-planar YUV.
+ * @details    The element has the "brightness", "contrast" and "saturation" properties of videobalance
+ *             with the same ranges and the same formulas, except hue. A property change rebuilds one
+ *             256 entry luma and one chroma table in Q9 fixed point; frames are then processed by an
+ *             SSE2, AVX2 (runtime detected) or NEON kernel evaluating the same fixed point expression,
+ *             16/32 pixels at a time, with the tables used for the tail of each row. At neutral values
+ *             the element is in passthrough and frames are not mapped at all.
+ *             Supported formats are I420, YV12, NV12 and NV21.
+ *             WatchFrameTime() measures this element and the software videobalance of playsink the
+ *             same way, so their logs compare directly for e.g. I420/NV12 at 720p and 1080p.
+ * @see        genivimedia::VideoPipeline::ControlPropertiesTelechips
+ */
+class LutBalance {
+ public:
+  /**
+   * @fn Create
+   * @brief Registers the element on the first call and creates one.
+   * @param[in] name : element name
+   * @return GstElement* (floating) or nullptr
+   */
+  static GstElement* Create(const gchar* name);
+
+  /**
+   * @fn WatchFrameTime
+   * @brief Logs the average time per processed frame of an in-place video filter, from its sink pad
+   *        to its src pad, per format and size. Frames in passthrough are not counted. The average is
+   *        logged on a caps change, on EOS and when the pads are destroyed.
+   * @param[in] element : LUT balance or videobalance
+   * @return None
+   */
+  static void WatchFrameTime(GstElement* element);
+};
+
+}  // namespace genivimedia
+
+#endif  // GENIVIMEDIA_LUT_BALANCE_H
@@ -27,6 +27,7 @@ namespace genivimedia {
 
 class Pipeline;
 class PipelineCreator;
+class ThumbnailBatch;
 
 /**
  * @class      genivimedia::MediaPlayer
@@ -409,6 +410,22 @@ class MediaPlayer : public IPlayer {
    */
   virtual bool SwitchChannel(bool downmix);
 
+  /**
+   * @fn EnqueueNextURI
+   * @brief Queues media content to be played right after the current one without a gap.
+   * @section function_flow Function Flow :
+   * - Returns false if no content is loaded.
+   * - Passes the uri to the Pipeline instance which queues it for playbin's about-to-finish.
+   *
+   * @param[in] uri: uri string of the next media content
+   * @section global_variable_none Global Variables : None
+   * @section dependency Dependencies :
+   * - SetURI()
+   *
+   * @return bool (TRUE - SUCCESS, FALSE - FAIL)
+   */
+  virtual bool EnqueueNextURI(const std::string& uri);
+
   /**
    * @fn SetVideoWindow
    * @brief Sets video window information to change video window size.
@@ -439,6 +456,41 @@ class MediaPlayer : public IPlayer {
 
   virtual int GetChannelInfo(const std::string& uri, const std::string& option);
 
+  /**
+   * @fn GetThreadInfo
+   * @brief Returns the registered streaming threads with their current scheduling settings.
+   * @return std::string (JSON, see ThreadRegistry::GetJson())
+   */
+  virtual std::string GetThreadInfo();
+
+  /**
+   * @fn GetQosInfo
+   * @brief Returns the frame drop, lateness and decode time counters of the current playback.
+   * @return std::string (JSON, see QosMonitor::GetJson())
+   */
+  virtual std::string GetQosInfo();
+
+  /**
+   * @fn ExtractThumbnails
+   * @brief Extracts the thumbnails of a list of files in the background, independent of the current pipeline.
+   * - The given option string shall be JSON format like {"Thumbnails":[{"uri":"file://...","filename":"name"},...]}.<br>
+   * - Each item is reported through the registered callback as it finishes, see ThumbnailBatch.<br>
+   * - A new call cancels the batch still running.<br>
+   *
+   * @param[in] option: list of files in JSON format
+   * @return bool (TRUE - batch started, FALSE - no valid item)
+   */
+  virtual bool ExtractThumbnails(const std::string& option);
+
+  /**
+   * @fn TakeThumbnail
+   * @brief Hands out the thumbnail extracted with {"Option":{"output":"fd"}} once ThumbnailDone is received.
+   * @param[in] uri : uri given to SetURI()
+   * @param[out] size : encoded bytes from offset 0 of the fd
+   * @return int (sealed memfd owned by the caller, -1 if there is no thumbnail for the uri)
+   */
+  virtual int TakeThumbnail(const std::string& uri, gint64* size);
+
   virtual bool QuitPlayerEngine();
 
  protected:
@@ -540,6 +592,7 @@ class MediaPlayer : public IPlayer {
   std::shared_ptr<AudioController> audio_controller_; /**< AudioController instance */
   Timer* start_timer_; /** playback start timer - called after 1 sec for adding fade out when staring playback*/
   std::function <void (const std::string& data)> callback_; /**< Callback function */
+  ThumbnailBatch* thumbnail_batch_; /**< batch thumbnail extraction, created on first use */
 
   bool need_fade_out_;
   bool need_fade_in_;
@@ -0,0 +1,240 @@
+// @@@LICENSE
+//
+// Copyright (C) 2023, LG Electronics, All Right Reserved.
+//
+// No part of this source code may be communicated, distributed, reproduced
+// or transmitted in any form or by any means, electronic or mechanical or
+// otherwise, for any purpose, without the prior written permission of
+// LG Electronics.
+//
+// LICENSE@@@
+
+#include "player/pipeline/playbin_pool.h"
+
+#include "logger/player_logger.h"
+
+namespace genivimedia {
+
+PlaybinPool* PlaybinPool::instance_ = nullptr;
+
+PlaybinPool* PlaybinPool::Instance() {
+  if (instance_ == nullptr) {
+    instance_ = new PlaybinPool();
+  }
+  return instance_;
+}
+
+void PlaybinPool::Destroy() {
+  if (instance_) {
+    delete instance_;
+    instance_ = nullptr;
+  }
+}
+
+PlaybinPool::PlaybinPool()
+  : mutex_(),
+    capacity_(),
+    pool_(),
+    prewarm_source_id_(0),
+    defaults_() {
+}
+
+PlaybinPool::~PlaybinPool() {
+  LOG_INFO("");
+  if (prewarm_source_id_) {
+    g_source_remove(prewarm_source_id_);
+    prewarm_source_id_ = 0;
+  }
+  Clear();
+  for (auto& entry : defaults_)
+    g_value_unset(&entry.second);
+}
+
+void PlaybinPool::SetCapacity(const std::string& name, int capacity) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  capacity_[name] = (capacity > 0) ? capacity : 0;
+  LOG_INFO("playbin pool[%s] capacity=[%d]", name.c_str(), capacity_[name]);
+
+  std::deque<GstElement*>& pool = pool_[name];
+  while ((int)pool.size() > capacity_[name]) {
+    GstElement* playbin = pool.back();
+    pool.pop_back();
+    gst_element_set_state(playbin, GST_STATE_NULL);
+    gst_object_unref(playbin);
+  }
+}
+
+void PlaybinPool::Prewarm() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (prewarm_source_id_ == 0) {
+    // one playbin per idle dispatch, so a pending D-Bus command never waits for the whole pool
+    prewarm_source_id_ = g_idle_add_full(G_PRIORITY_LOW, PrewarmCallbackFunc, this, nullptr);
+  }
+}
+
+GstElement* PlaybinPool::Acquire(const char* name) {
+  if (!name)
+    return nullptr;
+
+  GstElement* playbin = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto iter = pool_.find(name);
+    if (iter == pool_.end() || iter->second.empty()) {
+      LOG_INFO("playbin pool[%s] is empty", name);
+      return nullptr;
+    }
+    playbin = iter->second.front();
+    iter->second.pop_front();
+  }
+
+  GstBus* bus = gst_element_get_bus(playbin);
+  if (bus) {
+    // UnRegisterWatchBus() left the bus flushing when the playbin was released
+    gst_bus_set_flushing(bus, false);
+    gst_object_unref(bus);
+  }
+  LOG_INFO("borrowed warm playbin[%s]", name);
+
+  Prewarm();
+  return playbin;
+}
+
+bool PlaybinPool::CanRelease(GstElement* playbin) {
+  if (!playbin || !GST_IS_ELEMENT(playbin))
+    return false;
+
+  gchar* name = gst_element_get_name(playbin);
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto iter = capacity_.find(name);
+  bool ret = (iter != capacity_.end()) && ((int)pool_[name].size() < iter->second);
+  g_free(name);
+  return ret;
+}
+
+bool PlaybinPool::Release(GstElement* playbin) {
+  if (!CanRelease(playbin))
+    return false;
+
+  // NULL closes the sink devices held by the previous track, READY is where the pool keeps it
+  gst_element_set_state(playbin, GST_STATE_NULL);
+  RestoreDefaults(playbin);
+  if (gst_element_set_state(playbin, GST_STATE_READY) == GST_STATE_CHANGE_FAILURE) {
+    LOG_ERROR("Failed to READY released playbin");
+    return false;
+  }
+
+  gchar* name = gst_element_get_name(playbin);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    pool_[name].push_back(playbin);
+    LOG_INFO("playbin[%s] returned to pool, size=[%u]", name, (guint)pool_[name].size());
+  }
+  g_free(name);
+  return true;
+}
+
+void PlaybinPool::Clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto& entry : pool_) {
+    for (GstElement* playbin : entry.second) {
+      gst_element_set_state(playbin, GST_STATE_NULL);
+      gst_object_unref(playbin);
+    }
+    entry.second.clear();
+  }
+}
+
+gboolean PlaybinPool::PrewarmCallbackFunc(gpointer data) {
+  PlaybinPool* pool = reinterpret_cast<PlaybinPool*>(data);
+  if (pool->PrewarmOne())
+    return G_SOURCE_CONTINUE;
+
+  std::lock_guard<std::mutex> lock(pool->mutex_);
+  pool->prewarm_source_id_ = 0;
+  return G_SOURCE_REMOVE;
+}
+
+bool PlaybinPool::PrewarmOne() {
+  std::string name;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& entry : capacity_) {
+      if ((int)pool_[entry.first].size() < entry.second) {
+        name = entry.first;
+        break;
+      }
+    }
+  }
+  if (name.empty())
+    return false;
+
+  GstElement* playbin = CreatePlaybin(name);
+  if (!playbin)
+    return false;
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  pool_[name].push_back(playbin);
+  return true;
+}
+
+GstElement* PlaybinPool::CreatePlaybin(const std::string& name) {
+  GstElement* playbin = gst_element_factory_make("playbin", name.c_str());
+  if (!playbin) {
+    LOG_ERROR("Failed to create playbin[%s]", name.c_str());
+    return nullptr;
+  }
+  gst_object_ref_sink(playbin);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    CaptureDefaultsLocked(playbin);
+  }
+
+  if (gst_element_set_state(playbin, GST_STATE_READY) == GST_STATE_CHANGE_FAILURE) {
+    LOG_ERROR("Failed to READY playbin[%s]", name.c_str());
+    gst_element_set_state(playbin, GST_STATE_NULL);
+    gst_object_unref(playbin);
+    return nullptr;
+  }
+  LOG_INFO("pre-warmed playbin[%s]", name.c_str());
+  return playbin;
+}
+
+void PlaybinPool::CaptureDefaultsLocked(GstElement* playbin) {
+  if (!defaults_.empty())
+    return;
+
+  guint count = 0;
+  GParamSpec** specs = g_object_class_list_properties(G_OBJECT_GET_CLASS(playbin), &count);
+  for (guint i = 0; i < count; i++) {
+    GParamSpec* spec = specs[i];
+    // name and parent belong to the element, not to the session
+    if ((spec->flags & (G_PARAM_READABLE | G_PARAM_WRITABLE)) != (G_PARAM_READABLE | G_PARAM_WRITABLE) ||
+        (spec->flags & G_PARAM_CONSTRUCT_ONLY) ||
+        g_str_equal(spec->name, "name") || g_str_equal(spec->name, "parent"))
+      continue;
+    GValue value = G_VALUE_INIT;
+    g_value_init(&value, spec->value_type);
+    g_object_get_property(G_OBJECT(playbin), spec->name, &value);
+    defaults_.emplace_back(spec->name, value);
+  }
+  g_free(specs);
+  LOG_INFO("captured [%u] playbin defaults", (guint)defaults_.size());
+}
+
+void PlaybinPool::RestoreDefaults(GstElement* playbin) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (defaults_.empty()) {
+    // released before the pool built one of its own, take the values from a fresh instance
+    GstElement* fresh = gst_element_factory_make("playbin", nullptr);
+    if (!fresh)
+      return;
+    gst_object_ref_sink(fresh);
+    CaptureDefaultsLocked(fresh);
+    gst_object_unref(fresh);
+  }
+  for (auto& entry : defaults_)
+    g_object_set_property(G_OBJECT(playbin), entry.first.c_str(), &entry.second);
+}
+
+}  // namespace genivimedia
@@ -0,0 +1,108 @@
+// @@@LICENSE
+//
+// Copyright (C) 2023, LG Electronics, All Right Reserved.
+//
+// No part of this source code may be communicated, distributed, reproduced
+// or transmitted in any form or by any means, electronic or mechanical or
+// otherwise, for any purpose, without the prior written permission of
+// LG Electronics.
+//
+// LICENSE@@@
+
+#ifndef GENIVIMEDIA_PLAYBIN_POOL_H
+#define GENIVIMEDIA_PLAYBIN_POOL_H
+
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <glib.h>
+#include <gst/gst.h>
+
+namespace genivimedia {
+
+/**
+ * @class      genivimedia::PlaybinPool
+ * @brief      Keeps pre-built playbin instances in READY state so that a load does not pay for construction.
+ * @details    Pools are keyed by playbin name ("video_pipeline", "audio_pipeline", ...).
+ *             <ul>
+ *                 <li>SetCapacity() sizes a pool, Prewarm() fills it on the default main context idle.
+ *                 <li>Acquire() hands out a warm playbin, Release() takes one back after it reached READY.
+ *                 <li>A pool with capacity 0 is disabled and all calls fall back to the caller's own path.
+ *                 <li>Release() restores every writable property to the value a new playbin has, so nothing
+ *                     a session set (flags, volume, mute, sinks, offsets, selected streams) reaches the next one.
+ *             </ul>
+ * @see        genivimedia::GstMedia
+ */
+class PlaybinPool {
+ public:
+  static PlaybinPool* Instance();
+  static void Destroy();
+
+  /**
+   * @fn SetCapacity
+   * @brief Sets how many spare playbins are kept for the given playbin name.
+   * @param[in] name : playbin name used by CreateGstPlaybin()
+   * @param[in] capacity : number of warm instances, 0 disables pooling
+   * @return None
+   */
+  void SetCapacity(const std::string& name, int capacity);
+
+  /**
+   * @fn Prewarm
+   * @brief Schedules creation of missing playbins on the main loop idle.
+   * @return None
+   */
+  void Prewarm();
+
+  /**
+   * @fn Acquire
+   * @brief Takes a warm playbin out of the pool.
+   * @param[in] name : playbin name
+   * @return GstElement* (owned by caller) or nullptr if the pool is empty or disabled
+   */
+  GstElement* Acquire(const char* name);
+
+  /**
+   * @fn CanRelease
+   * @brief Checks whether the given playbin would be accepted by Release().
+   * @param[in] playbin : playbin element
+   * @return bool (TRUE - poolable, FALSE - caller shall destroy it)
+   */
+  bool CanRelease(GstElement* playbin);
+
+  /**
+   * @fn Release
+   * @brief Gives a playbin back to its pool. Ownership is transferred only on success.
+   * @param[in] playbin : playbin element, already in READY state
+   * @return bool (TRUE - taken by pool, FALSE - caller keeps ownership)
+   */
+  bool Release(GstElement* playbin);
+
+  void Clear();
+
+ private:
+  PlaybinPool();
+  ~PlaybinPool();
+
+  static gboolean PrewarmCallbackFunc(gpointer data);
+  bool PrewarmOne();
+  GstElement* CreatePlaybin(const std::string& name);
+  void CaptureDefaultsLocked(GstElement* playbin);
+  void RestoreDefaults(GstElement* playbin);
+
+  static PlaybinPool* instance_;
+
+  std::mutex mutex_;
+  std::map<std::string, int> capacity_;
+  std::map<std::string, std::deque<GstElement*>> pool_;
+  guint prewarm_source_id_;
+  std::vector<std::pair<std::string, GValue>> defaults_;  /**< writable properties of a new playbin */
+};
+
+}  // namespace genivimedia
+
+#endif  // GENIVIMEDIA_PLAYBIN_POOL_H
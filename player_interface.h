@@ -342,6 +342,23 @@ class IPlayer {
    */
   virtual bool SwitchChannel(bool downmix) = 0;
 
+  /**
+   * @fn EnqueueNextURI
+   * @brief Queues media content to be played right after the current one without a gap.
+   * - The next uri is handed to the pipeline when the current content is about to finish,
+   *   so that it is demuxed and decoded while the current one drains. The sinks are kept open.<br>
+   * - Only contents of the same media type as the current one can be queued.<br>
+   *
+   * @section function_flow_none Function Flow : None
+   * @param[in] uri: uri string of the next media content
+   * @section global_variable_none Global Variables : None
+   * @section dependency Dependencies :
+   * - SetURI()
+   *
+   * @return bool (TRUE - SUCCESS, FALSE - FAIL, use SetURI() instead)
+   */
+  virtual bool EnqueueNextURI(const std::string& uri) = 0;
+
   /**
    * @fn SetVideoWindow
    * @brief Sets video window information to change video window size.
@@ -367,6 +384,14 @@ class IPlayer {
 
   virtual int GetChannelInfo(const std::string& uri, const std::string& option) = 0;
 
+  virtual std::string GetThreadInfo() = 0;
+
+  virtual std::string GetQosInfo() = 0;
+
+  virtual bool ExtractThumbnails(const std::string& option) = 0;
+
+  virtual int TakeThumbnail(const std::string& uri, gint64* size) = 0;
+
  protected:
   /**
    * @fn IPlayer
@@ -0,0 +1,128 @@
+// @@@LICENSE
+//
+// Copyright (C) 2023, LG Electronics, All Right Reserved.
+//
+// No part of this source code may be communicated, distributed, reproduced
+// or transmitted in any form or by any means, electronic or mechanical or
+// otherwise, for any purpose, without the prior written permission of
+// LG Electronics.
+//
+// LICENSE@@@
+
+#include "player/pipeline/position_clock.h"
+
+#include "logger/player_logger.h"
+
+namespace genivimedia {
+
+PositionClock::PositionClock()
+  : mutex_(),
+    valid_(false),
+    reason_("init"),
+    clock_(nullptr),
+    base_time_(GST_CLOCK_TIME_NONE),
+    anchor_running_(0),
+    anchor_position_(0),
+    anchor_time_us_(0),
+    rate_(1.0),
+    ticks_(0),
+    queries_(0),
+    tick_sum_us_(0) {
+}
+
+PositionClock::~PositionClock() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  ReleaseClockLocked();
+}
+
+bool PositionClock::Get(GstElement* pipeline, gint64* position) {
+  if (!pipeline || !position)
+    return false;
+
+  gint64 start_us = g_get_monotonic_time();
+  std::lock_guard<std::mutex> lock(mutex_);
+  bool ret = false;
+
+  if (valid_ && (start_us - anchor_time_us_) < kResyncIntervalUs) {
+    GstClockTime now = gst_clock_get_time(clock_);
+    GstClockTimeDiff elapsed = GST_CLOCK_DIFF(base_time_, now) - anchor_running_;
+    *position = anchor_position_ + (gint64)(elapsed * rate_);
+    if (*position < 0)
+      *position = 0;
+    ret = true;
+  } else {
+    ret = AnchorLocked(pipeline, position);
+  }
+
+  ticks_++;
+  tick_sum_us_ += g_get_monotonic_time() - start_us;
+  return ret;
+}
+
+void PositionClock::Invalidate(const char* reason) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (valid_)
+    reason_ = reason;
+  valid_ = false;
+}
+
+void PositionClock::Reset() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (ticks_) {
+    LOG_INFO("position ticks=[%u] pipeline queries=[%u] avg tick=[%lld]us",
+             ticks_, queries_, tick_sum_us_ / ticks_);
+  }
+  valid_ = false;
+  reason_ = "reset";
+  ReleaseClockLocked();
+  ticks_ = 0;
+  queries_ = 0;
+  tick_sum_us_ = 0;
+}
+
+bool PositionClock::AnchorLocked(GstElement* pipeline, gint64* position) {
+  queries_++;
+  valid_ = false;
+  if (!gst_element_query_position(pipeline, GST_FORMAT_TIME, position))
+    return false;
+
+  GstState state = GST_STATE_NULL;
+  GstState pending = GST_STATE_VOID_PENDING;
+  // base time is only meaningful while PLAYING, otherwise answer from the query only
+  if (gst_element_get_state(pipeline, &state, &pending, 0) == GST_STATE_CHANGE_FAILURE ||
+      state != GST_STATE_PLAYING || pending != GST_STATE_VOID_PENDING)
+    return true;
+
+  GstClock* clock = gst_element_get_clock(pipeline);
+  if (!clock)
+    return true;
+  ReleaseClockLocked();
+  clock_ = clock;
+
+  gdouble rate = 1.0;
+  GstQuery* query = gst_query_new_segment(GST_FORMAT_TIME);
+  if (gst_element_query(pipeline, query))
+    gst_query_parse_segment(query, &rate, nullptr, nullptr, nullptr);
+  gst_query_unref(query);
+
+  base_time_ = gst_element_get_base_time(pipeline);
+  anchor_running_ = GST_CLOCK_DIFF(base_time_, gst_clock_get_time(clock_));
+  anchor_position_ = *position;
+  anchor_time_us_ = g_get_monotonic_time();
+  rate_ = rate;
+  valid_ = true;
+
+  LOG_INFO("position anchored at [%f]sec rate=[%lf] after [%s]",
+           (float)anchor_position_ / GST_SECOND, rate_, reason_);
+  reason_ = "resync";
+  return true;
+}
+
+void PositionClock::ReleaseClockLocked() {
+  if (clock_) {
+    gst_object_unref(clock_);
+    clock_ = nullptr;
+  }
+}
+
+}  // namespace genivimedia
@@ -0,0 +1,85 @@
+// @@@LICENSE
+//
+// Copyright (C) 2023, LG Electronics, All Right Reserved.
+//
+// No part of this source code may be communicated, distributed, reproduced
+// or transmitted in any form or by any means, electronic or mechanical or
+// otherwise, for any purpose, without the prior written permission of
+// LG Electronics.
+//
+// LICENSE@@@
+
+#ifndef GENIVIMEDIA_POSITION_CLOCK_H
+#define GENIVIMEDIA_POSITION_CLOCK_H
+
+#include <mutex>
+
+#include <glib.h>
+#include <gst/gst.h>
+
+namespace genivimedia {
+
+/**
+ * @class      genivimedia::PositionClock
+ * @brief      Extrapolates the playback position from the pipeline clock.
+ * @details    The first Get() after a discontinuity queries the position and the segment rate once
+ *             and records them with the running-time (clock time - base time) of that moment. The
+ *             following calls compute position = anchor position + (running-time - anchor running-time)
+ *             * rate without touching the pipeline. Invalidate() shall be called on seeks, rate and
+ *             state changes, new clock and stream start. The anchor is also renewed every
+ *             kResyncIntervalUs so that a stalled sink can not drift the reported position for long.
+ * @see        genivimedia::GstMedia::GetExtrapolatedPosition
+ */
+class PositionClock {
+ public:
+  PositionClock();
+  ~PositionClock();
+
+  /**
+   * @fn Get
+   * @brief Returns the current position in nano-seconds.
+   * @param[in] pipeline : pipeline to query when there is no valid anchor
+   * @param[out] position : position in nano-seconds
+   * @return bool (TRUE - SUCCESS, FALSE - FAIL)
+   */
+  bool Get(GstElement* pipeline, gint64* position);
+
+  /**
+   * @fn Invalidate
+   * @brief Drops the anchor, the next Get() queries the pipeline again.
+   * @param[in] reason : logged with the next anchor
+   * @return None
+   */
+  void Invalidate(const char* reason);
+
+  /**
+   * @fn Reset
+   * @brief Drops the anchor and the clock, and logs the tick/query counters.
+   * @return None
+   */
+  void Reset();
+
+ private:
+  static const gint64 kResyncIntervalUs = 10 * G_USEC_PER_SEC;
+
+  bool AnchorLocked(GstElement* pipeline, gint64* position);
+  void ReleaseClockLocked();
+
+  std::mutex mutex_;
+  bool valid_;
+  const char* reason_;
+  GstClock* clock_;
+  GstClockTime base_time_;
+  GstClockTimeDiff anchor_running_;
+  gint64 anchor_position_;
+  gint64 anchor_time_us_;
+  gdouble rate_;
+
+  guint ticks_;
+  guint queries_;
+  gint64 tick_sum_us_;
+};
+
+}  // namespace genivimedia
+
+#endif  // GENIVIMEDIA_POSITION_CLOCK_H
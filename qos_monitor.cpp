@@ -0,0 +1,265 @@
+// @@@LICENSE
+//
+// Copyright (C) 2023, LG Electronics, All Right Reserved.
+//
+// No part of this source code may be communicated, distributed, reproduced
+// or transmitted in any form or by any means, electronic or mechanical or
+// otherwise, for any purpose, without the prior written permission of
+// LG Electronics.
+//
+// LICENSE@@@
+
+#include "player/pipeline/qos_monitor.h"
+
+#include <boost/property_tree/json_parser.hpp>
+#include <boost/property_tree/ptree.hpp>
+
+#include <string.h>
+
+#include <sstream>
+
+#include "logger/player_logger.h"
+
+namespace pt = boost::property_tree;
+
+namespace genivimedia {
+
+namespace {
+
+// last cumulative "dropped" of a QoS source, QoS stats are counted per element
+GQuark DroppedQuark() {
+  static GQuark quark = g_quark_from_static_string("genivimedia-qos-dropped");
+  return quark;
+}
+
+bool IsVideoElement(GstObject* object) {
+  if (!GST_IS_ELEMENT(object))
+    return false;
+  GstElementFactory* factory = gst_element_get_factory(GST_ELEMENT(object));
+  if (!factory)
+    return false;
+  const gchar* klass = gst_element_factory_get_metadata(factory, GST_ELEMENT_METADATA_KLASS);
+  return klass && strstr(klass, "Video");
+}
+
+}  // namespace
+
+QosMonitor::QosMonitor()
+  : mutex_(),
+    decoder_(nullptr),
+    sink_probe_id_(0),
+    src_probe_id_(0),
+    video_sink_(nullptr),
+    ring_(),
+    ring_pos_(0),
+    qos_messages_(0),
+    dropped_(0),
+    late_count_(0),
+    lateness_sum_us_(0),
+    lateness_max_us_(0),
+    decoded_(0),
+    decode_timed_(0),
+    decode_sum_us_(0),
+    decode_max_us_(0) {
+  for (PtsEntry& entry : ring_)
+    entry.pts_ = GST_CLOCK_TIME_NONE;
+}
+
+QosMonitor::~QosMonitor() {
+  Reset();
+}
+
+void QosMonitor::HandleSyncMessage(GstMessage* message) {
+  if (GST_MESSAGE_TYPE(message) != GST_MESSAGE_QOS || !IsVideoElement(GST_MESSAGE_SRC(message)))
+    return;
+
+  gint64 jitter = 0;
+  GstFormat format = GST_FORMAT_UNDEFINED;
+  guint64 processed = 0;
+  guint64 dropped = 0;
+  gst_message_parse_qos_values(message, &jitter, nullptr, nullptr);
+  gst_message_parse_qos_stats(message, &format, &processed, &dropped);
+
+  GObject* source = G_OBJECT(GST_MESSAGE_SRC(message));
+  std::lock_guard<std::mutex> lock(mutex_);
+  qos_messages_++;
+  if (jitter > 0) {
+    gint64 lateness_us = jitter / GST_USECOND;
+    late_count_++;
+    lateness_sum_us_ += lateness_us;
+    if (lateness_us > lateness_max_us_)
+      lateness_max_us_ = lateness_us;
+  }
+
+  if (format == GST_FORMAT_BUFFERS && dropped != (guint64)-1) {
+    guint64 last = GPOINTER_TO_SIZE(g_object_get_qdata(source, DroppedQuark()));
+    // the element restarts its counters on READY->PAUSED
+    dropped_ += (dropped >= last) ? dropped - last : dropped;
+    g_object_set_qdata(source, DroppedQuark(), GSIZE_TO_POINTER((gsize)dropped));
+  }
+}
+
+void QosMonitor::AttachDecoder(GstElement* decoder) {
+  if (!decoder)
+    return;
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (decoder_ == decoder)
+    return;
+  RemoveProbesLocked();
+
+  GstPad* sink = gst_element_get_static_pad(decoder, "sink");
+  GstPad* src = gst_element_get_static_pad(decoder, "src");
+  if (sink && src) {
+    decoder_ = GST_ELEMENT(gst_object_ref(decoder));
+    sink_probe_id_ = gst_pad_add_probe(sink, GST_PAD_PROBE_TYPE_BUFFER, DecoderSinkProbe, this, nullptr);
+    src_probe_id_ = gst_pad_add_probe(src, GST_PAD_PROBE_TYPE_BUFFER, DecoderSrcProbe, this, nullptr);
+    LOG_INFO("qos monitor attached to [%s]", GST_ELEMENT_NAME(decoder));
+  }
+  if (sink)
+    gst_object_unref(sink);
+  if (src)
+    gst_object_unref(src);
+}
+
+void QosMonitor::SetVideoSink(GstElement* sink) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (video_sink_ == sink)
+    return;
+  if (video_sink_)
+    gst_object_unref(video_sink_);
+  video_sink_ = sink ? GST_ELEMENT(gst_object_ref(sink)) : nullptr;
+}
+
+std::string QosMonitor::GetJson() {
+  guint64 rendered = 0;
+  guint64 sink_dropped = 0;
+  bool has_stats = false;
+  GstElement* sink = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (video_sink_)
+      sink = GST_ELEMENT(gst_object_ref(video_sink_));
+  }
+  if (sink) {
+    GstStructure* stats = nullptr;
+    if (g_object_class_find_property(G_OBJECT_GET_CLASS(sink), "stats"))
+      g_object_get(G_OBJECT(sink), "stats", &stats, nullptr);
+    if (stats) {
+      has_stats = gst_structure_get_uint64(stats, "rendered", &rendered) &&
+                  gst_structure_get_uint64(stats, "dropped", &sink_dropped);
+      gst_structure_free(stats);
+    }
+    gst_object_unref(sink);
+  }
+
+  pt::ptree qos;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    guint64 dropped = dropped_;
+    if (!has_stats)
+      rendered = (decoded_ > dropped) ? decoded_ - dropped : 0;
+    else if (sink_dropped > dropped)
+      dropped = sink_dropped;
+
+    qos.put("rendered", rendered);
+    qos.put("dropped", dropped);
+    qos.put("lateness_avg_us", late_count_ ? lateness_sum_us_ / (gint64)late_count_ : 0);
+    qos.put("lateness_max_us", lateness_max_us_);
+    qos.put("decoded", decoded_);
+    qos.put("decode_avg_us", decode_timed_ ? decode_sum_us_ / (gint64)decode_timed_ : 0);
+    qos.put("decode_max_us", decode_max_us_);
+    qos.put("qos_messages", qos_messages_);
+  }
+
+  pt::ptree tree;
+  tree.add_child("Qos", qos);
+  std::stringstream ss;
+  pt::write_json(ss, tree, false);
+  return ss.str();
+}
+
+void QosMonitor::Reset() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  RemoveProbesLocked();
+  if (video_sink_) {
+    gst_object_unref(video_sink_);
+    video_sink_ = nullptr;
+  }
+  ring_pos_ = 0;
+  for (PtsEntry& entry : ring_) {
+    entry.pts_ = GST_CLOCK_TIME_NONE;
+    entry.enter_us_ = 0;
+  }
+  qos_messages_ = 0;
+  dropped_ = 0;
+  late_count_ = 0;
+  lateness_sum_us_ = 0;
+  lateness_max_us_ = 0;
+  decoded_ = 0;
+  decode_timed_ = 0;
+  decode_sum_us_ = 0;
+  decode_max_us_ = 0;
+}
+
+GstPadProbeReturn QosMonitor::DecoderSinkProbe(GstPad* pad, GstPadProbeInfo* info, gpointer data) {
+  QosMonitor* monitor = reinterpret_cast<QosMonitor*>(data);
+  GstBuffer* buffer = GST_PAD_PROBE_INFO_BUFFER(info);
+  if (!buffer || !GST_BUFFER_PTS_IS_VALID(buffer))
+    return GST_PAD_PROBE_OK;
+
+  std::lock_guard<std::mutex> lock(monitor->mutex_);
+  PtsEntry& entry = monitor->ring_[monitor->ring_pos_];
+  entry.pts_ = GST_BUFFER_PTS(buffer);
+  entry.enter_us_ = g_get_monotonic_time();
+  monitor->ring_pos_ = (monitor->ring_pos_ + 1) % kPtsRingSize;
+  return GST_PAD_PROBE_OK;
+}
+
+GstPadProbeReturn QosMonitor::DecoderSrcProbe(GstPad* pad, GstPadProbeInfo* info, gpointer data) {
+  QosMonitor* monitor = reinterpret_cast<QosMonitor*>(data);
+  GstBuffer* buffer = GST_PAD_PROBE_INFO_BUFFER(info);
+  if (!buffer)
+    return GST_PAD_PROBE_OK;
+
+  std::lock_guard<std::mutex> lock(monitor->mutex_);
+  monitor->decoded_++;
+  if (!GST_BUFFER_PTS_IS_VALID(buffer))
+    return GST_PAD_PROBE_OK;
+
+  // frames leave in presentation order, so the matching input is searched by PTS
+  for (PtsEntry& entry : monitor->ring_) {
+    if (entry.pts_ != GST_BUFFER_PTS(buffer))
+      continue;
+    gint64 decode_us = g_get_monotonic_time() - entry.enter_us_;
+    monitor->decode_timed_++;
+    monitor->decode_sum_us_ += decode_us;
+    if (decode_us > monitor->decode_max_us_)
+      monitor->decode_max_us_ = decode_us;
+    entry.pts_ = GST_CLOCK_TIME_NONE;
+    break;
+  }
+  return GST_PAD_PROBE_OK;
+}
+
+void QosMonitor::RemoveProbesLocked() {
+  if (!decoder_)
+    return;
+
+  GstPad* sink = gst_element_get_static_pad(decoder_, "sink");
+  GstPad* src = gst_element_get_static_pad(decoder_, "src");
+  if (sink) {
+    gst_pad_remove_probe(sink, sink_probe_id_);
+    gst_object_unref(sink);
+  }
+  if (src) {
+    gst_pad_remove_probe(src, src_probe_id_);
+    gst_object_unref(src);
+  }
+  sink_probe_id_ = 0;
+  src_probe_id_ = 0;
+  gst_object_unref(decoder_);
+  decoder_ = nullptr;
+}
+
+}  // namespace genivimedia
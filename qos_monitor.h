@@ -0,0 +1,96 @@
+// @@@LICENSE
+//
+// Copyright (C) 2023, LG Electronics, All Right Reserved.
+//
+// No part of this source code may be communicated, distributed, reproduced
+// or transmitted in any form or by any means, electronic or mechanical or
+// otherwise, for any purpose, without the prior written permission of
+// LG Electronics.
+//
+// LICENSE@@@
+
+#ifndef GENIVIMEDIA_QOS_MONITOR_H
+#define GENIVIMEDIA_QOS_MONITOR_H
+
+#include <mutex>
+#include <string>
+
+#include <glib.h>
+#include <gst/gst.h>
+
+namespace genivimedia {
+
+/**
+ * @class      genivimedia::QosMonitor
+ * @brief      Per-session QoS and frame timing counters of a playback pipeline.
+ * @details    HandleSyncMessage() is called from the bus sync handler, so QoS messages are counted even
+ *             when the bus thread filters them out. Lateness comes from the QoS jitter, dropped frames
+ *             from the QoS stats of the video sink. AttachDecoder() adds two buffer probes to the video
+ *             decoder which remember the input time per PTS in a small ring and measure the time until
+ *             the frame with that PTS leaves the decoder. Rendered frames are read from the "stats"
+ *             property of the video sink only when GetJson() is called.
+ *             Every counter is updated in O(1) on the posting/streaming thread.
+ * @see        genivimedia::GstMedia::GetQosJson
+ */
+class QosMonitor {
+ public:
+  QosMonitor();
+  ~QosMonitor();
+
+  void HandleSyncMessage(GstMessage* message);
+
+  /**
+   * @fn AttachDecoder
+   * @brief Measures the decode time of the video decoder.
+   * @param[in] decoder : video decoder element
+   * @return None
+   */
+  void AttachDecoder(GstElement* decoder);
+
+  void SetVideoSink(GstElement* sink);
+
+  /**
+   * @fn GetJson
+   * @brief Returns the session counters like
+   *        {"Qos":{"rendered":N,"dropped":N,"lateness_avg_us":N,"lateness_max_us":N,
+   *        "decoded":N,"decode_avg_us":N,"decode_max_us":N,"qos_messages":N}}
+   */
+  std::string GetJson();
+
+  void Reset();
+
+ private:
+  static const guint kPtsRingSize = 32;
+
+  struct PtsEntry {
+    GstClockTime pts_;
+    gint64 enter_us_;
+  };
+
+  static GstPadProbeReturn DecoderSinkProbe(GstPad* pad, GstPadProbeInfo* info, gpointer data);
+  static GstPadProbeReturn DecoderSrcProbe(GstPad* pad, GstPadProbeInfo* info, gpointer data);
+  void RemoveProbesLocked();
+
+  std::mutex mutex_;
+  GstElement* decoder_;
+  gulong sink_probe_id_;
+  gulong src_probe_id_;
+  GstElement* video_sink_;
+
+  PtsEntry ring_[kPtsRingSize];
+  guint ring_pos_;
+
+  guint64 qos_messages_;
+  guint64 dropped_;
+  guint64 late_count_;
+  gint64 lateness_sum_us_;
+  gint64 lateness_max_us_;
+  guint64 decoded_;
+  guint64 decode_timed_;  /**< decoded frames whose input PTS was still in the ring */
+  gint64 decode_sum_us_;
+  gint64 decode_max_us_;
+};
+
+}  // namespace genivimedia
+
+#endif  // GENIVIMEDIA_QOS_MONITOR_H
@@ -0,0 +1,155 @@
+// @@@LICENSE
+//
+// Copyright (C) 2023, LG Electronics, All Right Reserved.
+//
+// No part of this source code may be communicated, distributed, reproduced
+// or transmitted in any form or by any means, electronic or mechanical or
+// otherwise, for any purpose, without the prior written permission of
+// LG Electronics.
+//
+// LICENSE@@@
+
+#include "player/pipeline/resolution_probe.h"
+
+#include "logger/player_logger.h"
+
+namespace genivimedia {
+
+ResolutionProbe::ResolutionProbe(ResolutionCallback callback)
+  : callback_(callback),
+    mutex_(),
+    pad_(nullptr),
+    probe_id_(0),
+    debounce_source_id_(0),
+    width_(0),
+    height_(0),
+    pending_width_(0),
+    pending_height_(0),
+    pending_time_us_(0),
+    last_change_us_(0) {
+}
+
+ResolutionProbe::~ResolutionProbe() {
+  Detach();
+}
+
+bool ResolutionProbe::Attach(GstElement* sink) {
+  if (!sink)
+    return false;
+
+  Detach();
+  GstPad* pad = gst_element_get_static_pad(sink, "sink");
+  if (!pad) {
+    LOG_ERROR("video sink has no sink pad");
+    return false;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  pad_ = pad;
+  probe_id_ = gst_pad_add_probe(pad_, GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM, CapsProbe, this, nullptr);
+  return probe_id_ != 0;
+}
+
+void ResolutionProbe::Detach() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (pad_) {
+    if (probe_id_)
+      gst_pad_remove_probe(pad_, probe_id_);
+    gst_object_unref(pad_);
+    pad_ = nullptr;
+  }
+  probe_id_ = 0;
+  if (debounce_source_id_) {
+    g_source_remove(debounce_source_id_);
+    debounce_source_id_ = 0;
+  }
+  width_ = 0;
+  height_ = 0;
+  pending_width_ = 0;
+  pending_height_ = 0;
+  pending_time_us_ = 0;
+  last_change_us_ = 0;
+}
+
+bool ResolutionProbe::GetResolution(gint* width, gint* height) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!width_ || !height_)
+    return false;
+  *width = width_;
+  *height = height_;
+  return true;
+}
+
+GstPadProbeReturn ResolutionProbe::CapsProbe(GstPad* pad, GstPadProbeInfo* info, gpointer data) {
+  GstEvent* event = GST_PAD_PROBE_INFO_EVENT(info);
+  if (!event || GST_EVENT_TYPE(event) != GST_EVENT_CAPS)
+    return GST_PAD_PROBE_OK;
+
+  GstCaps* caps = nullptr;
+  gst_event_parse_caps(event, &caps);
+  gint width = 0;
+  gint height = 0;
+  if (!caps || gst_caps_is_empty(caps))
+    return GST_PAD_PROBE_OK;
+  GstStructure* structure = gst_caps_get_structure(caps, 0);
+  if (!gst_structure_get_int(structure, "width", &width) ||
+      !gst_structure_get_int(structure, "height", &height))
+    return GST_PAD_PROBE_OK;
+
+  ResolutionProbe* probe = reinterpret_cast<ResolutionProbe*>(data);
+  std::lock_guard<std::mutex> lock(probe->mutex_);
+  if (!probe->width_ || !probe->height_) {
+    probe->width_ = width;
+    probe->height_ = height;
+    LOG_INFO("initial video resolution %dx%d", width, height);
+    return GST_PAD_PROBE_OK;
+  }
+
+  bool pending = (probe->pending_width_ || probe->pending_height_);
+  if (pending && width == probe->pending_width_ && height == probe->pending_height_)
+    return GST_PAD_PROBE_OK;
+
+  probe->last_change_us_ = g_get_monotonic_time();
+  if (width == probe->width_ && height == probe->height_) {
+    // switched back before the debounce expired, nothing to report
+    probe->pending_width_ = 0;
+    probe->pending_height_ = 0;
+    return GST_PAD_PROBE_OK;
+  }
+  probe->pending_width_ = width;
+  probe->pending_height_ = height;
+  probe->pending_time_us_ = probe->last_change_us_;
+  if (probe->debounce_source_id_ == 0)
+    probe->debounce_source_id_ = g_timeout_add(kDebounceMs, DebounceCallbackFunc, probe);
+  LOG_DEBUG("video resolution %dx%d pending", width, height);
+  return GST_PAD_PROBE_OK;
+}
+
+gboolean ResolutionProbe::DebounceCallbackFunc(gpointer data) {
+  ResolutionProbe* probe = reinterpret_cast<ResolutionProbe*>(data);
+  gint width = 0;
+  gint height = 0;
+  gint64 detected_us = 0;
+  {
+    std::lock_guard<std::mutex> lock(probe->mutex_);
+    if (probe->pending_width_ &&
+        (g_get_monotonic_time() - probe->last_change_us_) < (gint64)kDebounceMs * 1000) {
+      // still renegotiating, check again later
+      return G_SOURCE_CONTINUE;
+    }
+    probe->debounce_source_id_ = 0;
+    if (!probe->pending_width_)
+      return G_SOURCE_REMOVE;
+    width = probe->width_ = probe->pending_width_;
+    height = probe->height_ = probe->pending_height_;
+    detected_us = probe->pending_time_us_;
+    probe->pending_width_ = 0;
+    probe->pending_height_ = 0;
+  }
+  LOG_INFO("video resolution changed to %dx%d", width, height);
+  if (probe->callback_)
+    probe->callback_(width, height, detected_us);
+  return G_SOURCE_REMOVE;
+}
+
+}  // namespace genivimedia
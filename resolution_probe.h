@@ -0,0 +1,82 @@
+// @@@LICENSE
+//
+// Copyright (C) 2023, LG Electronics, All Right Reserved.
+//
+// No part of this source code may be communicated, distributed, reproduced
+// or transmitted in any form or by any means, electronic or mechanical or
+// otherwise, for any purpose, without the prior written permission of
+// LG Electronics.
+//
+// LICENSE@@@
+
+#ifndef GENIVIMEDIA_RESOLUTION_PROBE_H
+#define GENIVIMEDIA_RESOLUTION_PROBE_H
+
+#include <functional>
+#include <mutex>
+
+#include <glib.h>
+#include <gst/gst.h>
+
+namespace genivimedia {
+
+/**
+ * @param width, height : new resolution
+ * @param detected_us : g_get_monotonic_time() of the first caps event with this resolution
+ */
+typedef std::function<void(gint width, gint height, gint64 detected_us)> ResolutionCallback;
+
+/**
+ * @class      genivimedia::ResolutionProbe
+ * @brief      Detects width/height changes on the video sink pad.
+ * @details    The probe only sees downstream events and returns early for anything but CAPS, so buffers
+ *             do not pass through it. The first caps of a session set the initial resolution silently.
+ *             A different resolution is kept as pending and reported from the main context once no other
+ *             change arrived for kDebounceMs, so an adaptive stream switching back and forth, or a decoder
+ *             renegotiating several times at start, only reports the settled one.
+ * @see        genivimedia::VideoPipeline
+ */
+class ResolutionProbe {
+ public:
+  explicit ResolutionProbe(ResolutionCallback callback);
+  ~ResolutionProbe();
+
+  /**
+   * @fn Attach
+   * @brief Adds the caps probe to the sink pad of the video sink.
+   * @param[in] sink : video sink element
+   * @return bool (TRUE - SUCCESS, FALSE - FAIL)
+   */
+  bool Attach(GstElement* sink);
+
+  /**
+   * @fn Detach
+   * @brief Removes the probe, drops a pending change and forgets the current resolution.
+   * @return None
+   */
+  void Detach();
+
+  bool GetResolution(gint* width, gint* height);
+
+ private:
+  static const guint kDebounceMs = 500;
+
+  static GstPadProbeReturn CapsProbe(GstPad* pad, GstPadProbeInfo* info, gpointer data);
+  static gboolean DebounceCallbackFunc(gpointer data);
+
+  ResolutionCallback callback_;
+  std::mutex mutex_;
+  GstPad* pad_;
+  gulong probe_id_;
+  guint debounce_source_id_;
+  gint width_;
+  gint height_;
+  gint pending_width_;
+  gint pending_height_;
+  gint64 pending_time_us_;
+  gint64 last_change_us_;
+};
+
+}  // namespace genivimedia
+
+#endif  // GENIVIMEDIA_RESOLUTION_PROBE_H
@@ -0,0 +1,210 @@
+// @@@LICENSE
+//
+// Copyright (C) 2023, LG Electronics, All Right Reserved.
+//
+// No part of this source code may be communicated, distributed, reproduced
+// or transmitted in any form or by any means, electronic or mechanical or
+// otherwise, for any purpose, without the prior written permission of
+// LG Electronics.
+//
+// LICENSE@@@
+
+#include "player/pipeline/seek_scheduler.h"
+
+#include <string.h>
+#include <sstream>
+
+#include <boost/property_tree/json_parser.hpp>
+#include <boost/property_tree/ptree.hpp>
+
+#include "logger/player_logger.h"
+
+namespace genivimedia {
+
+const guint SeekScheduler::kBucketBoundsMs[SeekScheduler::kBucketCount - 1] = {
+  16, 33, 66, 100, 200, 500, 1000
+};
+
+SeekScheduler::SeekScheduler(SeekSendCallback callback)
+  : send_callback_(callback),
+    mutex_(),
+    in_flight_(false),
+    pending_(false),
+    need_accurate_(false),
+    in_flight_kind_(SEEK_KIND_ACCURATE),
+    in_flight_seqnum_(GST_SEQNUM_INVALID),
+    in_flight_since_(0),
+    last_request_time_(0),
+    target_(0),
+    settle_source_id_(0),
+    coalesced_(0),
+    timeout_(0) {
+  memset(histogram_, 0, sizeof(histogram_));
+}
+
+SeekScheduler::~SeekScheduler() {
+  Reset();
+}
+
+bool SeekScheduler::Request(gint64 position) {
+  SeekKind kind;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    gint64 now = g_get_monotonic_time();
+    bool burst = in_flight_ || (last_request_time_ && (now - last_request_time_) < kBurstWindowUs);
+    last_request_time_ = now;
+    target_ = position;
+
+    if (burst) {
+      need_accurate_ = true;
+      ArmSettleTimer();
+    }
+    if (in_flight_) {
+      pending_ = true;
+      coalesced_++;
+      LOG_INFO("coalesce seek to [%lld], coalesced=[%u]", position, coalesced_);
+      return true;
+    }
+    kind = burst ? SEEK_KIND_KEY_UNIT : SEEK_KIND_ACCURATE;
+  }
+  return Send(position, kind);
+}
+
+bool SeekScheduler::OnDone(bool timeout, guint32 seqnum) {
+  gint64 position = 0;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!in_flight_)
+      return !need_accurate_;
+    if (IsStaleLocked(seqnum)) {
+      LOG_INFO("ignore completion of seqnum=[%u], seqnum=[%u] is in flight", seqnum, in_flight_seqnum_);
+      return false;
+    }
+
+    Record(in_flight_kind_, g_get_monotonic_time() - in_flight_since_);
+    if (timeout)
+      timeout_++;
+    in_flight_ = false;
+
+    if (!pending_)
+      return !need_accurate_;
+    pending_ = false;
+    position = target_;
+  }
+  Send(position, SEEK_KIND_KEY_UNIT);
+  return false;
+}
+
+bool SeekScheduler::IsStale(guint32 seqnum) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return in_flight_ && IsStaleLocked(seqnum);
+}
+
+void SeekScheduler::Reset() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (settle_source_id_) {
+    g_source_remove(settle_source_id_);
+    settle_source_id_ = 0;
+  }
+  in_flight_ = false;
+  in_flight_seqnum_ = GST_SEQNUM_INVALID;
+  pending_ = false;
+  need_accurate_ = false;
+  last_request_time_ = 0;
+}
+
+std::string SeekScheduler::GetLatencyJson() {
+  using boost::property_tree::ptree;
+  ptree bounds;
+  ptree kinds[SEEK_KIND_MAX];
+  ptree latency;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (int i = 0; i < kBucketCount - 1; i++) {
+      ptree bound;
+      bound.put("", kBucketBoundsMs[i]);
+      bounds.push_back(std::make_pair("", bound));
+    }
+    for (int kind = 0; kind < SEEK_KIND_MAX; kind++) {
+      for (int i = 0; i < kBucketCount; i++) {
+        ptree count;
+        count.put("", histogram_[kind][i]);
+        kinds[kind].push_back(std::make_pair("", count));
+      }
+    }
+    latency.put("coalesced", coalesced_);
+    latency.put("timeout", timeout_);
+  }
+  latency.add_child("bounds_ms", bounds);
+  latency.add_child("key_unit", kinds[SEEK_KIND_KEY_UNIT]);
+  latency.add_child("accurate", kinds[SEEK_KIND_ACCURATE]);
+
+  ptree tree;
+  tree.add_child("SeekLatency", latency);
+  std::stringstream stream;
+  boost::property_tree::write_json(stream, tree, false);
+  return stream.str();
+}
+
+gboolean SeekScheduler::SettleCallbackFunc(gpointer data) {
+  SeekScheduler* scheduler = reinterpret_cast<SeekScheduler*>(data);
+  gint64 position = 0;
+  {
+    std::lock_guard<std::mutex> lock(scheduler->mutex_);
+    if (scheduler->in_flight_ ||
+        (g_get_monotonic_time() - scheduler->last_request_time_) < kBurstWindowUs) {
+      // still dragging or the last drag seek is running, check again later
+      return G_SOURCE_CONTINUE;
+    }
+    scheduler->settle_source_id_ = 0;
+    if (!scheduler->need_accurate_)
+      return G_SOURCE_REMOVE;
+    position = scheduler->target_;
+  }
+  LOG_INFO("drag released, accurate seek to [%lld]", position);
+  scheduler->Send(position, SEEK_KIND_ACCURATE);
+  return G_SOURCE_REMOVE;
+}
+
+bool SeekScheduler::Send(gint64 position, SeekKind kind) {
+  GstSeekFlags flags = (kind == SEEK_KIND_KEY_UNIT)
+      ? GstSeekFlags(GST_SEEK_FLAG_FLUSH | GST_SEEK_FLAG_KEY_UNIT | GST_SEEK_FLAG_SNAP_NEAREST)
+      : GstSeekFlags(GST_SEEK_FLAG_FLUSH | GST_SEEK_FLAG_ACCURATE);
+  guint32 seqnum;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    in_flight_ = true;
+    in_flight_kind_ = kind;
+    in_flight_since_ = g_get_monotonic_time();
+    // set before sending, the ASYNC_DONE of the seek may come before send_callback_ returns
+    in_flight_seqnum_ = seqnum = gst_util_seqnum_next();
+    if (kind == SEEK_KIND_ACCURATE)
+      need_accurate_ = false;
+  }
+
+  bool ret = send_callback_ && send_callback_(position, flags, seqnum);
+  if (!ret) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    in_flight_ = false;
+  }
+  return ret;
+}
+
+void SeekScheduler::ArmSettleTimer() {
+  if (settle_source_id_ == 0)
+    settle_source_id_ = g_timeout_add(kSettleMs, SettleCallbackFunc, this);
+}
+
+bool SeekScheduler::IsStaleLocked(guint32 seqnum) const {
+  return seqnum != GST_SEQNUM_INVALID && seqnum != in_flight_seqnum_;
+}
+
+void SeekScheduler::Record(SeekKind kind, gint64 latency_us) {
+  int bucket = 0;
+  while (bucket < kBucketCount - 1 && latency_us > (gint64)kBucketBoundsMs[bucket] * 1000)
+    bucket++;
+  histogram_[kind][bucket]++;
+  LOG_INFO("%s seek took [%lld]us", (kind == SEEK_KIND_KEY_UNIT) ? "key-unit" : "accurate", latency_us);
+}
+
+}  // namespace genivimedia
@@ -0,0 +1,117 @@
+// @@@LICENSE
+//
+// Copyright (C) 2023, LG Electronics, All Right Reserved.
+//
+// No part of this source code may be communicated, distributed, reproduced
+// or transmitted in any form or by any means, electronic or mechanical or
+// otherwise, for any purpose, without the prior written permission of
+// LG Electronics.
+//
+// LICENSE@@@
+
+#ifndef GENIVIMEDIA_SEEK_SCHEDULER_H
+#define GENIVIMEDIA_SEEK_SCHEDULER_H
+
+#include <functional>
+#include <mutex>
+#include <string>
+
+#include <glib.h>
+#include <gst/gst.h>
+
+namespace genivimedia {
+
+typedef std::function<bool(gint64 position, GstSeekFlags flags, guint32 seqnum)> SeekSendCallback;
+
+/**
+ * @class      genivimedia::SeekScheduler
+ * @brief      Keeps at most one flushing seek in flight and coalesces the requests that arrive meanwhile.
+ * @details    A request that comes while a seek is in flight, or shortly after the previous request,
+ *             is treated as part of a drag:
+ *             <ul>
+ *                 <li>only the latest target is kept and sent when the running seek completes,
+ *                 <li>drag seeks use KEY_UNIT|SNAP_NEAREST so that each one finishes quickly,
+ *                 <li>once the requests stop for kSettleMs, one ACCURATE seek goes to the final target.
+ *             </ul>
+ *             Completion is reported by OnDone(), from ASYNC_DONE or from the SeekControl timeout.
+ *             Every seek event is sent with a new seqnum, and an ASYNC_DONE with another seqnum,
+ *             e.g. the late one of a seek which already timed out, is ignored.
+ *             Latency of every seek is collected in a histogram per seek kind.
+ * @see        genivimedia::GstMedia, genivimedia::SeekControl
+ */
+class SeekScheduler {
+ public:
+  explicit SeekScheduler(SeekSendCallback callback);
+  ~SeekScheduler();
+
+  /**
+   * @fn Request
+   * @brief Requests a seek to the position.
+   * @param[in] position : target position in milli-seconds
+   * @return bool (TRUE - sent or queued, FALSE - the immediate seek failed)
+   */
+  bool Request(gint64 position);
+
+  /**
+   * @fn OnDone
+   * @brief Marks the seek in flight as completed and sends the coalesced one if any.
+   * @param[in] timeout : TRUE if completion is reported by the SeekControl timeout
+   * @param[in] seqnum : seqnum of the ASYNC_DONE message, GST_SEQNUM_INVALID matches any seek
+   * @return bool (TRUE - nothing left to seek, FALSE - another seek is in flight or scheduled)
+   */
+  bool OnDone(bool timeout, guint32 seqnum = GST_SEQNUM_INVALID);
+
+  /**
+   * @fn IsStale
+   * @brief Tells whether an ASYNC_DONE belongs to an earlier seek than the one in flight.
+   * @param[in] seqnum : seqnum of the ASYNC_DONE message
+   * @return bool (TRUE - ignore the message, FALSE - it completes the seek in flight or none is)
+   */
+  bool IsStale(guint32 seqnum);
+
+  void Reset();
+
+  /**
+   * @fn GetLatencyJson
+   * @brief Returns the seek latency histograms like
+   *        {"SeekLatency":{"bounds_ms":[...],"key_unit":[...],"accurate":[...],"coalesced":N,"timeout":N}}
+   */
+  std::string GetLatencyJson();
+
+ private:
+  enum SeekKind {
+    SEEK_KIND_KEY_UNIT = 0,
+    SEEK_KIND_ACCURATE,
+    SEEK_KIND_MAX
+  };
+
+  static gboolean SettleCallbackFunc(gpointer data);
+  bool Send(gint64 position, SeekKind kind);
+  void ArmSettleTimer();
+  void Record(SeekKind kind, gint64 latency_us);
+  bool IsStaleLocked(guint32 seqnum) const;
+
+  static const gint64 kBurstWindowUs = 300000;
+  static const guint kSettleMs = 300;
+  static const int kBucketCount = 8;
+  static const guint kBucketBoundsMs[kBucketCount - 1];
+
+  SeekSendCallback send_callback_;
+  std::mutex mutex_;
+  bool in_flight_;
+  bool pending_;
+  bool need_accurate_;
+  SeekKind in_flight_kind_;
+  guint32 in_flight_seqnum_;
+  gint64 in_flight_since_;
+  gint64 last_request_time_;
+  gint64 target_;
+  guint settle_source_id_;
+  guint histogram_[SEEK_KIND_MAX][kBucketCount];
+  guint coalesced_;
+  guint timeout_;
+};
+
+}  // namespace genivimedia
+
+#endif  // GENIVIMEDIA_SEEK_SCHEDULER_H
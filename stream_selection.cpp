@@ -0,0 +1,172 @@
+// @@@LICENSE
+//
+// Copyright (C) 2023, LG Electronics, All Right Reserved.
+//
+// No part of this source code may be communicated, distributed, reproduced
+// or transmitted in any form or by any means, electronic or mechanical or
+// otherwise, for any purpose, without the prior written permission of
+// LG Electronics.
+//
+// LICENSE@@@
+
+#include "player/pipeline/stream_selection.h"
+
+#include "logger/player_logger.h"
+
+namespace genivimedia {
+
+StreamSelection::StreamSelection()
+  : mutex_(),
+    collection_(nullptr),
+    streams_(),
+    current_{-1, -1, -1},
+    request_time_us_(0) {
+}
+
+StreamSelection::~StreamSelection() {
+  Reset();
+}
+
+void StreamSelection::SetCollection(GstElement* pipeline, GstStreamCollection* collection, bool with_audio,
+                                    const StreamFilter& filter) {
+  if (!pipeline || !collection)
+    return;
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (collection_ == collection)
+    return;
+  if (collection_)
+    gst_object_unref(collection_);
+  collection_ = GST_STREAM_COLLECTION(gst_object_ref(collection));
+
+  for (auto& list : streams_)
+    list.clear();
+  guint size = gst_stream_collection_get_size(collection_);
+  for (guint i = 0; i < size; i++) {
+    GstStream* stream = gst_stream_collection_get_stream(collection_, i);
+    int type = TypeIndex(gst_stream_get_stream_type(stream));
+    if (type >= 0 && (!filter || filter(stream)))
+      streams_[type].push_back(stream);
+  }
+  LOG_INFO("stream collection audio=[%u] video=[%u] text=[%u]",
+           (guint)streams_[0].size(), (guint)streams_[1].size(), (guint)streams_[2].size());
+
+  // keep the previous choice when a new collection of the same file arrives (e.g. after a seek)
+  for (int type = 0; type < 3; type++) {
+    if (current_[type] >= (int)streams_[type].size())
+      current_[type] = -1;
+  }
+  if (current_[0] < 0 && with_audio && !streams_[0].empty())
+    current_[0] = 0;
+  if (!with_audio)
+    current_[0] = -1;
+  if (current_[1] < 0 && !streams_[1].empty())
+    current_[1] = 0;
+  SendLocked(pipeline);
+}
+
+void StreamSelection::OnSelected(GstMessage* message) {
+  guint count = gst_message_streams_selected_get_size(message);
+  for (guint i = 0; i < count; i++) {
+    GstStream* stream = gst_message_streams_selected_get_stream(message, i);
+    if (stream) {
+      LOG_INFO("selected stream [%s] type=[%s]", gst_stream_get_stream_id(stream),
+               gst_stream_type_get_name(gst_stream_get_stream_type(stream)));
+      gst_object_unref(stream);
+    }
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (request_time_us_) {
+    LOG_INFO("streams selected in [%lld]us", g_get_monotonic_time() - request_time_us_);
+    request_time_us_ = 0;
+  }
+}
+
+bool StreamSelection::Select(GstElement* pipeline, GstStreamType type, int index) {
+  int type_index = TypeIndex(type);
+  if (!pipeline || type_index < 0)
+    return false;
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!collection_ || index >= (int)streams_[type_index].size()) {
+    LOG_INFO("return - index(%d) exceeds %u %s streams", index,
+             (guint)streams_[type_index].size(), gst_stream_type_get_name(type));
+    return false;
+  }
+  if (index < 0)
+    index = -1;
+  if (current_[type_index] == index)
+    return true;
+  current_[type_index] = index;
+  return SendLocked(pipeline);
+}
+
+int StreamSelection::GetCount(GstStreamType type) {
+  int type_index = TypeIndex(type);
+  if (type_index < 0)
+    return 0;
+  std::lock_guard<std::mutex> lock(mutex_);
+  return (int)streams_[type_index].size();
+}
+
+int StreamSelection::GetCurrent(GstStreamType type) {
+  int type_index = TypeIndex(type);
+  if (type_index < 0)
+    return -1;
+  std::lock_guard<std::mutex> lock(mutex_);
+  return current_[type_index];
+}
+
+GstStream* StreamSelection::GetStream(GstStreamType type, int index) {
+  int type_index = TypeIndex(type);
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (type_index < 0 || index < 0 || index >= (int)streams_[type_index].size())
+    return nullptr;
+  return GST_STREAM(gst_object_ref(streams_[type_index][index]));
+}
+
+void StreamSelection::Reset() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto& list : streams_)
+    list.clear();
+  for (int& current : current_)
+    current = -1;
+  if (collection_) {
+    gst_object_unref(collection_);
+    collection_ = nullptr;
+  }
+  request_time_us_ = 0;
+}
+
+int StreamSelection::TypeIndex(GstStreamType type) {
+  if (type & GST_STREAM_TYPE_AUDIO)
+    return 0;
+  if (type & GST_STREAM_TYPE_VIDEO)
+    return 1;
+  if (type & GST_STREAM_TYPE_TEXT)
+    return 2;
+  return -1;
+}
+
+bool StreamSelection::SendLocked(GstElement* pipeline) {
+  GList* ids = nullptr;
+  for (int type = 0; type < 3; type++) {
+    if (current_[type] >= 0)
+      ids = g_list_append(ids, (gchar*)gst_stream_get_stream_id(streams_[type][current_[type]]));
+  }
+  if (!ids) {
+    LOG_ERROR("no stream to select");
+    return false;
+  }
+
+  // the event copies the ids, the stream objects stay owned by the collection
+  request_time_us_ = g_get_monotonic_time();
+  bool ret = gst_element_send_event(pipeline, gst_event_new_select_streams(ids));
+  LOG_INFO("select-streams audio=[%d] video=[%d] text=[%d] ret=[%d]",
+           current_[0], current_[1], current_[2], ret);
+  g_list_free(ids);
+  return ret;
+}
+
+}  // namespace genivimedia
@@ -0,0 +1,100 @@
+// @@@LICENSE
+//
+// Copyright (C) 2023, LG Electronics, All Right Reserved.
+//
+// No part of this source code may be communicated, distributed, reproduced
+// or transmitted in any form or by any means, electronic or mechanical or
+// otherwise, for any purpose, without the prior written permission of
+// LG Electronics.
+//
+// LICENSE@@@
+
+#ifndef GENIVIMEDIA_STREAM_SELECTION_H
+#define GENIVIMEDIA_STREAM_SELECTION_H
+
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <glib.h>
+#include <gst/gst.h>
+
+namespace genivimedia {
+
+typedef std::function<bool(GstStream* stream)> StreamFilter;
+
+/**
+ * @class      genivimedia::StreamSelection
+ * @brief      Tracks the stream collection of playbin3 and decides which streams get decoders.
+ * @details    decodebin3 only plugs decoders for the streams listed in the last select-streams event.
+ *             SetCollection() takes the collection posted by decodebin3 and selects the first video,
+ *             the first audio (unless audio is disabled) and no text stream. Streams rejected by the
+ *             filter are left out entirely, as playbin does not expose a pad nothing may decode. Select() changes the
+ *             stream of one type by index and sends a new select-streams event, so a track switch
+ *             only swaps that decoder instead of rebuilding the pipeline.
+ *             Indexes count streams of the same type in collection order, like n-audio/current-audio
+ *             of playbin.
+ * @see        genivimedia::GstMedia::HandleStreamCollection
+ */
+class StreamSelection {
+ public:
+  StreamSelection();
+  ~StreamSelection();
+
+  /**
+   * @fn SetCollection
+   * @brief Stores the collection and sends the initial selection.
+   * @param[in] pipeline : playbin3
+   * @param[in] collection : collection from GST_MESSAGE_STREAM_COLLECTION
+   * @param[in] with_audio : FALSE to select no audio stream
+   * @param[in] filter : returns FALSE for a stream which shall not be counted nor selected, may be empty
+   * @return None
+   */
+  void SetCollection(GstElement* pipeline, GstStreamCollection* collection, bool with_audio,
+                     const StreamFilter& filter);
+
+  /**
+   * @fn OnSelected
+   * @brief Logs the streams decodebin3 has actually selected and the switch latency.
+   * @param[in] message : GST_MESSAGE_STREAMS_SELECTED
+   * @return None
+   */
+  void OnSelected(GstMessage* message);
+
+  /**
+   * @fn Select
+   * @brief Selects the index-th stream of the type, -1 selects none of the type.
+   * @param[in] pipeline : playbin3
+   * @param[in] type : GST_STREAM_TYPE_AUDIO, GST_STREAM_TYPE_VIDEO or GST_STREAM_TYPE_TEXT
+   * @param[in] index : index among the streams of the type
+   * @return bool (TRUE - SUCCESS, FALSE - FAIL)
+   */
+  bool Select(GstElement* pipeline, GstStreamType type, int index);
+
+  int GetCount(GstStreamType type);
+  int GetCurrent(GstStreamType type);
+
+  /**
+   * @fn GetStream
+   * @brief Returns the index-th stream of the type.
+   * @return GstStream* (new reference) or nullptr
+   */
+  GstStream* GetStream(GstStreamType type, int index);
+
+  void Reset();
+
+ private:
+  static int TypeIndex(GstStreamType type);
+  bool SendLocked(GstElement* pipeline);
+
+  std::mutex mutex_;
+  GstStreamCollection* collection_;
+  std::vector<GstStream*> streams_[3];  /**< audio, video, text in collection order */
+  int current_[3];
+  gint64 request_time_us_;
+};
+
+}  // namespace genivimedia
+
+#endif  // GENIVIMEDIA_STREAM_SELECTION_H
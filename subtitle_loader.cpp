@@ -0,0 +1,117 @@
+// @@@LICENSE
+//
+// Copyright (C) 2023, LG Electronics, All Right Reserved.
+//
+// No part of this source code may be communicated, distributed, reproduced
+// or transmitted in any form or by any means, electronic or mechanical or
+// otherwise, for any purpose, without the prior written permission of
+// LG Electronics.
+//
+// LICENSE@@@
+
+#include "player/pipeline/subtitle_loader.h"
+
+#include <thread>
+
+#include "logger/player_logger.h"
+
+namespace genivimedia {
+
+SubtitleLoader::SubtitleLoader()
+  : state_(std::make_shared<State>()) {
+  state_->generation_ = 0;
+  state_->running_ = false;
+  state_->loading_ = false;
+  state_->done_source_id_ = 0;
+  state_->start_time_us_ = 0;
+}
+
+SubtitleLoader::~SubtitleLoader() {
+  Cancel();
+  // the parse function uses the subtitle controller, which goes away with the pipeline
+  std::unique_lock<std::mutex> lock(state_->mutex_);
+  state_->idle_.wait(lock, [this]() { return !state_->running_; });
+}
+
+void SubtitleLoader::Start(SubtitleParseFunc parse, SubtitleDoneFunc done) {
+  std::lock_guard<std::mutex> lock(state_->mutex_);
+  state_->generation_++;
+  DropResultLocked(state_.get());
+
+  state_->pending_ = parse;
+  state_->done_ = done;
+  state_->loading_ = true;
+  state_->start_time_us_ = g_get_monotonic_time();
+  if (state_->running_)
+    return;
+  state_->running_ = true;
+  std::thread(&SubtitleLoader::Run, state_).detach();
+}
+
+void SubtitleLoader::Cancel() {
+  std::lock_guard<std::mutex> lock(state_->mutex_);
+  state_->generation_++;
+  DropResultLocked(state_.get());
+  state_->pending_ = nullptr;
+  state_->done_ = nullptr;
+  state_->loading_ = false;
+}
+
+bool SubtitleLoader::IsLoading() {
+  // a cancelled parse still running delays the next one queued behind it
+  std::lock_guard<std::mutex> lock(state_->mutex_);
+  return state_->loading_ || state_->running_;
+}
+
+void SubtitleLoader::Run(std::shared_ptr<State> state) {
+  std::unique_lock<std::mutex> lock(state->mutex_);
+  while (state->pending_) {
+    SubtitleParseFunc parse = std::move(state->pending_);
+    state->pending_ = nullptr;
+    guint generation = state->generation_;
+    lock.unlock();
+    std::vector<std::string> languages = parse();
+    lock.lock();
+
+    if (generation != state->generation_) {
+      LOG_INFO("subtitle load cancelled");
+      continue;
+    }
+    Result* result = new Result();
+    result->state_ = state;
+    result->generation_ = generation;
+    result->languages_.swap(languages);
+    state->done_source_id_ = g_idle_add_full(G_PRIORITY_DEFAULT_IDLE, DoneCallbackFunc, result,
+                                             [](gpointer data) { delete reinterpret_cast<Result*>(data); });
+  }
+  state->running_ = false;
+  state->idle_.notify_all();
+}
+
+gboolean SubtitleLoader::DoneCallbackFunc(gpointer data) {
+  Result* result = reinterpret_cast<Result*>(data);
+  State* state = result->state_.get();
+  SubtitleDoneFunc done;
+  {
+    std::lock_guard<std::mutex> lock(state->mutex_);
+    if (result->generation_ != state->generation_)
+      return G_SOURCE_REMOVE;
+    state->done_source_id_ = 0;
+    state->loading_ = false;
+    done = state->done_;
+    LOG_INFO("subtitle loaded with [%u] languages in [%lld]us", (guint)result->languages_.size(),
+             g_get_monotonic_time() - state->start_time_us_);
+  }
+  if (done)
+    done(result->languages_);
+  return G_SOURCE_REMOVE;
+}
+
+void SubtitleLoader::DropResultLocked(State* state) {
+  if (state->done_source_id_) {
+    g_source_remove(state->done_source_id_);
+    state->done_source_id_ = 0;
+  }
+}
+
+}  // namespace genivimedia
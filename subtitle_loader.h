@@ -0,0 +1,92 @@
+// @@@LICENSE
+//
+// Copyright (C) 2023, LG Electronics, All Right Reserved.
+//
+// No part of this source code may be communicated, distributed, reproduced
+// or transmitted in any form or by any means, electronic or mechanical or
+// otherwise, for any purpose, without the prior written permission of
+// LG Electronics.
+//
+// LICENSE@@@
+
+#ifndef GENIVIMEDIA_SUBTITLE_LOADER_H
+#define GENIVIMEDIA_SUBTITLE_LOADER_H
+
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <glib.h>
+
+namespace genivimedia {
+
+/**
+ * @return languages of the loaded subtitle, empty if there is none
+ */
+typedef std::function<std::vector<std::string>()> SubtitleParseFunc;
+typedef std::function<void(const std::vector<std::string>& languages)> SubtitleDoneFunc;
+
+/**
+ * @class      genivimedia::SubtitleLoader
+ * @brief      Parses the external subtitle on a worker thread.
+ * @details    Start() runs the parse function on a detached worker and hands the language list to the
+ *             done function on the main context, so a large SMI/SRT file no longer delays READY.
+ *             Start() and Cancel() never wait: the subtitle parser has no interruption point, so a
+ *             running parse is only marked stale and its result dropped, and a new parse is queued
+ *             behind it on the same worker. Parses therefore never overlap on the controller.
+ *             The worker and a pending result share the state by reference count, only the destructor
+ *             waits for a running parse. The parse function shall only use objects of its own, e.g. a
+ *             controller that the done function takes over, since a cancelled parse keeps running.
+ *             IsLoading() is TRUE while a result is awaited or a parse is still running.
+ * @see        genivimedia::VideoPipeline::HandleSourceInfo
+ */
+class SubtitleLoader {
+ public:
+  SubtitleLoader();
+  ~SubtitleLoader();
+
+  /**
+   * @fn Start
+   * @brief Cancels the running load and starts a new one.
+   * @param[in] parse : called on the worker thread, after a parse still running
+   * @param[in] done : called on the main context unless cancelled
+   * @return None
+   */
+  void Start(SubtitleParseFunc parse, SubtitleDoneFunc done);
+
+  void Cancel();
+
+  bool IsLoading();
+
+ private:
+  struct State {
+    std::mutex mutex_;
+    std::condition_variable idle_;
+    SubtitleParseFunc pending_;
+    SubtitleDoneFunc done_;
+    guint generation_;
+    bool running_;
+    bool loading_;
+    guint done_source_id_;
+    gint64 start_time_us_;
+  };
+
+  struct Result {
+    std::shared_ptr<State> state_;
+    guint generation_;
+    std::vector<std::string> languages_;
+  };
+
+  static gboolean DoneCallbackFunc(gpointer data);
+  static void Run(std::shared_ptr<State> state);
+  static void DropResultLocked(State* state);
+
+  std::shared_ptr<State> state_;
+};
+
+}  // namespace genivimedia
+
+#endif  // GENIVIMEDIA_SUBTITLE_LOADER_H
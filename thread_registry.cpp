@@ -0,0 +1,295 @@
+// @@@LICENSE
+//
+// Copyright (C) 2023, LG Electronics, All Right Reserved.
+//
+// No part of this source code may be communicated, distributed, reproduced
+// or transmitted in any form or by any means, electronic or mechanical or
+// otherwise, for any purpose, without the prior written permission of
+// LG Electronics.
+//
+// LICENSE@@@
+
+#include "player/pipeline/thread_registry.h"
+
+#include <errno.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <sys/prctl.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <sstream>
+
+#include <boost/property_tree/json_parser.hpp>
+#include <boost/property_tree/ptree.hpp>
+
+#include "logger/player_logger.h"
+
+namespace genivimedia {
+
+ThreadRegistry* ThreadRegistry::instance_ = nullptr;
+
+ThreadRegistry* ThreadRegistry::Instance() {
+  if (instance_ == nullptr) {
+    instance_ = new ThreadRegistry();
+  }
+  return instance_;
+}
+
+void ThreadRegistry::Destroy() {
+  if (instance_) {
+    delete instance_;
+    instance_ = nullptr;
+  }
+}
+
+ThreadRegistry::ThreadRegistry()
+  : mutex_(),
+    policies_(),
+    threads_() {
+}
+
+ThreadRegistry::~ThreadRegistry() {
+  LOG_INFO("");
+}
+
+int ThreadRegistry::LoadPolicy(const gchar* table) {
+  std::vector<ThreadPolicy> policies;
+  if (table) {
+    std::stringstream stream(table);
+    std::string entry;
+    while (std::getline(stream, entry, ';')) {
+      ThreadPolicy policy;
+      if (ParseEntry(entry, policy))
+        policies.push_back(policy);
+      else if (entry.find_first_not_of(" \t") != std::string::npos)
+        LOG_ERROR("Invalid thread policy [%s]", entry.c_str());
+    }
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  policies_.swap(policies);
+  LOG_INFO("%u thread policies loaded", (guint)policies_.size());
+  return (int)policies_.size();
+}
+
+void ThreadRegistry::HandleSyncMessage(GstMessage* message) {
+  if (GST_MESSAGE_TYPE(message) != GST_MESSAGE_STREAM_STATUS)
+    return;
+
+  GstStreamStatusType type;
+  GstElement* owner = nullptr;
+  gst_message_parse_stream_status(message, &type, &owner);
+  if (type != GST_STREAM_STATUS_TYPE_ENTER && type != GST_STREAM_STATUS_TYPE_LEAVE)
+    return;
+
+  // ENTER and LEAVE are posted by the streaming thread itself
+  pid_t tid = (pid_t)syscall(SYS_gettid);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (type == GST_STREAM_STATUS_TYPE_LEAVE) {
+    threads_.erase(tid);
+    return;
+  }
+
+  ThreadEntry entry;
+  entry.name_ = ThreadName(message);
+  entry.owner_ = owner ? GST_OBJECT_NAME(owner) : "";
+  entry.applied_ = false;
+
+  const ThreadPolicy* policy = FindPolicy(entry.name_, entry.owner_);
+  if (policy) {
+    entry.applied_ = Apply(tid, *policy);
+    LOG_INFO("thread[%d] %s(%s) matches [%s], applied=[%d]",
+             tid, entry.name_.c_str(), entry.owner_.c_str(), policy->pattern_.c_str(), entry.applied_);
+  }
+  threads_[tid] = entry;
+}
+
+std::string ThreadRegistry::ThreadName(GstMessage* message) {
+  // a pad task renames its thread only after ENTER, so the kernel name is still the previous one
+  const GValue* object = gst_message_get_stream_status_object(message);
+  if (object && G_VALUE_HOLDS(object, GST_TYPE_TASK)) {
+    GstTask* task = GST_TASK(g_value_get_object(object));
+    if (task) {
+      gchar* name = gst_object_get_name(GST_OBJECT_CAST(task));
+      std::string task_name = name ? name : "";
+      g_free(name);
+      if (!task_name.empty())
+        return task_name;
+    }
+  }
+
+  // other threads, e.g. the audio ring buffer, are named when they are created
+  char comm[16] = {0,};
+  prctl(PR_GET_NAME, comm, 0, 0, 0);
+  return comm;
+}
+
+int ThreadRegistry::SetNice(const gchar* name, gint nice) {
+  if (!name)
+    return 0;
+
+  int count = 0;
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto& thread : threads_) {
+    if (thread.second.name_.find(name) == std::string::npos)
+      continue;
+    if (setpriority(PRIO_PROCESS, thread.first, nice) != -1) {
+      LOG_INFO("set the (tid:%d, %s) priority to %d", thread.first, thread.second.name_.c_str(), nice);
+      count++;
+    } else {
+      LOG_ERROR("setpriority(%d, %d) failed, errno=[%d]", thread.first, nice, errno);
+    }
+  }
+  return count;
+}
+
+std::string ThreadRegistry::GetJson() {
+  using boost::property_tree::ptree;
+  ptree threads;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& thread : threads_) {
+      pid_t tid = thread.first;
+      ptree item;
+      item.put("tid", tid);
+      item.put("name", thread.second.name_);
+      item.put("owner", thread.second.owner_);
+      item.put("applied", thread.second.applied_);
+
+      int policy = sched_getscheduler(tid);
+      struct sched_param param = {0};
+      sched_getparam(tid, &param);
+      item.put("policy", (policy == SCHED_FIFO) ? "fifo" : (policy == SCHED_RR) ? "rr" : "other");
+      item.put("priority", param.sched_priority);
+      errno = 0;
+      int nice = getpriority(PRIO_PROCESS, tid);
+      item.put("nice", errno ? 0 : nice);
+
+      cpu_set_t set;
+      CPU_ZERO(&set);
+      guint64 mask = 0;
+      if (sched_getaffinity(tid, sizeof(set), &set) == 0) {
+        for (int cpu = 0; cpu < 64; cpu++) {
+          if (CPU_ISSET(cpu, &set))
+            mask |= (1ull << cpu);
+        }
+      }
+      gchar* affinity = g_strdup_printf("0x%llx", (unsigned long long)mask);
+      item.put("affinity", affinity);
+      g_free(affinity);
+
+      threads.push_back(std::make_pair("", item));
+    }
+  }
+
+  ptree tree;
+  tree.add_child("Threads", threads);
+  std::stringstream stream;
+  boost::property_tree::write_json(stream, tree, false);
+  return stream.str();
+}
+
+bool ThreadRegistry::ParseEntry(const std::string& entry, ThreadPolicy& policy) {
+  std::stringstream stream(entry);
+  std::string token;
+
+  if (!(stream >> policy.pattern_))
+    return false;
+  policy.sched_policy_ = SCHED_OTHER;
+  policy.rt_priority_ = 0;
+  policy.nice_ = 0;
+  policy.has_nice_ = false;
+  policy.cpu_mask_ = 0;
+
+  while (stream >> token) {
+    size_t pos = token.find('=');
+    if (pos == std::string::npos)
+      return false;
+    std::string key = token.substr(0, pos);
+    std::string value = token.substr(pos + 1);
+
+    if (key == "policy") {
+      if (value == "fifo")
+        policy.sched_policy_ = SCHED_FIFO;
+      else if (value == "rr")
+        policy.sched_policy_ = SCHED_RR;
+      else if (value == "other")
+        policy.sched_policy_ = SCHED_OTHER;
+      else
+        return false;
+    } else if (key == "priority") {
+      policy.rt_priority_ = atoi(value.c_str());
+    } else if (key == "nice") {
+      policy.nice_ = atoi(value.c_str());
+      policy.has_nice_ = true;
+    } else if (key == "affinity") {
+      policy.cpu_mask_ = ParseCpuList(value);
+    } else {
+      return false;
+    }
+  }
+  return true;
+}
+
+guint64 ThreadRegistry::ParseCpuList(const std::string& list) {
+  guint64 mask = 0;
+  std::stringstream stream(list);
+  std::string range;
+  while (std::getline(stream, range, ',')) {
+    // "2-3" or "1", like the kernel cpu list format
+    int first = 0;
+    int last = 0;
+    size_t dash = range.find('-');
+    first = atoi(range.substr(0, dash).c_str());
+    last = (dash == std::string::npos) ? first : atoi(range.substr(dash + 1).c_str());
+    for (int cpu = first; cpu <= last && cpu < 64; cpu++)
+      mask |= (1ull << cpu);
+  }
+  return mask;
+}
+
+const ThreadPolicy* ThreadRegistry::FindPolicy(const std::string& name, const std::string& owner) {
+  for (const ThreadPolicy& policy : policies_) {
+    if (g_pattern_match_simple(policy.pattern_.c_str(), name.c_str()) ||
+        (!owner.empty() && g_pattern_match_simple(policy.pattern_.c_str(), owner.c_str())))
+      return &policy;
+  }
+  return nullptr;
+}
+
+bool ThreadRegistry::Apply(pid_t tid, const ThreadPolicy& policy) {
+  bool ret = true;
+
+  if (policy.sched_policy_ == SCHED_FIFO || policy.sched_policy_ == SCHED_RR) {
+    struct sched_param param = {0};
+    param.sched_priority = policy.rt_priority_;
+    if (sched_setscheduler(tid, policy.sched_policy_, &param) != 0) {
+      LOG_ERROR("sched_setscheduler(%d) failed, errno=[%d]", tid, errno);
+      ret = false;
+    }
+  } else if (policy.has_nice_) {
+    if (setpriority(PRIO_PROCESS, tid, policy.nice_) != 0) {
+      LOG_ERROR("setpriority(%d, %d) failed, errno=[%d]", tid, policy.nice_, errno);
+      ret = false;
+    }
+  }
+
+  if (policy.cpu_mask_) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu = 0; cpu < 64; cpu++) {
+      if (policy.cpu_mask_ & (1ull << cpu))
+        CPU_SET(cpu, &set);
+    }
+    if (sched_setaffinity(tid, sizeof(set), &set) != 0) {
+      LOG_ERROR("sched_setaffinity(%d) failed, errno=[%d]", tid, errno);
+      ret = false;
+    }
+  }
+  return ret;
+}
+
+}  // namespace genivimedia
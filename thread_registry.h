@@ -0,0 +1,114 @@
+// @@@LICENSE
+//
+// Copyright (C) 2023, LG Electronics, All Right Reserved.
+//
+// No part of this source code may be communicated, distributed, reproduced
+// or transmitted in any form or by any means, electronic or mechanical or
+// otherwise, for any purpose, without the prior written permission of
+// LG Electronics.
+//
+// LICENSE@@@
+
+#ifndef GENIVIMEDIA_THREAD_REGISTRY_H
+#define GENIVIMEDIA_THREAD_REGISTRY_H
+
+#include <sys/types.h>
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <glib.h>
+#include <gst/gst.h>
+
+namespace genivimedia {
+
+/**
+ * @struct     genivimedia::ThreadPolicy
+ * @brief      Scheduling settings for the threads whose name matches pattern_.
+ */
+struct ThreadPolicy {
+  std::string pattern_;     /**< glob on thread name or owner element name, e.g. "audiosink-ringb*" */
+  int sched_policy_;        /**< SCHED_OTHER, SCHED_FIFO or SCHED_RR */
+  int rt_priority_;         /**< 1~99 for SCHED_FIFO/SCHED_RR */
+  int nice_;                /**< used with SCHED_OTHER */
+  bool has_nice_;
+  guint64 cpu_mask_;        /**< bit per cpu, 0 keeps the inherited affinity */
+};
+
+/**
+ * @class      genivimedia::ThreadRegistry
+ * @brief      Tracks GStreamer streaming threads and applies the thread policy of playerengine.conf.
+ * @details    Streaming tasks and the audio ring buffer thread post STREAM_STATUS ENTER from the new
+ *             thread itself, so HandleSyncMessage(), called from the bus sync handler, knows the tid
+ *             without scanning /proc. A task thread is named after its GstTask ("element:pad"), the
+ *             kernel name is only set once the task runs. The policy table is a string like
+ *             "audiosink-ringb* policy=fifo priority=50 affinity=2-3; vqueue*:src nice=-5" where every
+ *             ';' separated entry is "<pattern> <key>=<value> ...". GetJson() reports what the kernel
+ *             currently has for every registered thread.
+ * @see        genivimedia::GstMedia
+ */
+class ThreadRegistry {
+ public:
+  static ThreadRegistry* Instance();
+  static void Destroy();
+
+  /**
+   * @fn LoadPolicy
+   * @brief Replaces the policy table.
+   * @param[in] table : policy string from Conf::GetThreadPolicy(), nullptr clears the table
+   * @return int (number of valid entries)
+   */
+  int LoadPolicy(const gchar* table);
+
+  /**
+   * @fn HandleSyncMessage
+   * @brief Registers or unregisters the posting thread on STREAM_STATUS ENTER/LEAVE.
+   * @param[in] message : any bus message, called on the posting thread
+   * @return None
+   */
+  void HandleSyncMessage(GstMessage* message);
+
+  /**
+   * @fn SetNice
+   * @brief Sets the nice value of the registered threads whose name contains name.
+   * @param[in] name : part of the thread name, e.g. "audiosink-ringb"
+   * @param[in] nice : -20~19
+   * @return int (number of threads changed)
+   */
+  int SetNice(const gchar* name, gint nice);
+
+  /**
+   * @fn GetJson
+   * @brief Returns the registered threads like
+   *        {"Threads":[{"tid":N,"name":"..","owner":"..","policy":"fifo","priority":N,"nice":N,"affinity":"0x.."}]}
+   */
+  std::string GetJson();
+
+ private:
+  struct ThreadEntry {
+    std::string name_;
+    std::string owner_;
+    bool applied_;
+  };
+
+  ThreadRegistry();
+  ~ThreadRegistry();
+
+  static std::string ThreadName(GstMessage* message);
+  static bool ParseEntry(const std::string& entry, ThreadPolicy& policy);
+  static guint64 ParseCpuList(const std::string& list);
+  const ThreadPolicy* FindPolicy(const std::string& name, const std::string& owner);
+  static bool Apply(pid_t tid, const ThreadPolicy& policy);
+
+  static ThreadRegistry* instance_;
+
+  std::mutex mutex_;
+  std::vector<ThreadPolicy> policies_;
+  std::map<pid_t, ThreadEntry> threads_;
+};
+
+}  // namespace genivimedia
+
+#endif  // GENIVIMEDIA_THREAD_REGISTRY_H
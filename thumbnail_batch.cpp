@@ -0,0 +1,459 @@
+// @@@LICENSE
+//
+// Copyright (C) 2023, LG Electronics, All Right Reserved.
+//
+// No part of this source code may be communicated, distributed, reproduced
+// or transmitted in any form or by any means, electronic or mechanical or
+// otherwise, for any purpose, without the prior written permission of
+// LG Electronics.
+//
+// LICENSE@@@
+
+#include "player/pipeline/thumbnail_batch.h"
+
+#include <boost/property_tree/json_parser.hpp>
+#include <boost/property_tree/ptree.hpp>
+
+#include <sstream>
+#include <thread>
+
+#include "logger/player_logger.h"
+#include "player/pipeline/autoplug_policy.h"
+#include "player/pipeline/conf.h"
+#include "player/pipeline/thumbnail_cache.h"
+#include "player/pipeline/thumbnail_encoder.h"
+#include "player/pipeline/thumbnail_frame_selector.h"
+#include "player/pipeline/thumbnail_scaler.h"
+
+namespace genivimedia {
+
+static const gchar* kNoVideoMessage = "thumbnail-no-video";
+
+ThumbnailBatch::ThumbnailBatch(ThumbnailBatchCallback callback)
+  : mutex_(),
+    callback_(callback),
+    items_(),
+    source_ids_(),
+    idle_(),
+    worker_count_(0),
+    live_workers_(0),
+    next_item_(0),
+    finished_workers_(0),
+    succeeded_(0),
+    generation_(0),
+    start_time_us_(0) {
+}
+
+ThumbnailBatch::~ThumbnailBatch() {
+  Cancel();
+  // stale workers still use the lock and post through this object
+  std::unique_lock<std::mutex> lock(mutex_);
+  idle_.wait(lock, [this]() { return live_workers_ == 0; });
+}
+
+bool ThumbnailBatch::Start(const std::vector<ThumbnailItem>& items) {
+  Cancel();
+  if (items.empty())
+    return false;
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  items_ = items;
+  next_item_ = 0;
+  finished_workers_ = 0;
+  succeeded_ = 0;
+  generation_++;
+  start_time_us_ = g_get_monotonic_time();
+
+  guint count = MIN((guint)g_get_num_processors(), (guint)items_.size());
+  worker_count_ = count;
+  live_workers_ += count;
+  // workers wait on the lock for their first item until the list is complete
+  for (guint i = 0; i < count; i++) {
+    Worker* worker = new Worker();
+    worker->generation_ = generation_;
+    worker->pipeline_ = nullptr;
+    worker->uridecode_ = nullptr;
+    worker->convert_ = nullptr;
+    worker->sink_ = nullptr;
+    std::thread(&ThumbnailBatch::Run, this, worker).detach();
+  }
+  LOG_INFO("%u items on %u workers", (guint)items_.size(), count);
+  return true;
+}
+
+void ThumbnailBatch::Cancel() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  generation_++;
+  worker_count_ = 0;
+  for (guint id : source_ids_)
+    g_source_remove(id);
+  source_ids_.clear();
+}
+
+bool ThumbnailBatch::IsRunning() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return worker_count_ > 0;
+}
+
+void ThumbnailBatch::Run(Worker* worker) {
+  guint generation = worker->generation_;
+  while (true) {
+    ThumbnailItem item;
+    guint index = 0;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (generation != generation_ || next_item_ >= items_.size())
+        break;
+      index = next_item_++;
+      item = items_[index];
+    }
+
+    Result* result = new Result();
+    result->batch_ = this;
+    result->generation_ = generation;
+    result->source_id_ = 0;
+    result->done_ = false;
+    result->index_ = index;
+    result->uri_ = item.uri_;
+    result->duration_ = -1;
+    result->reused_ = (worker->pipeline_ != nullptr);
+    result->cached_ = false;
+    gint64 start = g_get_monotonic_time();
+    result->success_ = Extract(worker, item, result);
+    result->elapsed_us_ = g_get_monotonic_time() - start;
+    Post(result);
+  }
+  ReleasePipeline(worker);
+  delete worker;
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (generation == generation_ && ++finished_workers_ == worker_count_) {
+    Result* result = new Result();
+    result->batch_ = this;
+    result->generation_ = generation;
+    result->source_id_ = 0;
+    result->done_ = true;
+    PostLocked(result);
+  }
+  // the destructor may proceed once this is zero, nothing touches the batch afterwards
+  live_workers_--;
+  idle_.notify_all();
+}
+
+bool ThumbnailBatch::Extract(Worker* worker, const ThumbnailItem& item, Result* result) {
+  result->path_ = OutputPath(item);
+  if (ThumbnailCache::Instance()->IsOpen() &&
+      ThumbnailCache::MakeKey(item.raw_uri_, Conf::GetThumbnail(THUMBNAIL_FORMAT), &result->cache_key_)) {
+    std::vector<guint8> data;
+    if (ThumbnailCache::Instance()->Lookup(result->cache_key_, &data, &result->duration_) &&
+        g_file_set_contents(result->path_.c_str(), (const gchar*)data.data(), data.size(), nullptr)) {
+      result->cached_ = true;
+      return true;
+    }
+  }
+
+  if (worker->pipeline_) {
+    // READY drops the decode chain of the previous file, the converter tail stays linked
+    gst_element_set_state(worker->pipeline_, GST_STATE_READY);
+    GstBus* bus = gst_element_get_bus(worker->pipeline_);
+    gst_bus_set_flushing(bus, TRUE);
+    gst_bus_set_flushing(bus, FALSE);
+    gst_object_unref(bus);
+  } else if (!BuildPipeline(worker)) {
+    return false;
+  }
+
+  g_object_set(worker->uridecode_, "uri", item.raw_uri_.c_str(), nullptr);
+  if (gst_element_set_state(worker->pipeline_, GST_STATE_PAUSED) == GST_STATE_CHANGE_FAILURE ||
+      !WaitAsyncDone(worker)) {
+    LOG_ERROR("preroll failed [%s]", item.uri_.c_str());
+    ReleasePipeline(worker);
+    return false;
+  }
+
+  // same position as ThumbnailPipeline::Extract()
+  gint64 duration = -1;
+  gint64 position = 1 * GST_SECOND;
+  if (gst_element_query_duration(worker->pipeline_, GST_FORMAT_TIME, &duration) && duration > 0)
+    position = duration * 5 / 100;
+  result->duration_ = duration;
+
+  GstSample* sample = nullptr;
+  if (Conf::GetFeatures(SUPPORT_THUMBNAIL_KEYFRAME)) {
+    sample = ThumbnailFrameSelector::Capture(worker->pipeline_, worker->sink_,
+                                             Conf::GetSpec(THUMBNAIL_POSITION),
+                                             (gint)g_ascii_strtoll(Conf::GetThumbnail(THUMBNAIL_WIDTH),
+                                                                   nullptr, 10));
+    if (!sample) {
+      LOG_ERROR("no keyframe captured [%s]", item.uri_.c_str());
+      ReleasePipeline(worker);
+      return false;
+    }
+    return Save(sample, item, result);
+  }
+
+  gboolean seekable = FALSE;
+  GstQuery* query = gst_query_new_seeking(GST_FORMAT_TIME);
+  if (gst_element_query(worker->pipeline_, query))
+    gst_query_parse_seeking(query, nullptr, &seekable, nullptr, nullptr);
+  gst_query_unref(query);
+  if (seekable) {
+    if (!gst_element_seek_simple(worker->pipeline_, GST_FORMAT_TIME,
+                                 (GstSeekFlags)(GST_SEEK_FLAG_FLUSH | GST_SEEK_FLAG_KEY_UNIT), position) ||
+        !WaitAsyncDone(worker)) {
+      LOG_ERROR("seek failed [%s]", item.uri_.c_str());
+      ReleasePipeline(worker);
+      return false;
+    }
+  }
+
+  g_signal_emit_by_name(worker->sink_, "pull-preroll", &sample, nullptr);
+  if (!sample) {
+    LOG_ERROR("no preroll sample [%s]", item.uri_.c_str());
+    return false;
+  }
+  return Save(sample, item, result);
+}
+
+bool ThumbnailBatch::Save(GstSample* sample, const ThumbnailItem& item, Result* result) {
+  // RGB from the NVIDIA and the videoscale sinks passes through
+  gint width = (gint)g_ascii_strtoll(Conf::GetThumbnail(THUMBNAIL_WIDTH), nullptr, 10);
+  sample = ThumbnailScaler::ToRgb(sample, width);
+  if (!sample)
+    return false;
+  bool ret = ThumbnailEncoder::EncodeToFile(sample, Conf::GetThumbnail(THUMBNAIL_FORMAT),
+                                            result->path_.c_str());
+  gst_sample_unref(sample);
+
+  gchar* contents = nullptr;
+  gsize length = 0;
+  if (ret && !result->cache_key_.empty() &&
+      g_file_get_contents(result->path_.c_str(), &contents, &length, nullptr)) {
+    ThumbnailCache::Instance()->Insert(result->cache_key_, (const guint8*)contents, length, result->duration_);
+    g_free(contents);
+  }
+  return ret;
+}
+
+std::string ThumbnailBatch::OutputPath(const ThumbnailItem& item) {
+  std::string filename = item.filename_;
+  if (filename.empty()) {
+    gchar* base = g_path_get_basename(item.raw_uri_.c_str());
+    filename = base;
+    g_free(base);
+  }
+  return std::string(Conf::GetThumbnail(THUMBNAIL_PATH)) + filename + "." +
+         Conf::GetThumbnail(THUMBNAIL_FORMAT);
+}
+
+bool ThumbnailBatch::BuildPipeline(Worker* worker) {
+  gchar* descr = nullptr;
+  GError* error = nullptr;
+#if defined(PLATFORM_NVIDIA)
+  descr = g_strdup_printf("nvmediasurfmixer name=convert ! videoconvert ! videoscale ! "
+                          "appsink name=sink caps=\"video/x-raw,format=RGB,width=%s,height=90\"",
+                          Conf::GetThumbnail(THUMBNAIL_WIDTH));
+#else
+  if (Conf::GetFeatures(SUPPORT_THUMBNAIL_SCALER))
+    descr = g_strdup_printf("videoconvert name=convert ! videoscale ! appsink name=sink caps=\"%s\"",
+                            ThumbnailScaler::kSinkCaps);
+  else
+    descr = g_strdup_printf("videoconvert name=convert ! videoscale ! "
+                            "appsink name=sink caps=\"video/x-raw,format=RGB,width=%s,pixel-aspect-ratio=1/1\"",
+                            Conf::GetThumbnail(THUMBNAIL_WIDTH));
+#endif
+  // gst_parse_launch links a sometimes pad only once, so uridecodebin is linked by hand to survive READY
+  worker->pipeline_ = gst_parse_launch(descr, &error);
+  g_free(descr);
+  if (error) {
+    LOG_ERROR("could not construct pipeline: %s", error->message);
+    g_error_free(error);
+    if (worker->pipeline_)
+      gst_object_unref(worker->pipeline_);
+    worker->pipeline_ = nullptr;
+    return false;
+  }
+
+  worker->uridecode_ = gst_element_factory_make("uridecodebin", "uridecode");
+  if (!worker->uridecode_) {
+    LOG_ERROR("could not create uridecodebin");
+    gst_object_unref(worker->pipeline_);
+    worker->pipeline_ = nullptr;
+    return false;
+  }
+  gst_bin_add(GST_BIN(worker->pipeline_), worker->uridecode_);
+#if !defined(PLATFORM_NVIDIA)
+  // decoders are plugged again for every file, the handler stays with the pipeline
+  if (Conf::GetFeatures(SUPPORT_THUMBNAIL_SCALER)) {
+    gint width = (gint)g_ascii_strtoll(Conf::GetThumbnail(THUMBNAIL_WIDTH), nullptr, 10);
+    ThumbnailScaler::RequestDecoderScaling(worker->pipeline_, width);
+  }
+#endif
+  worker->convert_ = gst_bin_get_by_name(GST_BIN(worker->pipeline_), "convert");
+  worker->sink_ = gst_bin_get_by_name(GST_BIN(worker->pipeline_), "sink");
+
+  g_signal_connect(worker->uridecode_, "pad-added", G_CALLBACK(PadAddedFunc), worker);
+  g_signal_connect(worker->uridecode_, "no-more-pads", G_CALLBACK(NoMorePadsFunc), worker);
+  g_signal_connect(worker->uridecode_, "autoplug-select", G_CALLBACK(AutoplugSelectFunc), worker);
+  return true;
+}
+
+void ThumbnailBatch::ReleasePipeline(Worker* worker) {
+  if (!worker->pipeline_)
+    return;
+  gst_element_set_state(worker->pipeline_, GST_STATE_NULL);
+  if (worker->convert_)
+    gst_object_unref(worker->convert_);
+  if (worker->sink_)
+    gst_object_unref(worker->sink_);
+  gst_object_unref(worker->pipeline_);
+  worker->pipeline_ = nullptr;
+  worker->uridecode_ = nullptr;
+  worker->convert_ = nullptr;
+  worker->sink_ = nullptr;
+}
+
+bool ThumbnailBatch::WaitAsyncDone(Worker* worker) {
+  GstBus* bus = gst_element_get_bus(worker->pipeline_);
+  gint64 deadline = g_get_monotonic_time() + kPrerollTimeout;
+  bool ret = false;
+
+  // short slices keep Cancel() responsive while a file is prerolling
+  while (!IsCancelled(worker->generation_) && g_get_monotonic_time() < deadline) {
+    GstMessage* message = gst_bus_timed_pop_filtered(bus, 100 * GST_MSECOND,
+        (GstMessageType)(GST_MESSAGE_ASYNC_DONE | GST_MESSAGE_ERROR | GST_MESSAGE_APPLICATION));
+    if (!message)
+      continue;
+
+    GstMessageType type = GST_MESSAGE_TYPE(message);
+    if (type == GST_MESSAGE_ERROR) {
+      GError* err = nullptr;
+      gst_message_parse_error(message, &err, nullptr);
+      LOG_ERROR("GST_MESSAGE_ERROR from %s : %s", GST_MESSAGE_SRC_NAME(message), err->message);
+      g_error_free(err);
+    } else if (type == GST_MESSAGE_APPLICATION) {
+      if (!gst_structure_has_name(gst_message_get_structure(message), kNoVideoMessage)) {
+        gst_message_unref(message);
+        continue;
+      }
+      LOG_ERROR("No Video");
+    } else {
+      ret = true;
+    }
+    gst_message_unref(message);
+    break;
+  }
+  gst_object_unref(bus);
+  return ret;
+}
+
+bool ThumbnailBatch::IsCancelled(guint generation) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return generation != generation_;
+}
+
+void ThumbnailBatch::Post(Result* result) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  PostLocked(result);
+}
+
+void ThumbnailBatch::PostLocked(Result* result) {
+  if (result->generation_ != generation_) {
+    delete result;
+    return;
+  }
+  result->source_id_ = g_idle_add_full(G_PRIORITY_DEFAULT_IDLE, DispatchCallbackFunc, result, FreeResult);
+  source_ids_.insert(result->source_id_);
+}
+
+void ThumbnailBatch::PadAddedFunc(GstElement* element, GstPad* pad, gpointer data) {
+  Worker* worker = reinterpret_cast<Worker*>(data);
+  GstCaps* caps = gst_pad_get_current_caps(pad);
+  if (!caps)
+    caps = gst_pad_query_caps(pad, nullptr);
+  const gchar* name = (caps && !gst_caps_is_empty(caps)) ?
+      gst_structure_get_name(gst_caps_get_structure(caps, 0)) : "";
+
+  GstPad* sink = gst_element_get_static_pad(worker->convert_, "sink");
+  if (g_str_has_prefix(name, "video/") && !gst_pad_is_linked(sink)) {
+    if (GST_PAD_LINK_FAILED(gst_pad_link(pad, sink)))
+      LOG_ERROR("could not link %s", GST_PAD_NAME(pad));
+  }
+  gst_object_unref(sink);
+  if (caps)
+    gst_caps_unref(caps);
+}
+
+void ThumbnailBatch::NoMorePadsFunc(GstElement* element, gpointer data) {
+  Worker* worker = reinterpret_cast<Worker*>(data);
+  GstPad* sink = gst_element_get_static_pad(worker->convert_, "sink");
+  // without a video pad the appsink never prerolls, end the wait instead of running into the timeout
+  if (!gst_pad_is_linked(sink)) {
+    gst_element_post_message(element,
+        gst_message_new_application(GST_OBJECT(element), gst_structure_new_empty(kNoVideoMessage)));
+  }
+  gst_object_unref(sink);
+}
+
+int ThumbnailBatch::AutoplugSelectFunc(GstElement* bin, GstPad* pad, GstCaps* caps,
+                                       GstElementFactory* factory, gpointer data) {
+  return AutoplugPolicy::Instance()->Select("thumbnail_pipeline", caps, factory);
+}
+
+gboolean ThumbnailBatch::DispatchCallbackFunc(gpointer data) {
+  using boost::property_tree::ptree;
+  Result* result = reinterpret_cast<Result*>(data);
+  ThumbnailBatch* batch = result->batch_;
+  ThumbnailBatchCallback callback;
+  ptree tree;
+  {
+    std::unique_lock<std::mutex> lock(batch->mutex_);
+    batch->source_ids_.erase(result->source_id_);
+    if (result->generation_ != batch->generation_)
+      return G_SOURCE_REMOVE;
+    callback = batch->callback_;
+
+    if (result->done_) {
+      ptree done;
+      gint64 total = g_get_monotonic_time() - batch->start_time_us_;
+      done.put("count", batch->items_.size());
+      done.put("succeeded", batch->succeeded_);
+      done.put("workers", batch->worker_count_);
+      done.put("total_us", total);
+      gdouble per_second = total > 0 ? (gdouble)batch->items_.size() * G_USEC_PER_SEC / total : 0.0;
+      done.put("per_second", per_second);
+      tree.add_child("ThumbnailBatchDone", done);
+      LOG_INFO("%u/%u thumbnails on %u workers in [%lld]us, avg [%lld]us per item, %.1f thumbnails/s",
+               batch->succeeded_, (guint)batch->items_.size(), batch->worker_count_, total,
+               total / (gint64)batch->items_.size(), per_second);
+      // the workers are leaving Run() on their own
+      batch->worker_count_ = 0;
+    } else {
+      if (result->success_)
+        batch->succeeded_++;
+      ptree item;
+      item.put("index", result->index_);
+      item.put("uri", result->uri_);
+      item.put("path", result->path_);
+      item.put("duration", result->duration_);
+      item.put("elapsed_us", result->elapsed_us_);
+      item.put("reused", result->reused_);
+      item.put("cached", result->cached_);
+      item.put("cache_key", result->cache_key_);
+      item.put("result", result->success_);
+      tree.add_child("ThumbnailBatch", item);
+    }
+  }
+
+  std::stringstream stream;
+  boost::property_tree::write_json(stream, tree, false);
+  if (callback)
+    callback(stream.str());
+  return G_SOURCE_REMOVE;
+}
+
+void ThumbnailBatch::FreeResult(gpointer data) {
+  delete reinterpret_cast<Result*>(data);
+}
+
+}  // namespace genivimedia
@@ -0,0 +1,136 @@
+// @@@LICENSE
+//
+// Copyright (C) 2023, LG Electronics, All Right Reserved.
+//
+// No part of this source code may be communicated, distributed, reproduced
+// or transmitted in any form or by any means, electronic or mechanical or
+// otherwise, for any purpose, without the prior written permission of
+// LG Electronics.
+//
+// LICENSE@@@
+
+#ifndef GENIVIMEDIA_THUMBNAIL_BATCH_H
+#define GENIVIMEDIA_THUMBNAIL_BATCH_H
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <glib.h>
+#include <gst/gst.h>
+
+namespace genivimedia {
+
+typedef std::function<void(const std::string& json)> ThumbnailBatchCallback;
+
+struct ThumbnailItem {
+  std::string uri_;       /**< uri as given by the client, reported back */
+  std::string raw_uri_;   /**< uri set on uridecodebin */
+  std::string filename_;  /**< output name without path and extension */
+};
+
+/**
+ * @class      genivimedia::ThumbnailBatch
+ * @brief      Extracts thumbnails of a list of files on a pool of worker threads.
+ * @details    One worker per core, at most one per item. Each worker builds its
+ *             uridecodebin ! videoconvert ! videoscale ! appsink pipeline once and switches the uri in
+ *             READY for the next item, so typefind, the demuxer and the decoder are the only per file
+ *             cost, and a file found in ThumbnailCache costs none of it. Workers drive their pipeline
+ *             synchronously from their own bus, nothing runs on the main context except the result dispatch.
+ *             Every item is reported from the main context as
+ *             {"ThumbnailBatch":{"index":N,"uri":...,"path":...,"duration":N,"elapsed_us":N,"reused":bool,"cached":bool,"cache_key":...,"result":bool}}
+ *             and the batch ends with {"ThumbnailBatchDone":{"count":N,"succeeded":N,"workers":N,"total_us":N,"per_second":N}}.
+ *             A pipeline that failed is dropped and rebuilt for the next item of that worker.
+ *             Workers are detached and belong to the generation they were started for: Start() and
+ *             Cancel() only move to a new generation, a stale worker stops after its current item
+ *             and its results are dropped, so nothing on the main context waits for a decoder.
+ *             Only the destructor waits for the workers still alive.
+ * @see        genivimedia::ThumbnailPipeline
+ */
+class ThumbnailBatch {
+ public:
+  explicit ThumbnailBatch(ThumbnailBatchCallback callback);
+  ~ThumbnailBatch();
+
+  /**
+   * @fn Start
+   * @brief Cancels the running batch and starts extracting the given items.
+   * @param[in] items : files to extract, reported by their index in this list
+   * @return bool (TRUE - started, FALSE - empty list)
+   */
+  bool Start(const std::vector<ThumbnailItem>& items);
+
+  /**
+   * @fn Cancel
+   * @brief Stops the workers after their current item and drops the results not yet reported.
+   * @details Does not wait for the workers.
+   */
+  void Cancel();
+
+  bool IsRunning();
+
+ private:
+  static const gint64 kPrerollTimeout = 10 * G_USEC_PER_SEC;
+
+  struct Worker {
+    guint generation_;
+    GstElement* pipeline_;
+    GstElement* uridecode_;
+    GstElement* convert_;
+    GstElement* sink_;
+  };
+
+  struct Result {
+    ThumbnailBatch* batch_;
+    guint generation_;
+    guint source_id_;
+    bool done_;
+    guint index_;
+    std::string uri_;
+    std::string path_;
+    gint64 duration_;
+    gint64 elapsed_us_;
+    bool reused_;
+    bool cached_;           /**< served from ThumbnailCache, no pipeline involved */
+    std::string cache_key_;  /**< reported so the client can refer to the cache entry, empty without one */
+    bool success_;
+  };
+
+  void Run(Worker* worker);
+  bool Extract(Worker* worker, const ThumbnailItem& item, Result* result);
+  bool Save(GstSample* sample, const ThumbnailItem& item, Result* result);
+  std::string OutputPath(const ThumbnailItem& item);
+  bool BuildPipeline(Worker* worker);
+  void ReleasePipeline(Worker* worker);
+  bool WaitAsyncDone(Worker* worker);
+  bool IsCancelled(guint generation);
+  void Post(Result* result);
+  void PostLocked(Result* result);
+
+  static void PadAddedFunc(GstElement* element, GstPad* pad, gpointer data);
+  static void NoMorePadsFunc(GstElement* element, gpointer data);
+  static int AutoplugSelectFunc(GstElement* bin, GstPad* pad, GstCaps* caps,
+                                GstElementFactory* factory, gpointer data);
+  static gboolean DispatchCallbackFunc(gpointer data);
+  static void FreeResult(gpointer data);
+
+  std::mutex mutex_;
+  ThumbnailBatchCallback callback_;
+  std::vector<ThumbnailItem> items_;
+  std::set<guint> source_ids_;
+  std::condition_variable idle_;
+  guint worker_count_;      /**< workers of the current generation, 0 when none is running */
+  guint live_workers_;      /**< workers of any generation that have not left Run() */
+  guint next_item_;
+  guint finished_workers_;
+  guint succeeded_;
+  guint generation_;
+  gint64 start_time_us_;
+};
+
+}  // namespace genivimedia
+
+#endif  // GENIVIMEDIA_THUMBNAIL_BATCH_H
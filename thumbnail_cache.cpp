@@ -0,0 +1,519 @@
+// @@@LICENSE
+//
+// Copyright (C) 2023, LG Electronics, All Right Reserved.
+//
+// No part of this source code may be communicated, distributed, reproduced
+// or transmitted in any form or by any means, electronic or mechanical or
+// otherwise, for any purpose, without the prior written permission of
+// LG Electronics.
+//
+// LICENSE@@@
+
+#include "player/pipeline/thumbnail_cache.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <zlib.h>
+
+#include "logger/player_logger.h"
+#include "player/pipeline/conf.h"
+
+namespace genivimedia {
+
+namespace {
+
+const guint32 kIndexMagic = 0x49435447;   // "GTCI"
+const guint32 kRecordMagic = 0x52435447;  // "GTCR"
+const guint32 kIndexVersion = 1;
+
+enum SlotState {
+  SLOT_EMPTY = 0,
+  SLOT_USED,
+  SLOT_TOMBSTONE
+};
+
+bool ReadFull(int fd, void* buffer, gsize size, off_t offset) {
+  guint8* data = reinterpret_cast<guint8*>(buffer);
+  while (size > 0) {
+    ssize_t count = pread(fd, data, size, offset);
+    if (count < 0 && errno == EINTR)
+      continue;
+    if (count <= 0)
+      return false;
+    data += count;
+    size -= count;
+    offset += count;
+  }
+  return true;
+}
+
+}  // namespace
+
+ThumbnailCache* ThumbnailCache::instance_ = nullptr;
+
+ThumbnailCache* ThumbnailCache::Instance() {
+  if (instance_ == nullptr) {
+    instance_ = new ThumbnailCache();
+  }
+  return instance_;
+}
+
+void ThumbnailCache::Destroy() {
+  if (instance_) {
+    delete instance_;
+    instance_ = nullptr;
+  }
+}
+
+ThumbnailCache::ThumbnailCache()
+  : mutex_(),
+    dir_(),
+    budget_bytes_(0),
+    segment_bytes_(kSegmentBytes),
+    index_fd_(-1),
+    header_(nullptr),
+    slots_(nullptr),
+    map_size_(0),
+    segments_(),
+    hits_(0),
+    misses_(0) {
+}
+
+ThumbnailCache::~ThumbnailCache() {
+  Close();
+}
+
+bool ThumbnailCache::Open(const gchar* dir, guint budget_mb) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  Close();
+  if (!dir || !strlen(dir))
+    return false;
+  if (g_mkdir_with_parents(dir, 0755) < 0) {
+    LOG_ERROR("cannot create %s: %s", dir, strerror(errno));
+    return false;
+  }
+  dir_ = dir;
+  budget_bytes_ = (guint64)(budget_mb ? budget_mb : kDefaultBudgetMb) * 1024 * 1024;
+  // small budgets need small segments, or Compact() has no old segment to give back
+  segment_bytes_ = (guint32)MIN((guint64)kSegmentBytes, budget_bytes_ / 4);
+
+  GDir* handle = g_dir_open(dir, 0, nullptr);
+  const gchar* name = nullptr;
+  while (handle && (name = g_dir_read_name(handle))) {
+    guint32 segment = 0;
+    char suffix[8] = {0};
+    struct stat st;
+    if (sscanf(name, "%8x.%3s", &segment, suffix) == 2 && strcmp(suffix, "seg") == 0 &&
+        stat(SegmentPath(segment).c_str(), &st) == 0)
+      segments_[segment] = st.st_size;
+  }
+  if (handle)
+    g_dir_close(handle);
+
+  bool created = false;
+  if (!MapIndex(&created)) {
+    Close();
+    return false;
+  }
+
+  // a new or damaged index is refilled from the records, the newest segment loses a torn tail
+  for (auto& segment : segments_) {
+    if (!created && segment.first != segments_.rbegin()->first)
+      continue;
+    guint32 end = ScanSegment(segment.first, created);
+    if (end < segment.second) {
+      LOG_INFO("truncate %s from %llu to %u", SegmentPath(segment.first).c_str(),
+               (unsigned long long)segment.second, end);
+      if (truncate(SegmentPath(segment.first).c_str(), end) == 0)
+        segment.second = end;
+    }
+  }
+  if (!segments_.empty() && header_->segment_ < segments_.rbegin()->first)
+    header_->segment_ = segments_.rbegin()->first;
+  // a rebuild also brings back records evicted before, or the budget may have shrunk
+  EvictFor(0);
+  Compact();
+
+  LOG_INFO("%s: %u entries, %llu/%llu bytes, %u segments%s", dir, header_->used_,
+           (unsigned long long)header_->live_bytes_, (unsigned long long)budget_bytes_,
+           (guint)segments_.size(), created ? " (index rebuilt)" : "");
+  return true;
+}
+
+bool ThumbnailCache::IsOpen() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return header_ != nullptr;
+}
+
+bool ThumbnailCache::MakeKey(const std::string& path, const gchar* format, std::string* key) {
+  std::string local = path;
+  if (g_str_has_prefix(path.c_str(), "file://")) {
+    gchar* filename = g_filename_from_uri(path.c_str(), nullptr, nullptr);
+    if (!filename)
+      return false;
+    local = filename;
+    g_free(filename);
+  }
+
+  struct stat st;
+  if (stat(local.c_str(), &st) < 0)
+    return false;
+
+  guint64 size = st.st_size;
+  gint64 mtime_sec = st.st_mtim.tv_sec;
+  gint64 mtime_nsec = st.st_mtim.tv_nsec;
+  GChecksum* checksum = g_checksum_new(G_CHECKSUM_SHA256);
+  g_checksum_update(checksum, (const guchar*)local.c_str(), local.size() + 1);
+  g_checksum_update(checksum, (const guchar*)&size, sizeof(size));
+  g_checksum_update(checksum, (const guchar*)&mtime_sec, sizeof(mtime_sec));
+  g_checksum_update(checksum, (const guchar*)&mtime_nsec, sizeof(mtime_nsec));
+  g_checksum_update(checksum, (const guchar*)(format ? format : ""), -1);
+  // the same file gives another image with another width, scaler or frame selection
+  gchar* variant = g_strdup_printf("|%s|%d|%d|%d", Conf::GetThumbnail(THUMBNAIL_WIDTH),
+                                   Conf::GetFeatures(SUPPORT_THUMBNAIL_SCALER) ? 1 : 0,
+                                   Conf::GetFeatures(SUPPORT_THUMBNAIL_KEYFRAME) ? 1 : 0,
+                                   Conf::GetFeatures(SUPPORT_THUMBNAIL_KEYFRAME) ?
+                                       Conf::GetSpec(THUMBNAIL_POSITION) : 0);
+  g_checksum_update(checksum, (const guchar*)variant, -1);
+  g_free(variant);
+
+  // the first 128 bits of the digest are the key
+  guint8 digest[32];
+  gsize length = sizeof(digest);
+  g_checksum_get_digest(checksum, digest, &length);
+  g_checksum_free(checksum);
+
+  static const char kHex[] = "0123456789abcdef";
+  key->clear();
+  for (int i = 0; i < 16; i++) {
+    key->push_back(kHex[digest[i] >> 4]);
+    key->push_back(kHex[digest[i] & 0xf]);
+  }
+  return true;
+}
+
+bool ThumbnailCache::Lookup(const std::string& key, std::vector<guint8>* data, gint64* duration) {
+  guint8 bytes[16];
+  if (!ParseKey(key, bytes))
+    return false;
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!header_)
+    return false;
+  Slot* slot = FindSlot(bytes, false);
+  if (!slot) {
+    misses_++;
+    return false;
+  }
+  if (!ReadRecord(slot, data)) {
+    LOG_ERROR("drop damaged entry %s", key.c_str());
+    RemoveSlot(slot);
+    misses_++;
+    return false;
+  }
+  slot->last_used_ = ++header_->clock_;
+  if (duration)
+    *duration = slot->duration_;
+  hits_++;
+  return true;
+}
+
+bool ThumbnailCache::Insert(const std::string& key, const guint8* data, gsize size, gint64 duration) {
+  guint8 bytes[16];
+  if (!data || !size || !ParseKey(key, bytes))
+    return false;
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!header_ || size > budget_bytes_ || size + sizeof(RecordHeader) > segment_bytes_)
+    return false;
+
+  EvictFor(size);
+  guint32 segment = 0;
+  guint32 offset = 0;
+  if (!Append(bytes, data, size, duration, &segment, &offset))
+    return false;
+  PutSlot(bytes, segment, offset, size, duration);
+  Compact();
+  return true;
+}
+
+void ThumbnailCache::Close() {
+  if (header_) {
+    LOG_INFO("hits=[%u] misses=[%u]", hits_, misses_);
+    munmap(header_, map_size_);
+  }
+  if (index_fd_ >= 0)
+    close(index_fd_);
+  index_fd_ = -1;
+  header_ = nullptr;
+  slots_ = nullptr;
+  map_size_ = 0;
+  segments_.clear();
+}
+
+bool ThumbnailCache::MapIndex(bool* created) {
+  std::string path = dir_ + "/index";
+  index_fd_ = open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+  if (index_fd_ < 0) {
+    LOG_ERROR("cannot open %s: %s", path.c_str(), strerror(errno));
+    return false;
+  }
+
+  struct stat st;
+  map_size_ = sizeof(IndexHeader) + (gsize)kSlotCount * sizeof(Slot);
+  *created = (fstat(index_fd_, &st) < 0 || (gsize)st.st_size != map_size_);
+  if (*created && (ftruncate(index_fd_, 0) < 0 || ftruncate(index_fd_, map_size_) < 0)) {
+    LOG_ERROR("cannot size %s: %s", path.c_str(), strerror(errno));
+    return false;
+  }
+
+  void* map = mmap(nullptr, map_size_, PROT_READ | PROT_WRITE, MAP_SHARED, index_fd_, 0);
+  if (map == MAP_FAILED) {
+    LOG_ERROR("cannot map %s: %s", path.c_str(), strerror(errno));
+    header_ = nullptr;
+    return false;
+  }
+  header_ = reinterpret_cast<IndexHeader*>(map);
+  slots_ = reinterpret_cast<Slot*>(header_ + 1);
+
+  if (!*created && (header_->magic_ != kIndexMagic || header_->version_ != kIndexVersion ||
+                    header_->slot_count_ != kSlotCount)) {
+    LOG_ERROR("%s is damaged", path.c_str());
+    *created = true;
+  }
+  if (*created) {
+    memset(map, 0, map_size_);
+    header_->magic_ = kIndexMagic;
+    header_->version_ = kIndexVersion;
+    header_->slot_count_ = kSlotCount;
+  }
+  return true;
+}
+
+guint32 ThumbnailCache::ScanSegment(guint32 segment, bool insert) {
+  int fd = open(SegmentPath(segment).c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0)
+    return 0;
+
+  guint64 file_size = segments_[segment];
+  guint32 offset = 0;
+  std::vector<guint8> payload;
+  RecordHeader record;
+  while (offset + sizeof(record) <= file_size) {
+    if (!ReadFull(fd, &record, sizeof(record), offset) || record.magic_ != kRecordMagic ||
+        offset + sizeof(record) + record.size_ > file_size)
+      break;
+    payload.resize(record.size_);
+    if (!ReadFull(fd, payload.data(), record.size_, offset + sizeof(record)) ||
+        crc32(0, payload.data(), record.size_) != record.crc_)
+      break;
+    // later records of a key replace earlier ones
+    if (insert)
+      PutSlot(record.key_, segment, offset, record.size_, record.duration_);
+    offset += sizeof(record) + record.size_;
+  }
+  close(fd);
+  return offset;
+}
+
+ThumbnailCache::Slot* ThumbnailCache::FindSlot(const guint8* key, bool for_insert) {
+  guint32 hash = 0;
+  memcpy(&hash, key, sizeof(hash));
+  Slot* tombstone = nullptr;
+  for (guint32 probe = 0; probe < kSlotCount; probe++) {
+    Slot* slot = &slots_[(hash + probe) & (kSlotCount - 1)];
+    if (slot->state_ == SLOT_EMPTY)
+      return for_insert ? (tombstone ? tombstone : slot) : nullptr;
+    if (slot->state_ == SLOT_TOMBSTONE) {
+      if (!tombstone)
+        tombstone = slot;
+    } else if (memcmp(slot->key_, key, sizeof(slot->key_)) == 0) {
+      return slot;
+    }
+  }
+  return for_insert ? tombstone : nullptr;
+}
+
+void ThumbnailCache::PutSlot(const guint8* key, guint32 segment, guint32 offset, guint32 size,
+                             gint64 duration) {
+  Slot* slot = FindSlot(key, false);
+  if (slot) {
+    header_->live_bytes_ -= slot->size_;
+  } else {
+    RehashIfNeeded();
+    slot = FindSlot(key, true);
+    if (!slot) {
+      LOG_ERROR("index is full");
+      return;
+    }
+    if (slot->state_ == SLOT_TOMBSTONE)
+      header_->tombstones_--;
+    header_->used_++;
+    memcpy(slot->key_, key, sizeof(slot->key_));
+  }
+  slot->segment_ = segment;
+  slot->offset_ = offset;
+  slot->size_ = size;
+  slot->duration_ = duration;
+  slot->last_used_ = ++header_->clock_;
+  slot->state_ = SLOT_USED;
+  header_->live_bytes_ += size;
+}
+
+void ThumbnailCache::RemoveSlot(Slot* slot) {
+  slot->state_ = SLOT_TOMBSTONE;
+  header_->used_--;
+  header_->tombstones_++;
+  header_->live_bytes_ -= slot->size_;
+}
+
+bool ThumbnailCache::Append(const guint8* key, const guint8* data, gsize size, gint64 duration,
+                            guint32* segment, guint32* offset) {
+  guint32 current = header_->segment_;
+  guint64 end = segments_.count(current) ? segments_[current] : 0;
+  if (end > 0 && end + sizeof(RecordHeader) + size > segment_bytes_) {
+    current++;
+    end = 0;
+  }
+
+  int fd = open(SegmentPath(current).c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+  if (fd < 0) {
+    LOG_ERROR("cannot open %s: %s", SegmentPath(current).c_str(), strerror(errno));
+    return false;
+  }
+
+  RecordHeader record;
+  memset(&record, 0, sizeof(record));
+  record.magic_ = kRecordMagic;
+  record.size_ = size;
+  memcpy(record.key_, key, sizeof(record.key_));
+  record.duration_ = duration;
+  record.crc_ = crc32(0, data, size);
+  struct iovec vector[2] = {
+    { &record, sizeof(record) },
+    { const_cast<guint8*>(data), size }
+  };
+  // no fsync: the index may reach the disk first, a hit re-checks the record and turns it into a miss
+  ssize_t written = writev(fd, vector, 2);
+  if (written != (ssize_t)(sizeof(record) + size)) {
+    LOG_ERROR("short write to %s", SegmentPath(current).c_str());
+    if (ftruncate(fd, end) < 0)
+      LOG_ERROR("cannot truncate %s", SegmentPath(current).c_str());
+    close(fd);
+    return false;
+  }
+  close(fd);
+
+  header_->segment_ = current;
+  segments_[current] = end + written;
+  *segment = current;
+  *offset = (guint32)end;
+  return true;
+}
+
+bool ThumbnailCache::ReadRecord(const Slot* slot, std::vector<guint8>* data) {
+  int fd = open(SegmentPath(slot->segment_).c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0)
+    return false;
+
+  RecordHeader record;
+  bool ret = ReadFull(fd, &record, sizeof(record), slot->offset_) && record.magic_ == kRecordMagic &&
+             record.size_ == slot->size_ && memcmp(record.key_, slot->key_, sizeof(record.key_)) == 0;
+  if (ret) {
+    data->resize(record.size_);
+    ret = ReadFull(fd, data->data(), record.size_, slot->offset_ + sizeof(record)) &&
+          crc32(0, data->data(), record.size_) == record.crc_;
+  }
+  close(fd);
+  return ret;
+}
+
+void ThumbnailCache::EvictFor(gsize size) {
+  while (header_->used_ > 0 &&
+         (header_->live_bytes_ + size > budget_bytes_ || header_->used_ >= kSlotCount * 3 / 4)) {
+    Slot* oldest = nullptr;
+    for (guint32 i = 0; i < kSlotCount; i++) {
+      if (slots_[i].state_ == SLOT_USED && (!oldest || slots_[i].last_used_ < oldest->last_used_))
+        oldest = &slots_[i];
+    }
+    if (!oldest)
+      break;
+    RemoveSlot(oldest);
+  }
+}
+
+void ThumbnailCache::Compact() {
+  guint64 disk_bytes = 0;
+  for (const auto& segment : segments_)
+    disk_bytes += segment.second;
+
+  std::vector<guint8> data;
+  while (disk_bytes > 2 * budget_bytes_ && segments_.size() > 1) {
+    guint32 oldest = segments_.begin()->first;
+    if (oldest == header_->segment_)
+      break;
+    guint moved = 0;
+    for (guint32 i = 0; i < kSlotCount; i++) {
+      Slot* slot = &slots_[i];
+      if (slot->state_ != SLOT_USED || slot->segment_ != oldest)
+        continue;
+      guint32 segment = 0;
+      guint32 offset = 0;
+      if (ReadRecord(slot, &data) &&
+          Append(slot->key_, data.data(), data.size(), slot->duration_, &segment, &offset)) {
+        slot->segment_ = segment;
+        slot->offset_ = offset;
+        disk_bytes += sizeof(RecordHeader) + data.size();
+        moved++;
+      } else {
+        RemoveSlot(slot);
+      }
+    }
+    disk_bytes -= segments_[oldest];
+    unlink(SegmentPath(oldest).c_str());
+    segments_.erase(oldest);
+    LOG_INFO("segment %08x removed, %u entries moved", oldest, moved);
+  }
+}
+
+void ThumbnailCache::RehashIfNeeded() {
+  if (header_->tombstones_ < kSlotCount / 4)
+    return;
+  std::vector<Slot> used;
+  for (guint32 i = 0; i < kSlotCount; i++) {
+    if (slots_[i].state_ == SLOT_USED)
+      used.push_back(slots_[i]);
+  }
+  memset(slots_, 0, (gsize)kSlotCount * sizeof(Slot));
+  header_->tombstones_ = 0;
+  for (const Slot& entry : used)
+    *FindSlot(entry.key_, true) = entry;
+}
+
+std::string ThumbnailCache::SegmentPath(guint32 segment) {
+  gchar* name = g_strdup_printf("%s/%08x.seg", dir_.c_str(), segment);
+  std::string path(name);
+  g_free(name);
+  return path;
+}
+
+bool ThumbnailCache::ParseKey(const std::string& key, guint8* bytes) {
+  if (key.size() != 32)
+    return false;
+  for (int i = 0; i < 16; i++) {
+    int high = g_ascii_xdigit_value(key[2 * i]);
+    int low = g_ascii_xdigit_value(key[2 * i + 1]);
+    if (high < 0 || low < 0)
+      return false;
+    bytes[i] = (guint8)((high << 4) | low);
+  }
+  return true;
+}
+
+}  // namespace genivimedia
@@ -0,0 +1,143 @@
+// @@@LICENSE
+//
+// Copyright (C) 2023, LG Electronics, All Right Reserved.
+//
+// No part of this source code may be communicated, distributed, reproduced
+// or transmitted in any form or by any means, electronic or mechanical or
+// otherwise, for any purpose, without the prior written permission of
+// LG Electronics.
+//
+// LICENSE@@@
+
+#ifndef GENIVIMEDIA_THUMBNAIL_CACHE_H
+#define GENIVIMEDIA_THUMBNAIL_CACHE_H
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <glib.h>
+
+namespace genivimedia {
+
+/**
+ * @class      genivimedia::ThumbnailCache
+ * @brief      Persistent cache of encoded thumbnails, keyed by a hash of path, size, mtime and format.
+ * @details    Images are appended to segment files (<dir>/XXXXXXXX.seg, at most kSegmentBytes or a quarter of the budget each) as
+ *             records carrying their key, size and CRC32; a record is never rewritten. The index
+ *             (<dir>/index) is an mmap'd open addressing table of kSlotCount slots written only after
+ *             the record is complete, and every hit is checked against the record, so a crash leaves
+ *             at worst a miss. A torn tail of the newest segment is truncated on Open(), a damaged
+ *             index is rebuilt from the segments.
+ *             Live images are kept within the budget by evicting the least recently used ones;
+ *             when the segments take twice the budget on disk, the live records of the oldest segment
+ *             are moved to the newest one and the file is removed.
+ *             The key is a 32 digit hex string, so other databases (e.g. thumbnail_db.sqlite3) can
+ *             store it and refer to an entry without knowing the layout.
+ * @see        genivimedia::ThumbnailPipeline genivimedia::ThumbnailBatch
+ */
+class ThumbnailCache {
+ public:
+  static ThumbnailCache* Instance();
+  static void Destroy();
+
+  /**
+   * @fn Open
+   * @brief Opens (or creates) the cache in the directory, an empty directory disables the cache.
+   * @param[in] dir : cache directory, created if missing
+   * @param[in] budget_mb : live image budget in MB, 0 selects kDefaultBudgetMb
+   * @return bool (TRUE - SUCCESS, FALSE - FAIL)
+   */
+  bool Open(const gchar* dir, guint budget_mb);
+
+  bool IsOpen();
+
+  /**
+   * @fn MakeKey
+   * @brief Computes the key of a local file in its current state and the current thumbnail settings.
+   * @details THUMBNAIL_WIDTH, the scaler and the keyframe selection (with its position) are part of
+   *          the key, so changing any of them misses instead of returning an image made differently.
+   * @param[in] path : local path or file:// uri
+   * @param[in] format : encoding of the cached image ("jpeg", "png")
+   * @param[out] key : 32 digit hex string
+   * @return bool (TRUE - SUCCESS, FALSE - the file cannot be stat'ed)
+   */
+  static bool MakeKey(const std::string& path, const gchar* format, std::string* key);
+
+  bool Lookup(const std::string& key, std::vector<guint8>* data, gint64* duration);
+
+  bool Insert(const std::string& key, const guint8* data, gsize size, gint64 duration);
+
+ private:
+  static const guint32 kSlotCount = 8192;
+  static const guint32 kSegmentBytes = 4 * 1024 * 1024;
+  static const guint kDefaultBudgetMb = 64;
+
+  struct IndexHeader {
+    guint32 magic_;
+    guint32 version_;
+    guint32 slot_count_;
+    guint32 used_;
+    guint32 tombstones_;
+    guint32 segment_;      /**< segment appended to */
+    guint64 live_bytes_;
+    guint64 clock_;        /**< LRU clock, incremented per hit and insert */
+    guint8 reserved_[24];
+  };
+
+  struct Slot {
+    guint8 key_[16];
+    guint32 state_;
+    guint32 segment_;
+    guint32 offset_;
+    guint32 size_;
+    gint64 duration_;
+    guint64 last_used_;
+  };
+
+  struct RecordHeader {
+    guint32 magic_;
+    guint32 size_;
+    guint8 key_[16];
+    gint64 duration_;
+    guint32 crc_;
+    guint32 reserved_;
+  };
+
+  ThumbnailCache();
+  ~ThumbnailCache();
+
+  void Close();
+  bool MapIndex(bool* created);
+  guint32 ScanSegment(guint32 segment, bool insert);
+  Slot* FindSlot(const guint8* key, bool for_insert);
+  void PutSlot(const guint8* key, guint32 segment, guint32 offset, guint32 size, gint64 duration);
+  void RemoveSlot(Slot* slot);
+  bool Append(const guint8* key, const guint8* data, gsize size, gint64 duration,
+              guint32* segment, guint32* offset);
+  bool ReadRecord(const Slot* slot, std::vector<guint8>* data);
+  void EvictFor(gsize size);
+  void Compact();
+  void RehashIfNeeded();
+  std::string SegmentPath(guint32 segment);
+  static bool ParseKey(const std::string& key, guint8* bytes);
+
+  static ThumbnailCache* instance_;
+
+  std::mutex mutex_;
+  std::string dir_;
+  guint64 budget_bytes_;
+  guint32 segment_bytes_;
+  int index_fd_;
+  IndexHeader* header_;
+  Slot* slots_;
+  gsize map_size_;
+  std::map<guint32, guint64> segments_;  /**< segment id -> file size */
+  guint hits_;
+  guint misses_;
+};
+
+}  // namespace genivimedia
+
+#endif  // GENIVIMEDIA_THUMBNAIL_CACHE_H
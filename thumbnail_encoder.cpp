@@ -0,0 +1,264 @@
+// @@@LICENSE
+//
+// Copyright (C) 2023, LG Electronics, All Right Reserved.
+//
+// No part of this source code may be communicated, distributed, reproduced
+// or transmitted in any form or by any means, electronic or mechanical or
+// otherwise, for any purpose, without the prior written permission of
+// LG Electronics.
+//
+// LICENSE@@@
+
+#include "player/pipeline/thumbnail_encoder.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <gst/video/video.h>
+#include <png.h>
+#include <turbojpeg.h>
+
+#include "logger/player_logger.h"
+
+namespace genivimedia {
+
+namespace {
+
+struct PngOutput {
+  int fd_;
+  gsize size_;
+};
+
+void PngWriteFunc(png_structp png, png_bytep data, png_size_t length) {
+  PngOutput* output = reinterpret_cast<PngOutput*>(png_get_io_ptr(png));
+  while (length > 0) {
+    ssize_t written = write(output->fd_, data, length);
+    if (written < 0) {
+      if (errno == EINTR)
+        continue;
+      png_error(png, "write failed");
+    }
+    data += written;
+    length -= written;
+    output->size_ += written;
+  }
+}
+
+void PngFlushFunc(png_structp png) {
+}
+
+// reads the size from the PNG IHDR or the JPEG frame header, nothing is decoded
+bool ReadImageSize(const guint8* data, gsize size, gint* width, gint* height) {
+  static const guint8 kPngSignature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+  if (size >= 24 && memcmp(data, kPngSignature, sizeof(kPngSignature)) == 0) {
+    *width = (gint)GST_READ_UINT32_BE(data + 16);
+    *height = (gint)GST_READ_UINT32_BE(data + 20);
+    return true;
+  }
+
+  tjhandle handle = tjInitDecompress();
+  if (!handle)
+    return false;
+  int subsampling = 0;
+  int colorspace = 0;
+  bool ret = (tjDecompressHeader3(handle, const_cast<guint8*>(data), (unsigned long)size,
+                                  width, height, &subsampling, &colorspace) == 0);
+  tjDestroy(handle);
+  return ret;
+}
+
+}  // namespace
+
+bool ThumbnailEncoder::EncodeToMemfd(GstSample* sample, const gchar* format, ThumbnailImage* image) {
+  int fd = CreateMemfd();
+  if (fd < 0)
+    return false;
+  if (!EncodeToFd(sample, format, fd, image)) {
+    close(fd);
+    return false;
+  }
+
+  Seal(fd);
+  image->fd_ = fd;
+  return true;
+}
+
+bool ThumbnailEncoder::CopyToMemfd(const guint8* data, gsize size, ThumbnailImage* image) {
+  int fd = CreateMemfd();
+  if (fd < 0)
+    return false;
+  gsize done = 0;
+  while (done < size) {
+    ssize_t written = write(fd, data + done, size - done);
+    if (written < 0) {
+      if (errno == EINTR)
+        continue;
+      LOG_ERROR("cannot write thumbnail fd: %s", strerror(errno));
+      close(fd);
+      return false;
+    }
+    done += written;
+  }
+  Seal(fd);
+  image->fd_ = fd;
+  image->size_ = size;
+  image->width_ = 0;
+  image->height_ = 0;
+  if (!ReadImageSize(data, size, &image->width_, &image->height_))
+    LOG_ERROR("cannot read the size of the cached thumbnail");
+  return true;
+}
+
+bool ThumbnailEncoder::EncodeToFile(GstSample* sample, const gchar* format, const gchar* path) {
+  int fd = open(path, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (fd < 0) {
+    LOG_ERROR("cannot open %s: %s", path, strerror(errno));
+    return false;
+  }
+  ThumbnailImage image;
+  bool ret = EncodeToFd(sample, format, fd, &image);
+  close(fd);
+  if (!ret)
+    unlink(path);
+  return ret;
+}
+
+bool ThumbnailEncoder::EncodeToFd(GstSample* sample, const gchar* format, int fd, ThumbnailImage* image) {
+  GstVideoInfo info;
+  GstCaps* caps = gst_sample_get_caps(sample);
+  GstBuffer* buffer = gst_sample_get_buffer(sample);
+  if (!caps || !buffer || !gst_video_info_from_caps(&info, caps)) {
+    LOG_ERROR("could not get snapshot format");
+    return false;
+  }
+  if (GST_VIDEO_INFO_FORMAT(&info) != GST_VIDEO_FORMAT_RGB) {
+    LOG_ERROR("unexpected snapshot format %s", gst_video_format_to_string(GST_VIDEO_INFO_FORMAT(&info)));
+    return false;
+  }
+
+  GstVideoFrame frame;
+  if (!gst_video_frame_map(&frame, &info, buffer, GST_MAP_READ)) {
+    LOG_ERROR("could not map snapshot");
+    return false;
+  }
+  const guint8* pixels = (const guint8*)GST_VIDEO_FRAME_PLANE_DATA(&frame, 0);
+  gint stride = GST_VIDEO_FRAME_PLANE_STRIDE(&frame, 0);
+  gint width = GST_VIDEO_FRAME_WIDTH(&frame);
+  gint height = GST_VIDEO_FRAME_HEIGHT(&frame);
+
+  gint64 start = g_get_monotonic_time();
+  gsize size = 0;
+  bool ret = false;
+  if (g_strcmp0(format, "png") == 0)
+    ret = EncodePng(pixels, width, height, stride, fd, &size);
+  else
+    ret = EncodeJpeg(pixels, width, height, stride, fd, &size);
+  gst_video_frame_unmap(&frame);
+
+  LOG_INFO("%s %dx%d, %" G_GSIZE_FORMAT " bytes in [%lld]us", format, width, height, size,
+           g_get_monotonic_time() - start);
+  image->fd_ = -1;
+  image->size_ = size;
+  image->width_ = width;
+  image->height_ = height;
+  return ret;
+}
+
+bool ThumbnailEncoder::EncodeJpeg(const guint8* pixels, gint width, gint height, gint stride,
+                                  int fd, gsize* size) {
+  unsigned long capacity = tjBufSize(width, height, TJSAMP_420);
+  if (ftruncate(fd, capacity) < 0) {
+    LOG_ERROR("ftruncate failed: %s", strerror(errno));
+    return false;
+  }
+  void* map = mmap(nullptr, capacity, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (map == MAP_FAILED) {
+    LOG_ERROR("mmap failed: %s", strerror(errno));
+    return false;
+  }
+
+  tjhandle handle = tjInitCompress();
+  unsigned char* output = reinterpret_cast<unsigned char*>(map);
+  unsigned long length = capacity;
+  // NOREALLOC keeps the encoder writing into the mapping, capacity is its worst case
+  bool ret = handle &&
+      tjCompress2(handle, pixels, width, stride, height, TJPF_RGB, &output, &length,
+                  TJSAMP_420, kJpegQuality, TJFLAG_NOREALLOC | TJFLAG_FASTDCT) == 0;
+  if (!ret)
+    LOG_ERROR("tjCompress2 failed: %s", handle ? tjGetErrorStr2(handle) : "no handle");
+  if (handle)
+    tjDestroy(handle);
+  munmap(map, capacity);
+
+  if (ret && ftruncate(fd, length) < 0) {
+    LOG_ERROR("ftruncate failed: %s", strerror(errno));
+    ret = false;
+  }
+  *size = ret ? length : 0;
+  return ret;
+}
+
+bool ThumbnailEncoder::EncodePng(const guint8* pixels, gint width, gint height, gint stride,
+                                 int fd, gsize* size) {
+  PngOutput output = { fd, 0 };
+  png_structp png = png_create_write_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr);
+  png_infop info = png ? png_create_info_struct(png) : nullptr;
+  if (!info) {
+    LOG_ERROR("cannot create png writer");
+    png_destroy_write_struct(&png, nullptr);
+    return false;
+  }
+  if (setjmp(png_jmpbuf(png))) {
+    LOG_ERROR("png encoding failed");
+    png_destroy_write_struct(&png, &info);
+    return false;
+  }
+
+  png_set_write_fn(png, &output, PngWriteFunc, PngFlushFunc);
+  png_set_IHDR(png, info, width, height, 8, PNG_COLOR_TYPE_RGB, PNG_INTERLACE_NONE,
+               PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
+  // a thumbnail is small, speed matters more than the last few percent of size
+  png_set_compression_level(png, kPngCompression);
+  png_write_info(png, info);
+  for (gint row = 0; row < height; row++)
+    png_write_row(png, const_cast<png_bytep>(pixels + (gsize)row * stride));
+  png_write_end(png, info);
+  png_destroy_write_struct(&png, &info);
+
+  *size = output.size_;
+  return true;
+}
+
+void ThumbnailEncoder::Seal(int fd) {
+#if defined(F_ADD_SEALS)
+  // the client maps what it received, nobody may resize or rewrite it afterwards
+  if (fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL) < 0)
+    LOG_DEBUG("cannot seal thumbnail fd: %s", strerror(errno));
+#endif
+  lseek(fd, 0, SEEK_SET);
+}
+
+int ThumbnailEncoder::CreateMemfd() {
+  int fd = -1;
+#if defined(MFD_CLOEXEC)
+  fd = memfd_create("thumbnail", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+  if (fd >= 0)
+    return fd;
+  LOG_DEBUG("memfd_create failed: %s", strerror(errno));
+#endif
+  // older kernels, an unlinked POSIX shm object behaves the same minus the seals
+  static gint counter = 0;
+  gchar* name = g_strdup_printf("/genivi-thumbnail-%d-%d", (int)getpid(), g_atomic_int_add(&counter, 1));
+  fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+  if (fd >= 0)
+    shm_unlink(name);
+  else
+    LOG_ERROR("shm_open failed: %s", strerror(errno));
+  g_free(name);
+  return fd;
+}
+
+}  // namespace genivimedia
@@ -0,0 +1,72 @@
+// @@@LICENSE
+//
+// Copyright (C) 2023, LG Electronics, All Right Reserved.
+//
+// No part of this source code may be communicated, distributed, reproduced
+// or transmitted in any form or by any means, electronic or mechanical or
+// otherwise, for any purpose, without the prior written permission of
+// LG Electronics.
+//
+// LICENSE@@@
+
+#ifndef GENIVIMEDIA_THUMBNAIL_ENCODER_H
+#define GENIVIMEDIA_THUMBNAIL_ENCODER_H
+
+#include <glib.h>
+#include <gst/gst.h>
+
+namespace genivimedia {
+
+struct ThumbnailImage {
+  int fd_;        /**< sealed memfd (or unlinked shm object), -1 if none */
+  gsize size_;    /**< encoded bytes from offset 0 */
+  gint width_;
+  gint height_;
+};
+
+/**
+ * @class      genivimedia::ThumbnailEncoder
+ * @brief      Encodes an RGB appsink sample to JPEG (libjpeg-turbo) or PNG (libpng).
+ * @details    The sample is mapped once and its rows are handed to the encoder as they are, stride
+ *             included. JPEG is compressed straight into an mmap of the output fd sized for the worst
+ *             case and truncated afterwards, PNG is written row by row to the fd; neither goes
+ *             through an intermediate buffer. EncodeToMemfd() writes into an anonymous memfd that is
+ *             sealed once complete, so it can be passed to a client as it is.
+ * @see        genivimedia::GstMedia::ExtractThumbnail genivimedia::ThumbnailStore
+ */
+class ThumbnailEncoder {
+ public:
+  /**
+   * @fn EncodeToMemfd
+   * @brief Encodes the sample into a new sealed memfd.
+   * @param[in] sample : RGB sample pulled from the appsink
+   * @param[in] format : "jpeg" or "png"
+   * @param[out] image : fd and size of the encoded image, owned by the caller on success
+   * @return bool (TRUE - SUCCESS, FALSE - FAIL)
+   */
+  static bool EncodeToMemfd(GstSample* sample, const gchar* format, ThumbnailImage* image);
+
+  static bool EncodeToFile(GstSample* sample, const gchar* format, const gchar* path);
+
+  /**
+   * @fn CopyToMemfd
+   * @brief Wraps an already encoded image (e.g. a ThumbnailCache hit) into a new sealed memfd.
+   * @details The width and height are read from the PNG or JPEG header.
+   * @return bool (TRUE - SUCCESS, FALSE - FAIL)
+   */
+  static bool CopyToMemfd(const guint8* data, gsize size, ThumbnailImage* image);
+
+ private:
+  static const int kJpegQuality = 100;  // as the former gdk_pixbuf_save("quality", "100")
+  static const int kPngCompression = 1;
+
+  static bool EncodeToFd(GstSample* sample, const gchar* format, int fd, ThumbnailImage* image);
+  static bool EncodeJpeg(const guint8* pixels, gint width, gint height, gint stride, int fd, gsize* size);
+  static bool EncodePng(const guint8* pixels, gint width, gint height, gint stride, int fd, gsize* size);
+  static void Seal(int fd);
+  static int CreateMemfd();
+};
+
+}  // namespace genivimedia
+
+#endif  // GENIVIMEDIA_THUMBNAIL_ENCODER_H
@@ -0,0 +1,287 @@
+// @@@LICENSE
+//
+// Copyright (C) 2023, LG Electronics, All Right Reserved.
+//
+// No part of this source code may be communicated, distributed, reproduced
+// or transmitted in any form or by any means, electronic or mechanical or
+// otherwise, for any purpose, without the prior written permission of
+// LG Electronics.
+//
+// LICENSE@@@
+
+#include "player/pipeline/thumbnail_frame_selector.h"
+
+#include <string.h>
+
+#include <vector>
+
+#include <gst/video/video.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
+#include "logger/player_logger.h"
+#include "player/pipeline/thumbnail_scaler.h"
+
+namespace genivimedia {
+
+namespace {
+
+// BT.601 weights in 1/256, 77 + 150 + 29 = 256 keeps white at 255
+const guint kLumaR = 77;
+const guint kLumaG = 150;
+const guint kLumaB = 29;
+
+gint LumaRowC(const guint8* rgb, guint8* luma, gint start, gint width) {
+  for (gint i = start; i < width; i++)
+    luma[i] = (guint8)((rgb[3 * i] * kLumaR + rgb[3 * i + 1] * kLumaG + rgb[3 * i + 2] * kLumaB) >> 8);
+  return width;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+// 16 pixels per step, three pshufb per channel pick the R, G and B bytes out of the 48 loaded
+__attribute__((target("ssse3")))
+gint LumaRowSsse3(const guint8* rgb, guint8* luma, gint start, gint width) {
+  const __m128i r0 = _mm_setr_epi8(0, 3, 6, 9, 12, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+  const __m128i r1 = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, 2, 5, 8, 11, 14, -1, -1, -1, -1, -1);
+  const __m128i r2 = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 1, 4, 7, 10, 13);
+  const __m128i g0 = _mm_setr_epi8(1, 4, 7, 10, 13, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+  const __m128i g1 = _mm_setr_epi8(-1, -1, -1, -1, -1, 0, 3, 6, 9, 12, 15, -1, -1, -1, -1, -1);
+  const __m128i g2 = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 2, 5, 8, 11, 14);
+  const __m128i b0 = _mm_setr_epi8(2, 5, 8, 11, 14, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+  const __m128i b1 = _mm_setr_epi8(-1, -1, -1, -1, -1, 1, 4, 7, 10, 13, -1, -1, -1, -1, -1, -1);
+  const __m128i b2 = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 0, 3, 6, 9, 12, 15);
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i kr = _mm_set1_epi16(kLumaR);
+  const __m128i kg = _mm_set1_epi16(kLumaG);
+  const __m128i kb = _mm_set1_epi16(kLumaB);
+  gint i = start;
+  for (; i + 16 <= width; i += 16) {
+    const guint8* p = rgb + 3 * i;
+    __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 16));
+    __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 32));
+    __m128i r = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(a, r0), _mm_shuffle_epi8(b, r1)),
+                             _mm_shuffle_epi8(c, r2));
+    __m128i g = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(a, g0), _mm_shuffle_epi8(b, g1)),
+                             _mm_shuffle_epi8(c, g2));
+    __m128i bl = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(a, b0), _mm_shuffle_epi8(b, b1)),
+                              _mm_shuffle_epi8(c, b2));
+    // at most 255 * 256, fits the unsigned 16 bit lanes
+    __m128i lo = _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(r, zero), kr),
+                                             _mm_mullo_epi16(_mm_unpacklo_epi8(g, zero), kg)),
+                               _mm_mullo_epi16(_mm_unpacklo_epi8(bl, zero), kb));
+    __m128i hi = _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(r, zero), kr),
+                                             _mm_mullo_epi16(_mm_unpackhi_epi8(g, zero), kg)),
+                               _mm_mullo_epi16(_mm_unpackhi_epi8(bl, zero), kb));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(luma + i),
+                     _mm_packus_epi16(_mm_srli_epi16(lo, 8), _mm_srli_epi16(hi, 8)));
+  }
+  return i;
+}
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+gint LumaRowNeon(const guint8* rgb, guint8* luma, gint start, gint width) {
+  const uint8x8_t kr = vdup_n_u8(kLumaR);
+  const uint8x8_t kg = vdup_n_u8(kLumaG);
+  const uint8x8_t kb = vdup_n_u8(kLumaB);
+  gint i = start;
+  for (; i + 16 <= width; i += 16) {
+    uint8x16x3_t v = vld3q_u8(rgb + 3 * i);
+    uint16x8_t lo = vmull_u8(vget_low_u8(v.val[0]), kr);
+    lo = vmlal_u8(lo, vget_low_u8(v.val[1]), kg);
+    lo = vmlal_u8(lo, vget_low_u8(v.val[2]), kb);
+    uint16x8_t hi = vmull_u8(vget_high_u8(v.val[0]), kr);
+    hi = vmlal_u8(hi, vget_high_u8(v.val[1]), kg);
+    hi = vmlal_u8(hi, vget_high_u8(v.val[2]), kb);
+    vst1q_u8(luma + i, vcombine_u8(vshrn_n_u16(lo, 8), vshrn_n_u16(hi, 8)));
+  }
+  return i;
+}
+#endif
+
+typedef gint (*LumaRowFunc)(const guint8* rgb, guint8* luma, gint start, gint width);
+
+LumaRowFunc SelectLumaRow() {
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("ssse3")) {
+    LOG_INFO("thumbnail luma uses SSSE3");
+    return LumaRowSsse3;
+  }
+#endif
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+  LOG_INFO("thumbnail luma uses NEON");
+  return LumaRowNeon;
+#else
+  LOG_INFO("thumbnail luma uses C");
+  return nullptr;
+#endif
+}
+
+}  // namespace
+
+GstSample* ThumbnailFrameSelector::Capture(GstElement* pipeline, GstElement* sink, gint percent, gint width) {
+  if (percent <= 0 || percent >= 100)
+    percent = kDefaultPercent;
+
+  gint64 duration = -1;
+  gint64 target = 1 * GST_SECOND;
+  if (gst_element_query_duration(pipeline, GST_FORMAT_TIME, &duration) && duration > 0)
+    target = duration * percent / 100;
+
+  gboolean seekable = FALSE;
+  GstQuery* query = gst_query_new_seeking(GST_FORMAT_TIME);
+  if (gst_element_query(pipeline, query))
+    gst_query_parse_seeking(query, nullptr, &seekable, nullptr, nullptr);
+  gst_query_unref(query);
+
+  gint64 start = g_get_monotonic_time();
+  GstSample* best = nullptr;
+  guint best_score = 0;
+  gint64 last_position = -1;
+  guint decoded = 0;
+  while (decoded < kMaxKeyframes) {
+    if (seekable) {
+      // KEY_UNIT moves the segment start to the keyframe, so exactly that frame is decoded
+      GstSeekFlags flags = (GstSeekFlags)(GST_SEEK_FLAG_FLUSH | GST_SEEK_FLAG_KEY_UNIT |
+          (decoded == 0 ? GST_SEEK_FLAG_SNAP_NEAREST : GST_SEEK_FLAG_SNAP_AFTER));
+      if (!gst_element_seek_simple(pipeline, GST_FORMAT_TIME, flags, target)) {
+        LOG_ERROR("seek to %" GST_TIME_FORMAT " failed", GST_TIME_ARGS(target));
+        break;
+      }
+    }
+
+    // a seek that never prerolls must not block the caller, GstMedia pulls on the main context
+    GstSample* sample = nullptr;
+    g_signal_emit_by_name(sink, "try-pull-preroll", (GstClockTime)kPrerollTimeout, &sample, nullptr);
+    if (!sample) {
+      LOG_ERROR("no preroll within %" GST_TIME_FORMAT, GST_TIME_ARGS(kPrerollTimeout));
+      break;
+    }
+    decoded++;
+    // the histogram runs on the thumbnail sized frame, not on the full resolution Y plane
+    sample = ThumbnailScaler::ToRgb(sample, width);
+    if (!sample)
+      break;
+
+    ThumbnailFrameStats stats;
+    bool usable = Analyze(sample, &stats);
+    guint score = 2000 - stats.black_permille_ - stats.peak_permille_;
+    LOG_INFO("keyframe %u at %" GST_TIME_FORMAT " black=%u peak=%u%s", decoded,
+             GST_TIME_ARGS(stats.position_), stats.black_permille_, stats.peak_permille_,
+             usable ? "" : " rejected");
+    if (usable) {
+      if (best)
+        gst_sample_unref(best);
+      best = sample;
+      break;
+    }
+    if (!best || score > best_score) {
+      if (best)
+        gst_sample_unref(best);
+      best = sample;
+      best_score = score;
+    } else {
+      gst_sample_unref(sample);
+    }
+
+    // no later keyframe to try
+    if (!seekable || stats.position_ < 0 || stats.position_ == last_position)
+      break;
+    last_position = stats.position_;
+    target = stats.position_ + GST_MSECOND;
+  }
+
+  LOG_INFO("%u keyframes decoded in [%lld]us", decoded, g_get_monotonic_time() - start);
+  return best;
+}
+
+bool ThumbnailFrameSelector::Analyze(GstSample* sample, ThumbnailFrameStats* stats) {
+  static LumaRowFunc luma_row = SelectLumaRow();
+
+  stats->black_permille_ = 1000;
+  stats->peak_permille_ = 1000;
+  stats->position_ = -1;
+
+  GstVideoInfo info;
+  GstCaps* caps = gst_sample_get_caps(sample);
+  GstBuffer* buffer = gst_sample_get_buffer(sample);
+  if (!caps || !buffer || !gst_video_info_from_caps(&info, caps))
+    return false;
+  // frames for ThumbnailScaler carry their luma as plane 0
+  GstVideoFormat format = GST_VIDEO_INFO_FORMAT(&info);
+  bool planar_luma = (format == GST_VIDEO_FORMAT_I420 || format == GST_VIDEO_FORMAT_YV12 ||
+                      format == GST_VIDEO_FORMAT_NV12 || format == GST_VIDEO_FORMAT_NV21);
+  if (format != GST_VIDEO_FORMAT_RGB && !planar_luma)
+    return false;
+  guint black_level = kBlackLevel;
+  if (planar_luma && GST_VIDEO_INFO_COLORIMETRY(&info).range != GST_VIDEO_COLOR_RANGE_0_255)
+    black_level = 16 + kBlackLevel * 219 / 255;
+
+  GstSegment* segment = gst_sample_get_segment(sample);
+  if (segment && GST_BUFFER_PTS_IS_VALID(buffer)) {
+    guint64 position = gst_segment_to_stream_time(segment, GST_FORMAT_TIME, GST_BUFFER_PTS(buffer));
+    if (position != GST_CLOCK_TIME_NONE)
+      stats->position_ = (gint64)position;
+  }
+
+  GstVideoFrame frame;
+  if (!gst_video_frame_map(&frame, &info, buffer, GST_MAP_READ))
+    return false;
+  const guint8* pixels = (const guint8*)GST_VIDEO_FRAME_PLANE_DATA(&frame, 0);
+  gint stride = GST_VIDEO_FRAME_PLANE_STRIDE(&frame, 0);
+  gint width = GST_VIDEO_FRAME_WIDTH(&frame);
+  gint height = GST_VIDEO_FRAME_HEIGHT(&frame);
+
+  // four partial histograms, runs of equal luma would otherwise serialize on one counter
+  guint32 histogram[4][256];
+  memset(histogram, 0, sizeof(histogram));
+  std::vector<guint8> luma(width);
+  for (gint row = 0; row < height; row++) {
+    const guint8* line = pixels + (gsize)row * stride;
+    const guint8* levels = line;
+    if (!planar_luma) {
+      gint done = luma_row ? luma_row(line, luma.data(), 0, width) : 0;
+      LumaRowC(line, luma.data(), done, width);
+      levels = luma.data();
+    }
+    gint i = 0;
+    for (; i + 4 <= width; i += 4) {
+      histogram[0][levels[i]]++;
+      histogram[1][levels[i + 1]]++;
+      histogram[2][levels[i + 2]]++;
+      histogram[3][levels[i + 3]]++;
+    }
+    for (; i < width; i++)
+      histogram[0][levels[i]]++;
+  }
+  gst_video_frame_unmap(&frame);
+
+  guint64 total = (guint64)width * height;
+  if (total == 0)
+    return false;
+  guint64 black = 0;
+  guint64 buckets[16] = {0};
+  for (guint level = 0; level < 256; level++) {
+    guint64 count = (guint64)histogram[0][level] + histogram[1][level] + histogram[2][level] +
+                    histogram[3][level];
+    if (level <= black_level)
+      black += count;
+    buckets[level >> 4] += count;
+  }
+  guint64 peak = 0;
+  for (guint64 count : buckets)
+    peak = MAX(peak, count);
+
+  stats->black_permille_ = (guint)(black * 1000 / total);
+  stats->peak_permille_ = (guint)(peak * 1000 / total);
+  return stats->black_permille_ < kRejectPermille && stats->peak_permille_ < kRejectPermille;
+}
+
+}  // namespace genivimedia
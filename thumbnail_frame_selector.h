@@ -0,0 +1,68 @@
+// @@@LICENSE
+//
+// Copyright (C) 2023, LG Electronics, All Right Reserved.
+//
+// No part of this source code may be communicated, distributed, reproduced
+// or transmitted in any form or by any means, electronic or mechanical or
+// otherwise, for any purpose, without the prior written permission of
+// LG Electronics.
+//
+// LICENSE@@@
+
+#ifndef GENIVIMEDIA_THUMBNAIL_FRAME_SELECTOR_H
+#define GENIVIMEDIA_THUMBNAIL_FRAME_SELECTOR_H
+
+#include <glib.h>
+#include <gst/gst.h>
+
+namespace genivimedia {
+
+struct ThumbnailFrameStats {
+  guint black_permille_;  /**< pixels with luma <= kBlackLevel */
+  guint peak_permille_;   /**< pixels in the fullest of 16 luma buckets */
+  gint64 position_;       /**< stream time of the frame, -1 if unknown */
+};
+
+/**
+ * @class      genivimedia::ThumbnailFrameSelector
+ * @brief      Captures a thumbnail frame from a keyframe, skipping black and uniform frames.
+ * @details    Capture() seeks KEY_UNIT|SNAP_NEAREST to a percentage of the duration, so the decoder
+ *             produces the keyframe itself and nothing of the GOP behind it. The prerolled RGB frame
+ *             is converted to luma (SSSE3 or NEON, scalar otherwise), a 4:2:0 frame for ThumbnailScaler
+ *             is scaled first so only the thumbnail sized frame is read, and the histogram decides whether the frame is mostly
+ *             black or a single flat level, e.g. a fade or a title card.
+ *             Such a frame is replaced by the next keyframe (SNAP_AFTER), at most kMaxKeyframes
+ *             decodes in total; when none qualifies the least uniform one is used.
+ * @see        genivimedia::GstMedia::ExtractThumbnail genivimedia::ThumbnailBatch
+ */
+class ThumbnailFrameSelector {
+ public:
+  /**
+   * @fn Capture
+   * @brief Seeks and pulls the preroll sample of the thumbnail frame.
+   * @param[in] pipeline : prerolled (PAUSED) thumbnail pipeline
+   * @param[in] sink : its RGB appsink
+   * @param[in] percent <1~99> : target position in percent of the duration, others select the default
+   * @param[in] width : thumbnail width, 4:2:0 frames are scaled to it before they are analyzed
+   * @return GstSample* (RGB, owned by the caller, nullptr if nothing prerolled)
+   */
+  static GstSample* Capture(GstElement* pipeline, GstElement* sink, gint percent, gint width);
+
+  /**
+   * @fn Analyze
+   * @brief Computes the luma histogram of an RGB or 4:2:0 sample.
+   * @return bool (TRUE - the frame is a usable thumbnail, FALSE - black, uniform or not supported)
+   */
+  static bool Analyze(GstSample* sample, ThumbnailFrameStats* stats);
+
+ private:
+  static const GstClockTime kPrerollTimeout = 3 * GST_SECOND;
+  static const gint kDefaultPercent = 5;
+  static const guint kMaxKeyframes = 3;
+  static const guint kBlackLevel = 32;
+  static const guint kRejectPermille = 950;
+};
+
+}  // namespace genivimedia
+
+#endif  // GENIVIMEDIA_THUMBNAIL_FRAME_SELECTOR_H
@@ -0,0 +1,332 @@
+// @@@LICENSE
+//
+// Copyright (C) 2023, LG Electronics, All Right Reserved.
+//
+// No part of this source code may be communicated, distributed, reproduced
+// or transmitted in any form or by any means, electronic or mechanical or
+// otherwise, for any purpose, without the prior written permission of
+// LG Electronics.
+//
+// LICENSE@@@
+
+#include "player/pipeline/thumbnail_scaler.h"
+
+#include <string.h>
+
+#include <vector>
+
+#include <gst/video/video.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
+#include "logger/player_logger.h"
+
+namespace genivimedia {
+
+const gchar* const ThumbnailScaler::kSinkCaps = "video/x-raw,format=(string){ I420, YV12, NV12, NV21 }";
+
+namespace {
+
+// 16 bit column sums hold 257 rows of 255, taller boxes use the first kMaxBoxRows rows
+const gint kMaxBoxRows = 257;
+const gint kShift = 14;
+
+gint AccumulateRowC(const guint8* src, guint16* acc, gint start, gint bytes) {
+  for (gint i = start; i < bytes; i++)
+    acc[i] += src[i];
+  return bytes;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+__attribute__((target("sse2")))
+gint AccumulateRowSse2(const guint8* src, guint16* acc, gint start, gint bytes) {
+  const __m128i zero = _mm_setzero_si128();
+  gint i = start;
+  for (; i + 16 <= bytes; i += 16) {
+    __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(acc + i));
+    __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(acc + i + 8));
+    lo = _mm_add_epi16(lo, _mm_unpacklo_epi8(pixels, zero));
+    hi = _mm_add_epi16(hi, _mm_unpackhi_epi8(pixels, zero));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(acc + i), lo);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(acc + i + 8), hi);
+  }
+  return i;
+}
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+gint AccumulateRowNeon(const guint8* src, guint16* acc, gint start, gint bytes) {
+  gint i = start;
+  for (; i + 16 <= bytes; i += 16) {
+    uint8x16_t pixels = vld1q_u8(src + i);
+    vst1q_u16(acc + i, vaddw_u8(vld1q_u16(acc + i), vget_low_u8(pixels)));
+    vst1q_u16(acc + i + 8, vaddw_u8(vld1q_u16(acc + i + 8), vget_high_u8(pixels)));
+  }
+  return i;
+}
+#endif
+
+typedef gint (*AccumulateRowFunc)(const guint8* src, guint16* acc, gint start, gint bytes);
+
+AccumulateRowFunc SelectAccumulateRow() {
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("sse2")) {
+    LOG_INFO("thumbnail scaler uses SSE2");
+    return AccumulateRowSse2;
+  }
+#endif
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+  LOG_INFO("thumbnail scaler uses NEON");
+  return AccumulateRowNeon;
+#else
+  LOG_INFO("thumbnail scaler uses C");
+  return AccumulateRowC;
+#endif
+}
+
+// first source index of each of the count output samples, [count] is the end
+std::vector<gint> BoxEdges(gint in_size, gint count) {
+  std::vector<gint> edges(count + 1);
+  for (gint i = 0; i <= count; i++)
+    edges[i] = (gint)((gint64)i * in_size / count);
+  return edges;
+}
+
+// box filters an interleaved plane of channels samples per pixel into out_w x out_h pixels,
+// a box narrower than one source pixel (upscaling) degenerates to the nearest pixel
+void BoxPlane(const guint8* src, gint stride, gint in_w, gint in_h, gint channels,
+              gint out_w, gint out_h, guint8* dst) {
+  static AccumulateRowFunc accumulate_row = SelectAccumulateRow();
+
+  std::vector<gint> x_edges = BoxEdges(in_w, out_w);
+  std::vector<gint> y_edges = BoxEdges(in_h, out_h);
+  std::vector<guint16> acc(in_w * channels);
+  gint bytes = in_w * channels;
+
+  for (gint oy = 0; oy < out_h; oy++) {
+    gint y0 = MIN(y_edges[oy], in_h - 1);
+    gint y1 = MIN(MAX(y_edges[oy + 1], y0 + 1), y0 + kMaxBoxRows);
+    memset(acc.data(), 0, acc.size() * sizeof(guint16));
+    for (gint y = y0; y < y1; y++) {
+      const guint8* row = src + (gsize)y * stride;
+      AccumulateRowC(row, acc.data(), accumulate_row(row, acc.data(), 0, bytes), bytes);
+    }
+
+    guint8* out = dst + (gsize)oy * out_w * channels;
+    for (gint ox = 0; ox < out_w; ox++) {
+      gint x0 = MIN(x_edges[ox], in_w - 1);
+      gint x1 = MAX(x_edges[ox + 1], x0 + 1);
+      guint32 count = (guint32)(x1 - x0) * (y1 - y0);
+      for (gint c = 0; c < channels; c++) {
+        guint32 sum = 0;
+        for (gint x = x0; x < x1; x++)
+          sum += acc[x * channels + c];
+        out[ox * channels + c] = (guint8)((sum + count / 2) / count);
+      }
+    }
+  }
+}
+
+struct YuvMatrix {
+  gint y_offset_;
+  gint y_;
+  gint r_v_;
+  gint g_u_;
+  gint g_v_;
+  gint b_u_;
+};
+
+YuvMatrix MakeYuvMatrix(const GstVideoInfo* info) {
+  gdouble kr = 0.299;
+  gdouble kb = 0.114;
+  if (!gst_video_color_matrix_get_Kr_Kb(GST_VIDEO_INFO_COLORIMETRY(info).matrix, &kr, &kb)) {
+    kr = 0.299;
+    kb = 0.114;
+  }
+  gdouble kg = 1.0 - kr - kb;
+  bool full = (GST_VIDEO_INFO_COLORIMETRY(info).range == GST_VIDEO_COLOR_RANGE_0_255);
+  gdouble y_scale = full ? 1.0 : 255.0 / 219.0;
+  gdouble c_scale = full ? 1.0 : 255.0 / 224.0;
+  gdouble one = (gdouble)(1 << kShift);
+
+  YuvMatrix matrix;
+  matrix.y_offset_ = full ? 0 : 16;
+  matrix.y_ = (gint)(y_scale * one + 0.5);
+  matrix.r_v_ = (gint)(2.0 * (1.0 - kr) * c_scale * one + 0.5);
+  matrix.g_u_ = (gint)(2.0 * kb * (1.0 - kb) / kg * c_scale * one + 0.5);
+  matrix.g_v_ = (gint)(2.0 * kr * (1.0 - kr) / kg * c_scale * one + 0.5);
+  matrix.b_u_ = (gint)(2.0 * (1.0 - kb) * c_scale * one + 0.5);
+  return matrix;
+}
+
+inline guint8 Clamp(gint value) {
+  value = (value + (1 << (kShift - 1))) >> kShift;
+  return (guint8)CLAMP(value, 0, 255);
+}
+
+}  // namespace
+
+GstSample* ThumbnailScaler::Scale(GstSample* sample, gint width) {
+  GstVideoInfo info;
+  GstCaps* caps = gst_sample_get_caps(sample);
+  GstBuffer* buffer = gst_sample_get_buffer(sample);
+  if (!caps || !buffer || !gst_video_info_from_caps(&info, caps))
+    return nullptr;
+  GstVideoFormat format = GST_VIDEO_INFO_FORMAT(&info);
+  if (format != GST_VIDEO_FORMAT_I420 && format != GST_VIDEO_FORMAT_YV12 &&
+      format != GST_VIDEO_FORMAT_NV12 && format != GST_VIDEO_FORMAT_NV21) {
+    LOG_ERROR("cannot scale %s", gst_video_format_to_string(format));
+    return nullptr;
+  }
+
+  gint64 start = g_get_monotonic_time();
+  gint in_w = GST_VIDEO_INFO_WIDTH(&info);
+  gint in_h = GST_VIDEO_INFO_HEIGHT(&info);
+  gint par_n = MAX(GST_VIDEO_INFO_PAR_N(&info), 1);
+  gint par_d = MAX(GST_VIDEO_INFO_PAR_D(&info), 1);
+  gint out_w = (width > 0) ? width : in_w;
+  // as videoscale to width=W,pixel-aspect-ratio=1/1: keep the display aspect ratio
+  gint out_h = (gint)gst_util_uint64_scale_round(in_h, (guint64)out_w * par_d, (guint64)in_w * par_n);
+  out_h = MAX(out_h, 1);
+
+  GstVideoFrame frame;
+  if (!gst_video_frame_map(&frame, &info, buffer, GST_MAP_READ))
+    return nullptr;
+
+  std::vector<guint8> luma((gsize)out_w * out_h);
+  BoxPlane((const guint8*)GST_VIDEO_FRAME_COMP_DATA(&frame, 0), GST_VIDEO_FRAME_COMP_STRIDE(&frame, 0),
+           GST_VIDEO_FRAME_COMP_WIDTH(&frame, 0), GST_VIDEO_FRAME_COMP_HEIGHT(&frame, 0), 1,
+           out_w, out_h, luma.data());
+
+  // U at chroma[2 * i + u_index], V at the other one
+  std::vector<guint8> chroma((gsize)out_w * out_h * 2);
+  gint u_index = 0;
+  gint chroma_w = GST_VIDEO_FRAME_COMP_WIDTH(&frame, 1);
+  gint chroma_h = GST_VIDEO_FRAME_COMP_HEIGHT(&frame, 1);
+  if (GST_VIDEO_FRAME_COMP_PSTRIDE(&frame, 1) == 2) {
+    // NV12/NV21, both components of the interleaved plane in one pass
+    u_index = GST_VIDEO_FORMAT_INFO_POFFSET(info.finfo, 1);
+    const guint8* plane = (const guint8*)GST_VIDEO_FRAME_PLANE_DATA(&frame, GST_VIDEO_FORMAT_INFO_PLANE(info.finfo, 1));
+    BoxPlane(plane, GST_VIDEO_FRAME_COMP_STRIDE(&frame, 1), chroma_w, chroma_h, 2,
+             out_w, out_h, chroma.data());
+  } else {
+    std::vector<guint8> u((gsize)out_w * out_h);
+    std::vector<guint8> v((gsize)out_w * out_h);
+    BoxPlane((const guint8*)GST_VIDEO_FRAME_COMP_DATA(&frame, 1), GST_VIDEO_FRAME_COMP_STRIDE(&frame, 1),
+             chroma_w, chroma_h, 1, out_w, out_h, u.data());
+    BoxPlane((const guint8*)GST_VIDEO_FRAME_COMP_DATA(&frame, 2), GST_VIDEO_FRAME_COMP_STRIDE(&frame, 2),
+             chroma_w, chroma_h, 1, out_w, out_h, v.data());
+    for (gsize i = 0; i < u.size(); i++) {
+      chroma[2 * i] = u[i];
+      chroma[2 * i + 1] = v[i];
+    }
+  }
+  gst_video_frame_unmap(&frame);
+
+  GstVideoInfo out_info;
+  gst_video_info_set_format(&out_info, GST_VIDEO_FORMAT_RGB, out_w, out_h);
+  GstBuffer* out_buffer = gst_buffer_new_allocate(nullptr, GST_VIDEO_INFO_SIZE(&out_info), nullptr);
+  GstMapInfo map;
+  if (!out_buffer || !gst_buffer_map(out_buffer, &map, GST_MAP_WRITE)) {
+    if (out_buffer)
+      gst_buffer_unref(out_buffer);
+    return nullptr;
+  }
+
+  YuvMatrix matrix = MakeYuvMatrix(&info);
+  gint stride = GST_VIDEO_INFO_PLANE_STRIDE(&out_info, 0);
+  gint v_index = 1 - u_index;
+  for (gint y = 0; y < out_h; y++) {
+    guint8* rgb = map.data + (gsize)y * stride;
+    const guint8* y_row = luma.data() + (gsize)y * out_w;
+    const guint8* c_row = chroma.data() + (gsize)y * out_w * 2;
+    for (gint x = 0; x < out_w; x++) {
+      gint l = (y_row[x] - matrix.y_offset_) * matrix.y_;
+      gint u = c_row[2 * x + u_index] - 128;
+      gint v = c_row[2 * x + v_index] - 128;
+      rgb[3 * x] = Clamp(l + matrix.r_v_ * v);
+      rgb[3 * x + 1] = Clamp(l - matrix.g_u_ * u - matrix.g_v_ * v);
+      rgb[3 * x + 2] = Clamp(l + matrix.b_u_ * u);
+    }
+  }
+  gst_buffer_unmap(out_buffer, &map);
+  GST_BUFFER_PTS(out_buffer) = GST_BUFFER_PTS(buffer);
+
+  GstCaps* out_caps = gst_video_info_to_caps(&out_info);
+  GstSample* result = gst_sample_new(out_buffer, out_caps, gst_sample_get_segment(sample), nullptr);
+  gst_caps_unref(out_caps);
+  gst_buffer_unref(out_buffer);
+  LOG_DEBUG("%dx%d %s -> %dx%d RGB in [%lld]us", in_w, in_h, gst_video_format_to_string(format),
+            out_w, out_h, g_get_monotonic_time() - start);
+  return result;
+}
+
+GstSample* ThumbnailScaler::ToRgb(GstSample* sample, gint width) {
+  // the sink caps decide: RGB unless the pipeline was built with kSinkCaps
+  GstCaps* caps = gst_sample_get_caps(sample);
+  GstStructure* structure = caps ? gst_caps_get_structure(caps, 0) : nullptr;
+  const gchar* format = structure ? gst_structure_get_string(structure, "format") : nullptr;
+  if (!format || g_strcmp0(format, "RGB") == 0)
+    return sample;
+
+  GstSample* scaled = Scale(sample, width);
+  gst_sample_unref(sample);
+  if (!scaled)
+    LOG_ERROR("could not scale %s thumbnail to %d", format, width);
+  return scaled;
+}
+
+void ThumbnailScaler::RequestDecoderScaling(GstElement* pipeline, gint width) {
+  if (!pipeline || width <= 0)
+    return;
+  g_signal_connect(pipeline, "deep-element-added", G_CALLBACK(DeepElementAddedFunc), GINT_TO_POINTER(width));
+}
+
+void ThumbnailScaler::DeepElementAddedFunc(GstBin* bin, GstBin* sub_bin, GstElement* element, gpointer data) {
+  GstElementFactory* factory = gst_element_get_factory(element);
+  if (!factory || !g_str_has_prefix(GST_OBJECT_NAME(factory), "avdec_") ||
+      !g_object_class_find_property(G_OBJECT_GET_CLASS(element), "lowres"))
+    return;
+
+  // the input width is known with the first CAPS event, which configures the codec context
+  GstPad* pad = gst_element_get_static_pad(element, "sink");
+  if (!pad)
+    return;
+  gst_pad_add_probe(pad, GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM, DecoderCapsProbeFunc, data, nullptr);
+  gst_object_unref(pad);
+}
+
+GstPadProbeReturn ThumbnailScaler::DecoderCapsProbeFunc(GstPad* pad, GstPadProbeInfo* info, gpointer data) {
+  GstEvent* event = GST_PAD_PROBE_INFO_EVENT(info);
+  if (GST_EVENT_TYPE(event) != GST_EVENT_CAPS)
+    return GST_PAD_PROBE_OK;
+
+  GstCaps* caps = nullptr;
+  gint width = 0;
+  gst_event_parse_caps(event, &caps);
+  if (!caps || gst_caps_is_empty(caps) ||
+      !gst_structure_get_int(gst_caps_get_structure(caps, 0), "width", &width))
+    return GST_PAD_PROBE_OK;
+
+  // libav clamps the value to what the codec supports, e.g. 0 for h264
+  gint target = GPOINTER_TO_INT(data);
+  gint lowres = 0;
+  while (lowres < kMaxLowres && (width >> (lowres + 1)) >= target)
+    lowres++;
+  GstElement* decoder = gst_pad_get_parent_element(pad);
+  if (decoder) {
+    g_object_set(decoder, "lowres", lowres, nullptr);
+    LOG_INFO("%s decodes %d wide at 1/%d", GST_ELEMENT_NAME(decoder), width, 1 << lowres);
+    gst_object_unref(decoder);
+  }
+  return GST_PAD_PROBE_OK;
+}
+
+}  // namespace genivimedia
@@ -0,0 +1,72 @@
+// @@@LICENSE
+//
+// Copyright (C) 2023, LG Electronics, All Right Reserved.
+//
+// No part of this source code may be communicated, distributed, reproduced
+// or transmitted in any form or by any means, electronic or mechanical or
+// otherwise, for any purpose, without the prior written permission of
+// LG Electronics.
+//
+// LICENSE@@@
+
+#ifndef GENIVIMEDIA_THUMBNAIL_SCALER_H
+#define GENIVIMEDIA_THUMBNAIL_SCALER_H
+
+#include <glib.h>
+#include <gst/gst.h>
+
+namespace genivimedia {
+
+/**
+ * @class      genivimedia::ThumbnailScaler
+ * @brief      Scales a decoded 4:2:0 frame to the thumbnail width and converts it to RGB in one pass.
+ * @details    Replaces videoconvert ! videoscale in front of the thumbnail appsink: the sink accepts
+ *             the layouts decoders produce (kSinkCaps), so videoconvert stays in passthrough and the
+ *             full resolution frame is read exactly once. Every plane is box filtered, rows summed
+ *             column-wise with SSE2 or NEON and the columns reduced per output pixel, and only the
+ *             thumbnail sized result goes through the YUV to RGB matrix of the stream.
+ *             RequestDecoderScaling() asks libav decoders for reduced output ("lowres", 1/2 or 1/4)
+ *             from the width of their input caps, e.g. avdec_mjpeg then scales in the IDCT, so the
+ *             decoder never produces more than the thumbnail needs.
+ * @see        genivimedia::GstMedia::ExtractThumbnail genivimedia::ThumbnailBatch
+ */
+class ThumbnailScaler {
+ public:
+  static const gchar* const kSinkCaps;
+
+  /**
+   * @fn Scale
+   * @brief Scales an I420, YV12, NV12 or NV21 sample to an RGB sample.
+   * @param[in] sample : prerolled sample, not consumed
+   * @param[in] width : output width, the height keeps the display aspect ratio (square pixels)
+   * @return GstSample* (owned by the caller, nullptr if the format is not supported)
+   */
+  static GstSample* Scale(GstSample* sample, gint width);
+
+  /**
+   * @fn ToRgb
+   * @brief Returns an RGB sample as it is and scales any other one with Scale().
+   * @param[in] sample : pulled sample, consumed
+   * @param[in] width : output width of Scale()
+   * @return GstSample* (owned by the caller, nullptr if the sample could not be scaled)
+   */
+  static GstSample* ToRgb(GstSample* sample, gint width);
+
+  /**
+   * @fn RequestDecoderScaling
+   * @brief Lets decoders added to the pipeline from now on decode at reduced size.
+   * @param[in] pipeline : thumbnail pipeline, before it leaves NULL
+   * @param[in] width : thumbnail width, the decoded width never gets below it
+   */
+  static void RequestDecoderScaling(GstElement* pipeline, gint width);
+
+ private:
+  static const gint kMaxLowres = 2;
+
+  static void DeepElementAddedFunc(GstBin* bin, GstBin* sub_bin, GstElement* element, gpointer data);
+  static GstPadProbeReturn DecoderCapsProbeFunc(GstPad* pad, GstPadProbeInfo* info, gpointer data);
+};
+
+}  // namespace genivimedia
+
+#endif  // GENIVIMEDIA_THUMBNAIL_SCALER_H
@@ -0,0 +1,75 @@
+// @@@LICENSE
+//
+// Copyright (C) 2023, LG Electronics, All Right Reserved.
+//
+// No part of this source code may be communicated, distributed, reproduced
+// or transmitted in any form or by any means, electronic or mechanical or
+// otherwise, for any purpose, without the prior written permission of
+// LG Electronics.
+//
+// LICENSE@@@
+
+#include "player/pipeline/thumbnail_store.h"
+
+#include <unistd.h>
+
+#include "logger/player_logger.h"
+
+namespace genivimedia {
+
+ThumbnailStore* ThumbnailStore::instance_ = nullptr;
+
+ThumbnailStore* ThumbnailStore::Instance() {
+  if (instance_ == nullptr) {
+    instance_ = new ThumbnailStore();
+  }
+  return instance_;
+}
+
+void ThumbnailStore::Destroy() {
+  if (instance_) {
+    delete instance_;
+    instance_ = nullptr;
+  }
+}
+
+ThumbnailStore::ThumbnailStore()
+  : mutex_(),
+    entries_() {
+}
+
+ThumbnailStore::~ThumbnailStore() {
+  for (auto& entry : entries_)
+    close(entry.second.fd_);
+}
+
+void ThumbnailStore::Put(const std::string& uri, const ThumbnailImage& image) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto iter = entries_.begin(); iter != entries_.end(); ++iter) {
+    if (iter->first == uri) {
+      close(iter->second.fd_);
+      entries_.erase(iter);
+      break;
+    }
+  }
+  if (entries_.size() >= kMaxEntries) {
+    LOG_INFO("drop unclaimed thumbnail [%s]", entries_.front().first.c_str());
+    close(entries_.front().second.fd_);
+    entries_.pop_front();
+  }
+  entries_.push_back(std::make_pair(uri, image));
+}
+
+bool ThumbnailStore::Take(const std::string& uri, ThumbnailImage* image) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto iter = entries_.begin(); iter != entries_.end(); ++iter) {
+    if (iter->first == uri) {
+      *image = iter->second;
+      entries_.erase(iter);
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace genivimedia
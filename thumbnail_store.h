@@ -0,0 +1,68 @@
+// @@@LICENSE
+//
+// Copyright (C) 2023, LG Electronics, All Right Reserved.
+//
+// No part of this source code may be communicated, distributed, reproduced
+// or transmitted in any form or by any means, electronic or mechanical or
+// otherwise, for any purpose, without the prior written permission of
+// LG Electronics.
+//
+// LICENSE@@@
+
+#ifndef GENIVIMEDIA_THUMBNAIL_STORE_H
+#define GENIVIMEDIA_THUMBNAIL_STORE_H
+
+#include <deque>
+#include <mutex>
+#include <string>
+
+#include "player/pipeline/thumbnail_encoder.h"
+
+namespace genivimedia {
+
+/**
+ * @class      genivimedia::ThumbnailStore
+ * @brief      Holds encoded thumbnail fds until the client takes them over D-Bus.
+ * @details    A thumbnail extracted with "output":"fd" is put here under its uri and announced
+ *             with ThumbnailDone; TakeThumbnail hands the fd out once and forgets it. At most
+ *             kMaxEntries images are kept, the oldest is closed when a client never picks it up.
+ * @see        genivimedia::ThumbnailEncoder genivimedia::ThumbnailPipeline
+ */
+class ThumbnailStore {
+ public:
+  static ThumbnailStore* Instance();
+  static void Destroy();
+
+  /**
+   * @fn Put
+   * @brief Stores the image, replacing (and closing) an earlier one of the same uri.
+   * @param[in] uri : uri the thumbnail was extracted from
+   * @param[in] image : image whose fd is owned by the store from now on
+   * @return None
+   */
+  void Put(const std::string& uri, const ThumbnailImage& image);
+
+  /**
+   * @fn Take
+   * @brief Removes the image of the uri from the store.
+   * @param[in] uri : uri the thumbnail was extracted from
+   * @param[out] image : image whose fd is owned by the caller from now on
+   * @return bool (TRUE - found, FALSE - no image for the uri)
+   */
+  bool Take(const std::string& uri, ThumbnailImage* image);
+
+ private:
+  static const size_t kMaxEntries = 16;
+
+  ThumbnailStore();
+  ~ThumbnailStore();
+
+  static ThumbnailStore* instance_;
+
+  std::mutex mutex_;
+  std::deque<std::pair<std::string, ThumbnailImage>> entries_;
+};
+
+}  // namespace genivimedia
+
+#endif  // GENIVIMEDIA_THUMBNAIL_STORE_H
@@ -0,0 +1,120 @@
+// @@@LICENSE
+//
+// Copyright (C) 2023, LG Electronics, All Right Reserved.
+//
+// No part of this source code may be communicated, distributed, reproduced
+// or transmitted in any form or by any means, electronic or mechanical or
+// otherwise, for any purpose, without the prior written permission of
+// LG Electronics.
+//
+// LICENSE@@@
+
+#include "player/pipeline/trick_mode_probe.h"
+
+#include "logger/player_logger.h"
+
+namespace genivimedia {
+
+TrickModeProbe::TrickModeProbe()
+  : mutex_(),
+    sink_(nullptr),
+    pad_(nullptr),
+    probe_id_(0),
+    rate_(1.0),
+    flushed_(false),
+    trick_segment_(false),
+    decided_(false) {
+}
+
+TrickModeProbe::~TrickModeProbe() {
+  Reset();
+}
+
+void TrickModeProbe::Watch(GstElement* sink, gdouble rate) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  RemoveProbeLocked();
+  if (!sink)
+    return;
+
+  GstPad* pad = gst_element_get_static_pad(sink, "sink");
+  if (!pad) {
+    LOG_INFO("no sink pad on [%s], trick mode segment is not checked", GST_ELEMENT_NAME(sink));
+    return;
+  }
+  sink_ = GST_ELEMENT(gst_object_ref(sink));
+  pad_ = pad;
+  rate_ = rate;
+  flushed_ = false;
+  trick_segment_ = false;
+  decided_ = false;
+  probe_id_ = gst_pad_add_probe(pad_, GstPadProbeType(GST_PAD_PROBE_TYPE_BUFFER |
+                                                      GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM |
+                                                      GST_PAD_PROBE_TYPE_EVENT_FLUSH),
+                                SinkProbe, this, nullptr);
+}
+
+void TrickModeProbe::Reset() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  RemoveProbeLocked();
+}
+
+void TrickModeProbe::RemoveProbeLocked() {
+  if (pad_) {
+    if (probe_id_)
+      gst_pad_remove_probe(pad_, probe_id_);
+    gst_object_unref(pad_);
+  }
+  if (sink_)
+    gst_object_unref(sink_);
+  sink_ = nullptr;
+  pad_ = nullptr;
+  probe_id_ = 0;
+}
+
+GstPadProbeReturn TrickModeProbe::SinkProbe(GstPad* pad, GstPadProbeInfo* info, gpointer data) {
+  TrickModeProbe* probe = reinterpret_cast<TrickModeProbe*>(data);
+  GstElement* sink = nullptr;
+  gdouble rate = 0.0;
+  {
+    std::lock_guard<std::mutex> lock(probe->mutex_);
+    if (probe->decided_ || pad != probe->pad_)
+      return GST_PAD_PROBE_OK;
+
+    if (GST_PAD_PROBE_INFO_TYPE(info) & GST_PAD_PROBE_TYPE_BUFFER) {
+      // buffers queued before the seek's flush belong to the old segment
+      if (!probe->flushed_)
+        return GST_PAD_PROBE_OK;
+      probe->decided_ = true;
+      if (probe->trick_segment_) {
+        LOG_INFO("trick mode segment rate=[%lf] confirmed", probe->rate_);
+        return GST_PAD_PROBE_OK;
+      }
+      sink = GST_ELEMENT(gst_object_ref(probe->sink_));
+      rate = probe->rate_;
+    } else {
+      GstEvent* event = GST_PAD_PROBE_INFO_EVENT(info);
+      if (GST_EVENT_TYPE(event) == GST_EVENT_FLUSH_STOP) {
+        probe->flushed_ = true;
+        probe->trick_segment_ = false;
+      } else if (GST_EVENT_TYPE(event) == GST_EVENT_SEGMENT && probe->flushed_) {
+        const GstSegment* segment = nullptr;
+        gst_event_parse_segment(event, &segment);
+        gdouble effective_rate = segment->rate * segment->applied_rate;
+        probe->trick_segment_ = (segment->flags & GST_SEGMENT_FLAG_TRICKMODE) &&
+                                ((effective_rate < 0) == (probe->rate_ < 0));
+        LOG_INFO("segment after trick mode seek rate=[%lf] flags=[0x%x]", effective_rate, segment->flags);
+      }
+      return GST_PAD_PROBE_OK;
+    }
+  }
+
+  LOG_INFO("first buffer without trick mode segment, rate=[%lf] falls back", rate);
+  gst_element_post_message(sink,
+                           gst_message_new_application(GST_OBJECT(sink),
+                               gst_structure_new(TRICK_MODE_FALLBACK_MESSAGE,
+                                                 "rate", G_TYPE_DOUBLE, rate, nullptr)));
+  gst_object_unref(sink);
+  return GST_PAD_PROBE_OK;
+}
+
+}  // namespace genivimedia
@@ -0,0 +1,68 @@
+// @@@LICENSE
+//
+// Copyright (C) 2023, LG Electronics, All Right Reserved.
+//
+// No part of this source code may be communicated, distributed, reproduced
+// or transmitted in any form or by any means, electronic or mechanical or
+// otherwise, for any purpose, without the prior written permission of
+// LG Electronics.
+//
+// LICENSE@@@
+
+#ifndef GENIVIMEDIA_TRICK_MODE_PROBE_H
+#define GENIVIMEDIA_TRICK_MODE_PROBE_H
+
+#include <mutex>
+
+#include <glib.h>
+#include <gst/gst.h>
+
+namespace genivimedia {
+
+#define TRICK_MODE_FALLBACK_MESSAGE "trick-mode-fallback"
+
+/**
+ * @class      genivimedia::TrickModeProbe
+ * @brief      Checks that a trick mode seek really produced a trick mode segment at the video sink.
+ * @details    A demuxer may accept the seek event and still run a normal segment, or ignore the rate.
+ *             Watch() adds a probe on the video sink pad before the seek is sent. After the seek's
+ *             FLUSH_STOP it remembers whether the SEGMENT has GST_SEGMENT_FLAG_TRICKMODE and runs in the
+ *             requested direction. If the first buffer after the flush arrives without such a segment,
+ *             TRICK_MODE_FALLBACK_MESSAGE is posted as an application message with the field
+ *             "rate" (double), and the owner shall fall back to stepping with seeks.
+ *             The probe stays passive after the first buffer until Reset() or the next Watch().
+ * @see        genivimedia::GstMedia::SeekTrickMode
+ */
+class TrickModeProbe {
+ public:
+  TrickModeProbe();
+  ~TrickModeProbe();
+
+  /**
+   * @fn Watch
+   * @brief Starts checking the segments which follow the next flush on the sink.
+   * @param[in] sink : video sink (or sink bin) of the pipeline, nullptr disables the check
+   * @param[in] rate : requested trick mode rate
+   * @return None
+   */
+  void Watch(GstElement* sink, gdouble rate);
+
+  void Reset();
+
+ private:
+  static GstPadProbeReturn SinkProbe(GstPad* pad, GstPadProbeInfo* info, gpointer data);
+  void RemoveProbeLocked();
+
+  std::mutex mutex_;
+  GstElement* sink_;
+  GstPad* pad_;
+  gulong probe_id_;
+  gdouble rate_;
+  bool flushed_;
+  bool trick_segment_;
+  bool decided_;
+};
+
+}  // namespace genivimedia
+
+#endif  // GENIVIMEDIA_TRICK_MODE_PROBE_H
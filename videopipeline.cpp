@@ -17,11 +17,31 @@
 #include <math.h>
 
 #include "logger/player_logger.h"
+#include "player/pipeline/audio_sink_swap.h"
+#include "player/pipeline/autoplug_policy.h"
 #include "player/pipeline/conf.h"
+#include "player/pipeline/fast_path_bin.h"
+#include "player/pipeline/load_timeline.h"
+#include "player/pipeline/lut_balance.h"
+#include "player/pipeline/playbin_pool.h"
+#include "player/pipeline/resolution_probe.h"
+#include "player/pipeline/subtitle_loader.h"
 #include "player/pipeline/support_media_creator.h"
+#include "player/pipeline/trick_mode_probe.h"
 
 namespace genivimedia {
 
+// ms, QosMonitor::GetJson() only reads counters and the sink stats
+static const guint kQosReportInterval = 10000;
+// ms, a live sink swap whose result message never comes (sink pad unlinked, pipeline stopped) ends here
+static const guint kSinkSwapTimeout = 3000;
+
+struct SinkSwapFallback {
+  VideoPipeline* pipeline_;
+  int channels_;
+  bool is_dsd_;
+};
+
 VideoPipeline::VideoPipeline()
   : gst_media_(GstMedia::Instance()),
     video_sink_(),
@@ -31,9 +51,15 @@ VideoPipeline::VideoPipeline()
     video_balance_(),
     playsink_(),
     position_timer_(new Timer()),
+    qos_timer_(new Timer()),
+    resolution_probe_(new ResolutionProbe(std::bind(&VideoPipeline::HandleResolutionChange, this,
+                                                    std::placeholders::_1,
+                                                    std::placeholders::_2,
+                                                    std::placeholders::_3))),
     trick_timer_(new Timer()),
     check_playback_timer_(new Timer()),
     loading_timer_(new Timer()),
+    sink_swap_timer_(new Timer()),
     event_(new Event()),
     pb_info_(),
     source_info_(),
@@ -44,6 +70,13 @@ VideoPipeline::VideoPipeline()
     subtitle_index_type_map_(),
     current_subtitle_index_(0),
     subtitle_status_(true),
+#endif
+#if defined (USE_SUBTITLE)
+    subtitle_loader_(new SubtitleLoader()),
+    subtitle_play_pending_(false),
+    subtitle_show_pending_(-1),
+    subtitle_language_pending_(),
+    subtitle_index_pending_(-1),
 #endif
     video_info_(),
     last_seek_pos_(-1),
@@ -55,25 +88,48 @@ VideoPipeline::VideoPipeline()
     use_atmos_(false),
     show_preroll(true),
     provide_global_clock_(true),
-    bIsDolbyAtmosEacJoc(false) {
+    bIsDolbyAtmosEacJoc(false),
+    next_uri_mutex_(),
+    next_uri_queue_(),
+    current_raw_uri_(),
+    pending_track_uri_(),
+    source_info_mutex_(),
+    source_info_sent_(false),
+    streams_selected_(false),
+    sink_swap_fallback_id_(0),
+    fast_path_source_(false),
+    fast_path_failed_uri_() {
   LOG_INFO("");
 }
 
 VideoPipeline::~VideoPipeline() {
   LOG_INFO("");
 
+  if (sink_swap_fallback_id_)
+    g_source_remove(sink_swap_fallback_id_);
+
+#if defined (USE_SUBTITLE)
+  // joins a running parse, its controller reports to event_
+  if (subtitle_loader_)
+    delete subtitle_loader_;
+#endif
 #if defined (USE_SUBTITLE) || defined(USE_LGE_SUBTITLE)
-  if (subtitle_controller_)
-    delete subtitle_controller_;
+  subtitle_controller_.reset();
 #endif
   if (position_timer_)
     delete position_timer_;
+  if (qos_timer_)
+    delete qos_timer_;
+  if (resolution_probe_)
+    delete resolution_probe_;
   if (trick_timer_)
     delete trick_timer_;
   if (check_playback_timer_)
     delete check_playback_timer_;
   if (loading_timer_)
     delete loading_timer_;
+  if (sink_swap_timer_)
+    delete sink_swap_timer_;
   if (event_)
     delete event_;
 }
@@ -93,6 +149,11 @@ bool VideoPipeline::Load(const std::string& uri)  {
     return ret;
   }
   pb_info_.is_mtp_ = gst_media_->IsMtpFile(uri);
+  {
+    std::lock_guard<std::mutex> lock(next_uri_mutex_);
+    current_raw_uri_ = raw_uri;
+    pending_track_uri_.clear();
+  }
 
   gst_media_->CreateGstPlaybin("video_pipeline");
 
@@ -101,6 +162,10 @@ bool VideoPipeline::Load(const std::string& uri)  {
                                                      std::placeholders::_2,
                                                      std::placeholders::_3);
   gst_media_->RegisterElementAddBin(elementadd_callback);
+  AboutToFinishCallback about_to_finish_callback = std::bind(&VideoPipeline::HandleAboutToFinish, this,
+                                                             std::placeholders::_1,
+                                                             std::placeholders::_2);
+  gst_media_->RegisterAboutToFinish(about_to_finish_callback);
   BusCallback callback = std::bind(&VideoPipeline::BusMessage, this,
                                    std::placeholders::_1,
                                    std::placeholders::_2,
@@ -108,11 +173,21 @@ bool VideoPipeline::Load(const std::string& uri)  {
   gst_media_->RegisterWatchBus(callback);
 
   ControlProperties(const_cast<char*>(raw_uri.c_str()));
+  LoadTimeline::Instance()->Mark("pipeline-built");
+  LoadTimeline::Instance()->SetCallback(std::bind(&VideoPipeline::HandleLoadTimeline, this,
+                                                  std::placeholders::_1));
+  LoadTimeline::Instance()->WatchFirstBuffer(video_sink_, "first-video-buffer");
+  if (!no_audio_mode_)
+    LoadTimeline::Instance()->WatchFirstBuffer(audio_sink_, "first-audio-sample");
 
   TimerCallback position_callback = std::bind(&VideoPipeline::UpdatePositionInfo, this);
   position_timer_->AddCallback(position_callback, 1000);
+  TimerCallback qos_callback = std::bind(&VideoPipeline::UpdateQosInfo, this);
+  qos_timer_->AddCallback(qos_callback, kQosReportInterval);
   TimerCallback trick_callback = std::bind(&VideoPipeline::HandleTrickPlay, this);
   trick_timer_->AddCallback(trick_callback, 500);
+  TimerCallback sink_swap_callback = std::bind(&VideoPipeline::CheckSinkSwap, this);
+  sink_swap_timer_->AddCallback(sink_swap_callback, kSinkSwapTimeout);
 
   SeekControlCallback seekcallback = std::bind(&VideoPipeline::HandleSeekControl, this, std::placeholders::_1);
   gst_media_->RegisterSeekControl(seekcallback);
@@ -167,10 +242,14 @@ bool VideoPipeline::Load(const std::string& uri, const std::string& option, int
     no_audio_mode_ = true;
   }
 
-  if (media_type_.compare("mood_therapy_video") == 0) {
-    pb_info_.mode = PLAYBACK_REPEAT_GAPLESS;
-  } else {
-    pb_info_.mode = PLAYBACK_NORMAL;
+  {
+    // about-to-finish reads the mode from the streaming thread
+    std::lock_guard<std::mutex> lock(next_uri_mutex_);
+    if (media_type_.compare("mood_therapy_video") == 0) {
+      pb_info_.mode = PLAYBACK_REPEAT_GAPLESS;
+    } else {
+      pb_info_.mode = PLAYBACK_NORMAL;
+    }
   }
   LOG_INFO("preroll=[%d], clock=[%d], ch=[%d], convert=[%d], type=[%s]",
             show_preroll, provide_global_clock_, audio_channel_, convert, media_type_.c_str());
@@ -195,12 +274,36 @@ bool VideoPipeline::UnloadInternal(bool destroy_pipeline) {
   bool use_keep_alive = true;
   GstState cur_state = GST_STATE_NULL;
 
+#if defined (USE_SUBTITLE)
+  // a running parse works on its own controller, which is dropped with the result
+  subtitle_loader_->Cancel();
+  subtitle_play_pending_ = false;
+  subtitle_show_pending_ = -1;
+  subtitle_language_pending_.clear();
+  subtitle_index_pending_ = -1;
+#endif
 #if defined (USE_SUBTITLE) || defined(USE_LGE_SUBTITLE)
   subtitle_controller_->Stop();
 #endif
   trick_timer_->Stop();
   position_timer_->Stop();
+  qos_timer_->Stop();
   check_playback_timer_->Stop();
+  if (sink_swap_fallback_id_) {
+    g_source_remove(sink_swap_fallback_id_);
+    sink_swap_fallback_id_ = 0;
+  }
+  sink_swap_timer_->Stop();
+  gst_media_->SinkSwapDone();
+  resolution_probe_->Detach();
+  LoadTimeline::Instance()->SetCallback(nullptr);
+  pb_info_.is_native_trick_ = false;
+  fast_path_source_ = false;
+  {
+    std::lock_guard<std::mutex> lock(next_uri_mutex_);
+    next_uri_queue_.clear();
+    pending_track_uri_.clear();
+  }
   loading_timer_->Stop();
   if (event_->ErrorOccurred()) {
     destroy_pipeline = true;
@@ -217,7 +320,9 @@ bool VideoPipeline::UnloadInternal(bool destroy_pipeline) {
         LOG_ERROR("changing state to READY fail");
     }
     if (cur_state == GST_STATE_READY) {
-      destroy_pipeline = true;
+      // a READY playbin goes back to the pool unless the pool is full or disabled
+      if (!PlaybinPool::Instance()->CanRelease(gst_media_->GetPipeline()))
+        destroy_pipeline = true;
       use_keep_alive = false;
       goto EXIT;
     }
@@ -248,7 +353,12 @@ bool VideoPipeline::Play() {
 
   bool ret = false;
   ret = gst_media_->ChangeStateToPlay();
-#if defined (USE_SUBTITLE) || defined(USE_LGE_SUBTITLE)
+#if defined (USE_SUBTITLE)
+  // HandleSubtitleLoaded() starts the loaded controller, which replaces the one played here
+  subtitle_play_pending_ = true;
+  if (!subtitle_loader_->IsLoading())
+    subtitle_controller_->Play();
+#elif defined(USE_LGE_SUBTITLE)
   subtitle_controller_->Play();
 #endif
   return ret;
@@ -308,7 +418,7 @@ bool VideoPipeline::Seek(gint64 position) {
     return ret;
   }
 
-  if (gst_media_->Seek(position)) {
+  if (gst_media_->ScheduleSeek(position)) {
     pb_info_.current_position_ = position*GST_MSECOND;
     pb_info_.is_seeking_ = true;
     ret = true;
@@ -329,6 +439,11 @@ bool VideoPipeline::StopRateChange() {
   }
 
   trick_timer_->Stop();
+  if (pb_info_.is_native_trick_) {
+    pb_info_.is_native_trick_ = false;
+    if (!gst_media_->SetPlaybackSpeed(1.0))
+      LOG_ERROR("Failed to leave trick mode");
+  }
   pb_info_.playback_rate_ = 1.0;
   event_->NotifyEventAsyncDone(false);
   ret = true;
@@ -338,6 +453,12 @@ bool VideoPipeline::StopRateChange() {
 bool VideoPipeline::SetSubtitleEnable(bool show) {
   LOG_INFO("SetSubtitleEnable");
 #if defined (USE_SUBTITLE)
+  // applied by HandleSubtitleLoaded() to the loaded controller
+  if (subtitle_loader_->IsLoading()) {
+    LOG_INFO("subtitle is still loading, enable=[%d] is applied after the load", show);
+    subtitle_show_pending_ = show ? 1 : 0;
+    return true;
+  }
   return subtitle_controller_->SetSubtitleEnable(show);
 #elif defined(USE_LGE_SUBTITLE)
   subtitle_status_ = show;
@@ -367,6 +488,12 @@ bool VideoPipeline::SetSubtitleEnable(bool show) {
 bool VideoPipeline::SetSubtitleLanguage(const std::string& language) {
 //  LOG_INFO("SetSubtitleLanguage [%s]", language.c_str());
 #if defined (USE_SUBTITLE)
+  if (subtitle_loader_->IsLoading()) {
+    LOG_INFO("subtitle is still loading, language=[%s] is applied after the load", language.c_str());
+    subtitle_language_pending_ = language;
+    subtitle_index_pending_ = -1;
+    return true;
+  }
   return subtitle_controller_->SetSubtitleLanguage(language);
 #elif defined(USE_LGE_SUBTITLE)
   LOG_WARN("SetSubtitleLanguage[%s]: Not supported API in LGE subtitle solution", language.c_str());
@@ -379,6 +506,12 @@ bool VideoPipeline::SetSubtitleLanguage(const std::string& language) {
 bool VideoPipeline::SetSubtitleLanguageIndex(int language) {
   LOG_INFO("SetSubtitleLanguageIndex");
 #ifdef USE_SUBTITLE
+  if (subtitle_loader_->IsLoading()) {
+    LOG_INFO("subtitle is still loading, index=[%d] is applied after the load", language);
+    subtitle_index_pending_ = language;
+    subtitle_language_pending_.clear();
+    return true;
+  }
   return subtitle_controller_->SetSubtitleLanguageIndex(language);
 #elif defined(USE_LGE_SUBTITLE)
   current_subtitle_index_ = language;
@@ -456,7 +589,10 @@ bool VideoPipeline::SwitchChannel(bool downmix) {
     audio_channel_ = new_channel;
   }
   if(gst_media_->SwitchChannel(downmix, audio_slot_, audio_6ch_slot_, false, media_type_, provide_global_clock_, audio_sink_, gst_media_->GetPipeline())) {
-    if(!use_atmos_)
+    // a live swap reports its result later, the channel is notified from HandleBusApplication()
+    if (gst_media_->IsSinkSwapPending())
+      sink_swap_timer_->Start();
+    else if(!use_atmos_)
       event_->NotifyEventChannel(media_type_, audio_channel_);
   } else {
     return false;
@@ -464,6 +600,19 @@ bool VideoPipeline::SwitchChannel(bool downmix) {
   return true;
 }
 
+bool VideoPipeline::EnqueueNextURI(const std::string& uri) {
+  std::string raw_uri = gst_media_->GetRawURI(uri);
+  if (raw_uri.empty()) {
+    LOG_ERROR("Fail to convert raw uri[%s]", uri.c_str());
+    return false;
+  }
+
+  std::lock_guard<std::mutex> lock(next_uri_mutex_);
+  next_uri_queue_.push_back(raw_uri);
+  LOG_INFO("EnqueueNextURI[%s], queued=[%u]", raw_uri.c_str(), (guint)next_uri_queue_.size());
+  return true;
+}
+
 bool VideoPipeline::SetVideoWindow(VideoWindowInfo &info) {
   LOG_INFO("SetVideoWindow with %s, %d", info.surface_info_.c_str(), info.aspect_ratio_);
   video_info_ = info;
@@ -576,7 +725,8 @@ bool VideoPipeline::SetVideoContrast(float contrast){
 gboolean VideoPipeline::UpdatePositionInfo() {
   gint64 position = 0;
 
-  if (pb_info_.is_eos_ || pb_info_.is_seeking_ || fabs(pb_info_.playback_rate_ - 1.0) > DBL_EPSILON)
+  if (pb_info_.is_eos_ || pb_info_.is_seeking_ ||
+      (fabs(pb_info_.playback_rate_ - 1.0) > DBL_EPSILON && !pb_info_.is_native_trick_))
     return true;
 
   GstState cur_state = GST_STATE_NULL;
@@ -584,19 +734,45 @@ gboolean VideoPipeline::UpdatePositionInfo() {
       (cur_state == GST_STATE_PAUSED))
     return true;
 
-  if (gst_media_->GetCurPosition(&position)) {
+  // the pipeline is only queried after discontinuities, see PositionClock
+  if (gst_media_->GetExtrapolatedPosition(&position)) {
     if(position > pb_info_.duration_)
       position = pb_info_.duration_;
     //if((position/GST_SECOND) > (pb_info_.current_position_/GST_SECOND)){
         pb_info_.current_position_ = position;
         last_seek_pos_ = -1;
         event_->NotifyEventCurrentPosition(position);
-        LOG_INFO ("UpdatePositionInfo time(sec)-%f", (float)position/GST_SECOND);
+        LOG_DEBUG ("UpdatePositionInfo time(sec)-%f", (float)position/GST_SECOND);
     //}
   }
   return true;
 }
 
+gboolean VideoPipeline::UpdateQosInfo() {
+  if (video_count_ == 0)
+    return true;
+  event_->NotifyEventQos(gst_media_->GetQosJson());
+  return true;
+}
+
+void VideoPipeline::HandleResolutionChange(gint width, gint height, gint64 detected_us) {
+  gint64 position = pb_info_.current_position_;
+  gst_media_->GetExtrapolatedPosition(&position);
+
+  if (source_info_.cur_video_track_ >= 0 &&
+      source_info_.cur_video_track_ < (gint)source_info_.video_.size()) {
+    source_info_.video_[source_info_.cur_video_track_].width_ = width;
+    source_info_.video_[source_info_.cur_video_track_].height_ = height;
+  }
+  LOG_INFO("resolution %dx%d at position(sec)-%f, reported [%lld]us after detection", width, height,
+           (float)position/GST_SECOND, g_get_monotonic_time() - detected_us);
+  event_->NotifyEventVideoResolution(width, height, position);
+}
+
+void VideoPipeline::HandleLoadTimeline(const std::string& json) {
+  event_->NotifyEventLoadTimeline(json);
+}
+
 void VideoPipeline::ControlProperties(char* raw_uri){
 #if defined(PLATFORM_NVIDIA)
     ControlPropertiesNvidia(raw_uri);
@@ -658,6 +834,8 @@ void VideoPipeline::ControlPropertiesNvidia(char* raw_uri) {
           gst_element_link_many(tee, video_sink_, NULL);
       }
       gst_media_->SetProperty<GstElement*>(gst_media_->GetPipeline(), "video-sink", const_cast<GstElement*>(video_bin));
+      gst_media_->SetQosVideoSink(video_sink_);
+      resolution_probe_->Attach(video_sink_);
     }
   }
 
@@ -681,16 +859,20 @@ void VideoPipeline::ControlPropertiesNvidia(char* raw_uri) {
       }
     }
   }
-  gst_media_->SetProperty<char*>(gst_media_->GetPipeline(), "uri", raw_uri);
+  gst_media_->SetSourceURI(raw_uri, fast_path_failed_uri_ != raw_uri);
 }
 
 void VideoPipeline::ControlPropertiesTelechips(char* raw_uri) {
   gchar* video_sink = Conf::GetSink(VIDEO_SINK);
+  // the LUT balance takes the video-filter slot, so it is only used without a configured filter
+  bool use_lut_balance = Conf::GetFeatures(SUPPORT_LUT_BALANCE) && !strlen(Conf::GetFilter(VIDEO_SINK));
   playsink_ = gst_bin_get_by_name(GST_BIN(gst_media_->GetPipeline()), "playsink");
   if(playsink_){
     LOG_INFO("get playsink");
     guint flags;
-    flags =  GST_PLAY_FLAG_AUDIO | GST_PLAY_FLAG_VIDEO | GST_PLAY_FLAG_SOFT_VOLUME | GST_PLAY_FLAG_DEINTERLACE | GST_PLAY_FLAG_SOFT_COLORBALANCE;
+    flags =  GST_PLAY_FLAG_AUDIO | GST_PLAY_FLAG_VIDEO | GST_PLAY_FLAG_SOFT_VOLUME | GST_PLAY_FLAG_DEINTERLACE;
+    if (!use_lut_balance)
+      flags |= GST_PLAY_FLAG_SOFT_COLORBALANCE;
     gst_media_->SetProperty<gint>(gst_media_->GetPipeline(), "flags", flags);
     ElementAddCallback elementadd_callback = std::bind(&VideoPipeline::HandlePlaySinkElementAdd, this,
                                                           std::placeholders::_1,
@@ -716,6 +898,8 @@ void VideoPipeline::ControlPropertiesTelechips(char* raw_uri) {
       }
       gst_media_->SetProperty<gboolean>(video_sink_, "show-preroll-frame", show_preroll);
       gst_media_->SetProperty<GstElement*>(gst_media_->GetPipeline(), "video-sink", const_cast<GstElement*>(video_sink_));
+      gst_media_->SetQosVideoSink(video_sink_);
+      resolution_probe_->Attach(video_sink_);
 
       gchar* video_filter = Conf::GetFilter(VIDEO_SINK);
       if (strlen(video_filter)) {
@@ -724,10 +908,28 @@ void VideoPipeline::ControlPropertiesTelechips(char* raw_uri) {
         if (video_filter_) {
           gst_media_->SetProperty<GstElement*>(gst_media_->GetPipeline(), "video-filter", const_cast<GstElement*>(video_filter_));
         }
+      } else if (use_lut_balance) {
+        video_balance_ = LutBalance::Create("lutbalance");
+        if (video_balance_) {
+          LOG_INFO("Set LUT video balance");
+          LutBalance::WatchFrameTime(video_balance_);
+          gst_media_->SetProperty<GstElement*>(gst_media_->GetPipeline(), "video-filter", const_cast<GstElement*>(video_balance_));
+          SetVideoBrightness(video_info_.brightness_);
+          SetVideoContrast(video_info_.contrast_);
+          SetVideoSaturation(video_info_.saturation_);
+        }
       }
     }
   }
 
+  if (use_lut_balance && !video_balance_) {
+    // the LUT balance could not be set up, give the color balance back to playsink
+    guint flags = 0;
+    gst_media_->GetProperty<guint>(gst_media_->GetPipeline(), "flags", flags);
+    gst_media_->SetProperty<gint>(gst_media_->GetPipeline(), "flags", flags | GST_PLAY_FLAG_SOFT_COLORBALANCE);
+    LOG_INFO("LUT video balance is not available, use soft color balance");
+  }
+
   if (!no_audio_mode_) {
     gchar* audio_sink = Conf::GetSink(AUDIO_SINK);
     if (strlen(audio_sink)) {
@@ -748,7 +950,7 @@ void VideoPipeline::ControlPropertiesTelechips(char* raw_uri) {
     }
   }
   //gst_media_->SetProperty<gboolean>(gst_media_->GetPipeline(), "force-aspect-ratio", force_aspect_ratio);
-  gst_media_->SetProperty<char*>(gst_media_->GetPipeline(), "uri", raw_uri);
+  gst_media_->SetSourceURI(raw_uri, fast_path_failed_uri_ != raw_uri);
 }
 
 void VideoPipeline::ControlPropertiesCommon(char* raw_uri) {
@@ -763,6 +965,8 @@ void VideoPipeline::ControlPropertiesCommon(char* raw_uri) {
       gst_media_->SetProperty<gboolean>(video_sink_, "force-aspect-ratio", force_aspect_ratio);
       gst_media_->SetProperty<gboolean>(video_sink_, "show-preroll-frame", show_preroll);
       gst_media_->SetProperty<GstElement*>(gst_media_->GetPipeline(), "video-sink", const_cast<GstElement*>(video_sink_));
+      gst_media_->SetQosVideoSink(video_sink_);
+      resolution_probe_->Attach(video_sink_);
     }
   }
   gchar* video_filter = Conf::GetFilter(VIDEO_SINK);
@@ -792,11 +996,16 @@ void VideoPipeline::ControlPropertiesCommon(char* raw_uri) {
   }
 
   gst_media_->SetProperty<gboolean>(gst_media_->GetPipeline(), "force-aspect-ratio", force_aspect_ratio);
-  gst_media_->SetProperty<char*>(gst_media_->GetPipeline(), "uri", raw_uri);
+  gst_media_->SetSourceURI(raw_uri, fast_path_failed_uri_ != raw_uri);
+}
+
+bool VideoPipeline::HasVideo() const {
+  // playbin counts the demuxer pad and the decoder pad of a video, playbin3 and the fast path the streams
+  return (gst_media_->IsPlaybin3() || fast_path_source_) ? (video_count_ > 0) : (video_count_ >= 2);
 }
 
 gboolean VideoPipeline::CheckPlayback() {
-  if (video_count_ < 2 ) {
+  if (!HasVideo()) {
     LOG_ERROR("No Video");
     if (pb_info_.is_load_completed_)
       event_->NotifyEventError();
@@ -837,12 +1046,33 @@ void VideoPipeline::ControlPlaybackRate(gdouble rate) {
 
   if (!pb_info_.playback_started) {
     position_timer_->Start();
+    qos_timer_->Start();
     event_->NotifyEventPlaybackStatus(STATE_PLAYING);
     pb_info_.playback_started = true;
   }
 
   trick_timer_->Stop();
-  position = pb_info_.current_position_;
+  if (!gst_media_->GetCurPosition(&position))
+    position = pb_info_.current_position_;
+
+  pb_info_.is_bos_ = false;
+  pb_info_.is_eos_ = false;
+  pb_info_.is_native_trick_ = gst_media_->SeekTrickMode(rate, position);
+  if (pb_info_.is_native_trick_) {
+    // positions, BOS and EOS come from the segment from now on
+    GstState cur_state = GST_STATE_NULL;
+    if (gst_media_->GetCurPipelineState(&cur_state) && cur_state != GST_STATE_PLAYING)
+      gst_media_->ChangeStateToPlay();
+    pb_info_.current_position_ = position;
+    pb_info_.playback_rate_ = rate;
+    return;
+  }
+
+  StartTrickStep(position, rate);
+}
+
+void VideoPipeline::StartTrickStep(gint64 position, gdouble rate) {
+  LOG_INFO("no native trick mode, step with seeks every 500ms");
   gst_media_->ChangeStateToPause();
 
   trick_timer_->Start();
@@ -851,43 +1081,6 @@ void VideoPipeline::ControlPlaybackRate(gdouble rate) {
   pb_info_.playback_rate_count_ = 0;
 }
 
-void VideoPipeline::ControlAsfContainer(GstElement* bin) {
-  bool found = false;
-  GstIterator *it_uridecodebin;
-  GstIterator *it_decodebin;
-  GValue elem_uridecodebin = G_VALUE_INIT;
-  GValue elem_decodebin = G_VALUE_INIT;
-  gchar* name_elem_uridecodebin = nullptr;
-  gchar* name_elem_decodebin = nullptr;
-
-  it_uridecodebin = gst_bin_iterate_elements(GST_BIN(bin));
-  while (!found && gst_iterator_next(it_uridecodebin, &elem_uridecodebin) == GST_ITERATOR_OK) {
-
-    name_elem_uridecodebin = gst_element_get_name(g_value_get_object(&elem_uridecodebin));
-    if (g_strrstr(name_elem_uridecodebin, "decodebin")) {
-      it_decodebin = gst_bin_iterate_elements(GST_BIN(g_value_get_object(&elem_uridecodebin)));
-      while (gst_iterator_next(it_decodebin, &elem_decodebin) == GST_ITERATOR_OK) {
-        name_elem_decodebin = gst_element_get_name(g_value_get_object(&elem_decodebin));
-        if (g_strrstr(name_elem_decodebin, "asfdemux")) {
-          gst_media_->SetProperty<gboolean>((GstElement*)g_value_get_object(&elem_decodebin), "ignore-eos", true);
-          LOG_INFO("");
-          found = true;
-          g_free(name_elem_decodebin);
-          break;
-        }
-        g_free(name_elem_decodebin);
-        g_value_reset(&elem_decodebin);
-      }
-    }
-    g_free(name_elem_uridecodebin);
-    g_value_reset(&elem_uridecodebin);
-  }
-  g_value_unset(&elem_decodebin);
-  g_value_unset(&elem_uridecodebin);
-  gst_iterator_free(it_decodebin);
-  gst_iterator_free(it_uridecodebin);
-}
-
 bool VideoPipeline::TrickPlayInternal(gint64 position) {
   if (pb_info_.is_seeking_in_trick_)
     return false;
@@ -907,6 +1100,14 @@ gboolean VideoPipeline::BusMessage(GstBus* bus, GstMessage* message, gpointer da
 
   if (GST_MESSAGE_TYPE(message) == GST_MESSAGE_APPLICATION)
     HandleBusApplication(message);
+  else if (GST_MESSAGE_TYPE(message) == GST_MESSAGE_CLOCK_LOST)
+    HandleClockLost();
+
+  // posted by decodebin3 inside playbin3
+  if (GST_MESSAGE_TYPE(message) == GST_MESSAGE_STREAM_COLLECTION)
+    HandleStreamCollection(message);
+  else if (GST_MESSAGE_TYPE(message) == GST_MESSAGE_STREAMS_SELECTED)
+    HandleStreamsSelected(message);
 
   if (GST_MESSAGE_SRC(message) == GST_OBJECT_CAST(pipeline))
     ret = HandleBusPipelineMessage(message);
@@ -924,12 +1125,25 @@ gboolean VideoPipeline::HandleElementAdd(GstBin* bin, GstElement *element, gpoin
     return true;
   LOG_INFO("%s\n", element_name);
   if (nullptr != g_strrstr (element_name, "uridecodebin")) {
+    LoadTimeline::Instance()->Mark("uridecodebin-added");
     ElementAddCallback elementadd_callback = std::bind(&VideoPipeline::HandleUriDecodeBinElementAdd, this,
                                                        std::placeholders::_1,
                                                        std::placeholders::_2,
                                                        std::placeholders::_3);
     gst_media_->RegisterUriDecodeBinElementAddBin(elementadd_callback, element);
 
+    // uridecodebin3 has no autoplug signals, the policy and no-more-pads follow the stream
+    // collection, see HandleStreamCollection() and HandleStreamsSelected()
+    if (gst_media_->IsPlaybin3()) {
+      TimerCallback playback_callback = std::bind(&VideoPipeline::CheckPlayback, this);
+      check_playback_timer_->AddCallback(playback_callback, (pb_info_.is_mtp_)? 50000 : 1800);
+      check_playback_timer_->Start();
+      TimerCallback loading_callback = std::bind(&VideoPipeline::CheckShowLoading, this);
+      loading_timer_->AddCallback(loading_callback, 2000);
+      g_free(element_name);
+      return true;
+    }
+
     AutoPlugSortCallback autoplugsort_callback = std::bind(&VideoPipeline::HandleAutoplugSort, this,
                                                        std::placeholders::_1,
                                                        std::placeholders::_2,
@@ -969,7 +1183,8 @@ gboolean VideoPipeline::HandlePlaySinkElementAdd(GstBin* bin, GstElement *elemen
   if (!element_name)
     return true;
   LOG_INFO("%s\n", element_name);
-  if (nullptr != g_strrstr (element_name, "vbin")) {
+  // video_balance_ is already set when the LUT balance replaces the software videobalance
+  if (nullptr != g_strrstr (element_name, "vbin") && !video_balance_) {
     GstElement *conv, *scale;
     GstCaps *caps;
     GstElement *vconv =  gst_bin_get_by_name(GST_BIN(element), "vconv");
@@ -992,6 +1207,7 @@ gboolean VideoPipeline::HandlePlaySinkElementAdd(GstBin* bin, GstElement *elemen
       LOG_ERROR("playsink videobalance not exist");
       return true;
     }
+    LutBalance::WatchFrameTime(video_balance_);
     SetVideoBrightness(video_info_.brightness_);
     SetVideoContrast(video_info_.contrast_);
     SetVideoSaturation(video_info_.saturation_);
@@ -1021,6 +1237,13 @@ gboolean VideoPipeline::HandleUriDecodeBinElementAdd(GstBin* bin, GstElement *el
 
   LOG_INFO("%s", element_name);
 
+  GstElementFactory* factory = gst_element_get_factory(element);
+  if (factory && g_strcmp0(GST_OBJECT_NAME(factory), FAST_PATH_SRC_FACTORY_NAME) == 0) {
+    // the source exposes decoded pads, no decodebin and no autoplug-sort follow
+    fast_path_source_ = true;
+    g_signal_connect(element, "pad-added", G_CALLBACK(FastPathPadAddedFunc), static_cast<void*>(this));
+  }
+
   if (nullptr != g_strrstr (element_name, "decodebin")) {
     ElementAddCallback elementadd_callback = std::bind(&VideoPipeline::F, this,
                                                        std::placeholders::_1,
@@ -1063,6 +1286,11 @@ gboolean VideoPipeline::FDZZ(GstBin* bin, GstElement *element, gpointer data) {
     return true;
   LOG_INFO("%s", element_name);
 
+  GstElementFactory* factory = gst_element_get_factory(element);
+  const gchar* klass = factory ? gst_element_factory_get_metadata(factory, GST_ELEMENT_METADATA_KLASS) : nullptr;
+  if (klass && g_strrstr(klass, "Decoder") && g_strrstr(klass, "Video"))
+    gst_media_->AttachQosDecoder(element);
+
   if (!no_audio_mode_ && ((nullptr != g_strrstr (element_name, "ocdtsdecoder")) ||
       (nullptr != g_strrstr (element_name, "ocac3decoder")))) {
     gst_media_->SetProperty<gint>(element, "output-channels", audio_channel_);
@@ -1088,6 +1316,60 @@ gboolean VideoPipeline::FDZZ(GstBin* bin, GstElement *element, gpointer data) {
   return true;
 }
 
+void VideoPipeline::HandleStreamCollection(GstMessage* message) {
+  StreamFilter filter = std::bind(&VideoPipeline::IsStreamPlayable, this, std::placeholders::_1);
+  if (!gst_media_->HandleStreamCollection(message, !no_audio_mode_, filter))
+    return;
+
+  int count = gst_media_->GetTrackCount("video");
+  LOG_INFO("playbin3 collection, video count - %d", count);
+  // as the first video pad in HandleAutoplugSort()
+  if (video_count_ == 0 && count > 0) {
+    gst_media_->InvokeOwner([this]() {
+                              check_playback_timer_->Stop();
+                              TimerCallback playback_callback = std::bind(&VideoPipeline::CheckPlayback, this);
+                              check_playback_timer_->AddCallback(playback_callback, 3200);
+                              check_playback_timer_->Start();
+
+                              loading_timer_->Start();
+                            });
+  }
+  video_count_ = count;
+}
+
+void VideoPipeline::HandleStreamsSelected(GstMessage* message) {
+  gst_media_->HandleStreamsSelected(message);
+
+  // the first selection of the load is where decodebin has exposed its pads
+  if (streams_selected_)
+    return;
+  streams_selected_ = true;
+  gst_media_->InvokeOwner([this]() { HandleNoMorePads(nullptr, nullptr); });
+}
+
+bool VideoPipeline::IsStreamPlayable(GstStream* stream) {
+  GstCaps* caps = gst_stream_get_caps(stream);
+  if (!caps)
+    return true;
+
+  // decodebin3 cannot skip a single factory, so a stream is dropped when no decoder is allowed for it
+  GList* decoders = gst_element_factory_list_get_elements(GST_ELEMENT_FACTORY_TYPE_DECODER,
+                                                          GST_RANK_MARGINAL);
+  GList* candidates = gst_element_factory_list_filter(decoders, caps, GST_PAD_SINK, FALSE);
+  bool playable = (candidates == nullptr);
+  for (GList* item = candidates; item && !playable; item = item->next) {
+    if (SelectFactory(caps, GST_ELEMENT_FACTORY(item->data)) != GST_AUTOPLUG_SELECT_SKIP)
+      playable = true;
+  }
+  if (!playable)
+    LOG_INFO("stream [%s] skipped by autoplug policy", gst_stream_get_stream_id(stream));
+
+  gst_plugin_feature_list_free(candidates);
+  gst_plugin_feature_list_free(decoders);
+  gst_caps_unref(caps);
+  return playable;
+}
+
 GValueArray* VideoPipeline::HandleAutoplugSort(GstElement *bin,GstPad *pad,GstCaps *caps,
                                                GValueArray *factories, gpointer data) {
   GstStructure* caps_str = nullptr;
@@ -1118,99 +1400,52 @@ GValueArray* VideoPipeline::HandleAutoplugSort(GstElement *bin,GstPad *pad,GstCa
 
 int VideoPipeline::HandleAutoplugSelect(GstElement *bin,GstPad *pad, GstCaps *caps,
                                         GstElementFactory *factory, gpointer data) {
-  GstStructure* caps_str = nullptr;
-  const gchar* mime_type = nullptr;
-  const gchar* stream_format = nullptr;
+  if (!factory || !caps || gst_caps_get_size(caps) == 0)
+    return GST_AUTOPLUG_SELECT_TRY;
 
-  int mpeg_version = 0;
-  int select_result = GST_AUTOPLUG_SELECT_TRY;
+  LOG_DEBUG("#### gst_plugin_feature_get_name=[%s] ####",
+            gst_plugin_feature_get_name(reinterpret_cast<GstPluginFeature*>(factory)));
+  int select_result = SelectFactory(caps, factory);
 
-  gchar* element_name = gst_plugin_feature_get_name(reinterpret_cast<GstPluginFeature*>(factory));
-  LOG_INFO("#### gst_plugin_feature_get_name=[%s] ####", element_name);
-  if (element_name && caps) {
-    caps_str = gst_caps_get_structure(caps, 0);
-    mime_type = gst_structure_get_name(caps_str);
+  gchar* mark = g_strdup_printf("autoplug %s %s", gst_plugin_feature_get_name(GST_PLUGIN_FEATURE_CAST(factory)),
+                                (select_result == GST_AUTOPLUG_SELECT_SKIP) ? "skip" : "try");
+  LoadTimeline::Instance()->Mark(g_intern_string(mark));
+  g_free(mark);
+  return select_result;
+}
 
-    if (g_str_has_prefix(mime_type, "audio/")) {
-      if (no_audio_mode_) {
-        LOG_INFO("GST_AUTOPLUG_SELECT_SKIP(audio/) mime_type-%s", mime_type);
-        select_result = GST_AUTOPLUG_SELECT_SKIP;
-      } else {
+int VideoPipeline::SelectFactory(GstCaps* caps, GstElementFactory* factory) {
+  GstStructure* caps_str = nullptr;
+  const gchar* mime_type = nullptr;
 
-        int sample_rate = 0;
-        if (gst_structure_get_int(caps_str, "rate", &sample_rate)) {
-          LOG_DEBUG("samplerate=[%d]", sample_rate);
-          if (sample_rate > 0 && !gst_media_->IsLGsrcValidSamplerate(sample_rate)) {
-            LOG_ERROR("Unsupported sampling rate=[%d]", sample_rate);
-            select_result = GST_AUTOPLUG_SELECT_SKIP;
-          }
-        }
-      }
+  if (gst_caps_get_size(caps) == 0)
+    return GST_AUTOPLUG_SELECT_TRY;
+  caps_str = gst_caps_get_structure(caps, 0);
+  mime_type = gst_structure_get_name(caps_str);
+
+  // depends on this pipeline instance, so it is not part of the shared rule table
+  if (g_str_has_prefix(mime_type, "audio/")) {
+    if (no_audio_mode_) {
+      LOG_INFO("GST_AUTOPLUG_SELECT_SKIP(audio/) mime_type-%s", mime_type);
+      return GST_AUTOPLUG_SELECT_SKIP;
     }
 
-    if (g_strcmp0(element_name, "beepdec") == 0) {
-      stream_format = gst_structure_get_string(caps_str, "stream-format");
-      gst_structure_get_int(caps_str, "mpegversion", &mpeg_version);
-      if (stream_format && (g_strcmp0(stream_format, "adts") == 0) &&
-          mime_type && (g_strcmp0(mime_type, "audio/mpeg") == 0) &&
-          (mpeg_version == 2 || mpeg_version == 4)) {
-        LOG_INFO("GST_AUTOPLUG_SELECT_SKIP(beepdec) mime_type-%s, stream-format-%s, mpeg-version-%d",
-                 mime_type, stream_format, mpeg_version);
-        select_result = GST_AUTOPLUG_SELECT_SKIP;
-      }
-    } else if (g_strcmp0(element_name, "nvmediampeg4viddec") == 0) {
-      if (mime_type && (g_strcmp0(mime_type, "video/x-h263") == 0)) {
-        LOG_INFO("GST_AUTOPLUG_SELECT_SKIP(nvmediampeg4viddec) mime_type-%s",mime_type);
-        select_result = GST_AUTOPLUG_SELECT_SKIP;
+    int sample_rate = 0;
+    if (gst_structure_get_int(caps_str, "rate", &sample_rate)) {
+      LOG_DEBUG("samplerate=[%d]", sample_rate);
+      if (sample_rate > 0 && !gst_media_->IsLGsrcValidSamplerate(sample_rate)) {
+        LOG_ERROR("Unsupported sampling rate=[%d]", sample_rate);
+        return GST_AUTOPLUG_SELECT_SKIP;
       }
-    } else if (g_strcmp0(element_name, "jpegdec") == 0){
-      if (mime_type && (g_strcmp0(mime_type, "image/jpeg") == 0)) {
-        LOG_INFO("GST_AUTOPLUG_SELECT_SKIP(jpegdec) mime_type-%s", mime_type);
-        select_result = GST_AUTOPLUG_SELECT_SKIP;
-      }
-    } else if (g_strcmp0(element_name, "avdec_amrwb") == 0 ||
-               g_strcmp0(element_name, "avdec_amrnb") == 0) {
-      if (mime_type && g_str_has_prefix(mime_type, "audio/")) {
-        LOG_INFO("GST_AUTOPLUG_SELECT_SKIP(amr) mime_type-%s", mime_type);
-        select_result = GST_AUTOPLUG_SELECT_SKIP;
-      }
-    } else if ((g_strcmp0(element_name, "avdec_msmpeg4v2") == 0) ||
-               (g_strcmp0(element_name, "avdec_msmpeg4") == 0) ||
-               (g_strcmp0(element_name, "avdec_h263") == 0) ||
-               (g_strcmp0(element_name, "avdec_mpeg4") == 0)) { // For DivX legacy - avdec_mpeg4
-      int width = 0;
-      int height = 0;
-
-      if (mime_type && g_str_has_prefix(mime_type, "video/")) {
-        LOG_INFO("video sw decoder check=[%s]", mime_type);
-        gst_structure_get_int(caps_str, "width", &width);
-        gst_structure_get_int(caps_str, "height", &height);
-
-        if (width > 0 && height > 0) {
-          int max_resolution = Conf::GetSpec(DIVX_MAX_WIDTH) * Conf::GetSpec(DIVX_MAX_HEIGHT);
-          if (width * height > max_resolution) {
-            LOG_INFO("exceed max resolution(%d x %d).. skip", width, height);
-            select_result = GST_AUTOPLUG_SELECT_SKIP;
-          }
-        }
-      }
-    } else if (g_strcmp0(element_name, "sfdec") == 0) {
-      if (mime_type && g_str_has_prefix(mime_type, "audio/")) {
-        LOG_INFO("GST_AUTOPLUG_SELECT_SKIP(sfdec) mime_type-%s", mime_type);
-        select_result = GST_AUTOPLUG_SELECT_SKIP;
-      }
-    /* added check to skip secure plugin's since it is not currently handled in PE */
-    } else if (mime_type && g_str_has_prefix(mime_type, "video/") && g_str_has_prefix(element_name, "nvmwvl1")) {
-      LOG_INFO("GST_AUTOPLUG_SELECT_SKIP(nvmwvl1) mime_type-%s", mime_type);
-      select_result = GST_AUTOPLUG_SELECT_SKIP;
     }
   }
 
-  return select_result;
+  return AutoplugPolicy::Instance()->Select("video_pipeline", caps, factory);
 }
 
 void VideoPipeline::HandleNoMorePads(GstElement *element, gpointer data) {
   LOG_INFO("");
+  LoadTimeline::Instance()->Mark("no-more-pads");
   loading_timer_->Stop();
   if (pb_info_.is_show_loading) {
     LOG_INFO("show loading complete message");
@@ -1218,12 +1453,10 @@ void VideoPipeline::HandleNoMorePads(GstElement *element, gpointer data) {
     pb_info_.is_show_loading = false;
   }
 
-  if (video_count_ < 2 ) {
+  if (!HasVideo()) {
     LOG_ERROR("No Video");
     event_->NotifyEventError();
   }
-
-  ControlAsfContainer(element);
 }
 
 void VideoPipeline::HandleBusChangeState(GstMessage* message) {
@@ -1250,7 +1483,10 @@ void VideoPipeline::HandleBusChangeState(GstMessage* message) {
       break;
     case GST_STATE_PLAYING:
       if (!pb_info_.playback_started) {
-        position_timer_->Start();
+        gst_media_->InvokeOwner([this]() {
+                                  position_timer_->Start();
+                                  qos_timer_->Start();
+                                });
         event_->NotifyEventPlaybackStatus(STATE_PLAYING);
         pb_info_.playback_started = true;
       } else if (!pb_info_.is_playing_) {
@@ -1289,16 +1525,85 @@ void VideoPipeline::HandleBusEOS() {
   //event_->NotifyEventPlaybackStatus(STATE_DONE);
 }
 
+void VideoPipeline::HandleAboutToFinish(GstElement* playbin, gpointer data) {
+  // streaming thread: only hand the next uri to playbin, the track change is handled on STREAM_START
+  std::string next_uri;
+  {
+    std::lock_guard<std::mutex> lock(next_uri_mutex_);
+    if (!next_uri_queue_.empty()) {
+      next_uri = next_uri_queue_.front();
+      next_uri_queue_.pop_front();
+    } else if (pb_info_.mode == PLAYBACK_REPEAT_GAPLESS) {
+      next_uri = current_raw_uri_;
+    }
+    pending_track_uri_ = next_uri;
+  }
+
+  if (next_uri.empty()) {
+    LOG_INFO("[about-to-finish] no next uri, EOS will follow");
+    return;
+  }
+  LOG_INFO("[about-to-finish] next uri[%s]", next_uri.c_str());
+  gst_media_->SetProperty<char*>(playbin, "uri", const_cast<char*>(next_uri.c_str()));
+}
+
+void VideoPipeline::HandleStreamStart() {
+  std::string uri;
+  bool repeat = false;
+  {
+    std::lock_guard<std::mutex> lock(next_uri_mutex_);
+    if (pending_track_uri_.empty())
+      return;
+    uri = pending_track_uri_;
+    repeat = (uri == current_raw_uri_);
+    current_raw_uri_ = uri;
+    pending_track_uri_.clear();
+  }
+  LOG_INFO("[BUS] GST_MESSAGE_STREAM_START, gapless track[%s]", uri.c_str());
+
+  pb_info_.is_eos_ = false;
+  pb_info_.current_position_ = 0;
+  if (repeat)
+    return;
+
+  MI::Clear();
+  source_info_.audio_.clear();
+  source_info_.video_.clear();
+  {
+    std::lock_guard<std::mutex> lock(source_info_mutex_);
+    source_info_.text_.clear();
+    source_info_sent_ = false;
+  }
+  MI::Get()->duration_ = pb_info_.duration_ = gst_media_->GetDuration();
+  event_->NotifyEventDuration(pb_info_.duration_);
+  HandleSourceInfo();
+  NotifySourceInfo();
+  event_->NotifyEventTrackChanged(uri);
+}
+
+void VideoPipeline::NotifySourceInfo() {
+  // HandleSubtitleLoaded() adds the text tracks from the main context
+  std::string json;
+  {
+    std::lock_guard<std::mutex> lock(source_info_mutex_);
+    json = MakeSourceInfoJson(source_info_);
+    source_info_sent_ = true;
+  }
+  event_->NotifyEventSourceInfo(json);
+}
+
 void VideoPipeline::HandleSourceInfo() {
   int i;
   source_info_.can_pause_ = true;
   source_info_.can_play_ = true;
   source_info_.can_seek_ = gst_media_->IsSeekable();
   if (!no_audio_mode_) {
-    gst_media_->GetProperty<gint>(gst_media_->GetPipeline(), "n-audio", source_info_.num_of_audio_track_);
+    source_info_.num_of_audio_track_ = gst_media_->GetTrackCount("audio");
     for (i = 0; i < source_info_.num_of_audio_track_; i++) {
       AudioTrack audio;
-      const char* temp = gst_media_->GetLanguage(i, "get-audio-tags");
+      MI::Get()->audio_stream_count_++;
+      MI::Get()->audio_.push_back(MediaFileAudioInfo());
+      const char* temp = gst_media_->GetTrackInfo(MI::Get(), i, "audio");
 
       if (temp != nullptr) {
         audio.format_ = std::string(temp);
@@ -1306,10 +1611,6 @@ void VideoPipeline::HandleSourceInfo() {
         audio.format_ = "";
       }
       source_info_.audio_.push_back(audio);
-      MI::Get()->audio_stream_count_++;
-      MI::Get()->audio_.push_back(MediaFileAudioInfo());
-      gst_media_->GetMediaInfo(MI::Get(), i, "get-audio-tags");
-      gst_media_->GetMediaInfo(MI::Get(), i, "get-audio-pad");
 
       if (use_atmos_ && (MI::Get()->audio_[i].audio_codec_id_.find("E-AC-3") != std::string::npos)) {
         int ddp_bitrate = MI::Get()->audio_[i].audio_bitrate_;
@@ -1322,19 +1623,22 @@ void VideoPipeline::HandleSourceInfo() {
     }
   }
 
-  gst_media_->GetProperty<gint>(gst_media_->GetPipeline(), "n-video", source_info_.num_of_video_track_);
+  source_info_.num_of_video_track_ = gst_media_->GetTrackCount("video");
   if (source_info_.num_of_video_track_) {
-    gst_media_->GetProperty<gint>(gst_media_->GetPipeline(), "current-video", source_info_.cur_video_track_);
-    gst_media_->GetMediaInfo(MI::Get(), source_info_.cur_video_track_, "get-video-tags");
-    gst_media_->GetMediaInfo(MI::Get(), source_info_.cur_video_track_, "get-video-pad");
+    source_info_.cur_video_track_ = gst_media_->GetCurrentTrack("video");
     VideoTrack video;
-    char *videoTag = gst_media_->GetLanguage(source_info_.cur_video_track_, "get-video-tags");
+    char *videoTag = gst_media_->GetTrackInfo(MI::Get(), source_info_.cur_video_track_, "video");
     if (videoTag) {
       std::string format_str(videoTag);
       video.format_ = format_str;
     }
     gchar* video_sink = Conf::GetSink(VIDEO_SINK);
-    if (strcmp(video_sink,"nvmediaeglwaylandsink") == 0) {
+    gint probed_width = 0;
+    gint probed_height = 0;
+    if (resolution_probe_->GetResolution(&probed_width, &probed_height)) {
+        video.width_ = probed_width;
+        video.height_ = probed_height;
+    } else if (strcmp(video_sink,"nvmediaeglwaylandsink") == 0) {
         int video_width = 0;
         int video_height = 0;
         gst_media_->GetProperty<gint>(video_sink_, "width", video_width);
@@ -1350,22 +1654,80 @@ void VideoPipeline::HandleSourceInfo() {
     MI::Get()->video_stream_count_ = source_info_.num_of_video_track_;
   }
 
-  source_info_.num_of_text_track_ = 0;
+  // internal text tracks are collected in the same pass, into MediaFileInfo only. The text tracks of
+  // the source info come from the subtitle parser below.
+  int text_count = gst_media_->GetTrackCount("text");
+  for (i = 0; i < text_count; i++) {
+    gst_media_->GetTrackInfo(MI::Get(), i, "text");
+    MI::Get()->text_stream_count_++;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(source_info_mutex_);
+    source_info_.num_of_text_track_ = 0;
+  }
 #if defined(USE_SUBTITLE)
-  if (subtitle_controller_->Load(media_type_)) {
-    source_info_.num_of_text_track_ = subtitle_controller_->GetSubtitleLanguageCount();
-    for (i = 0; i < source_info_.num_of_text_track_; i++) {
+  // text tracks follow with another source info from HandleSubtitleLoaded(). The worker parses into a
+  // controller of its own, which replaces subtitle_controller_ on the main context, so UnloadInternal()
+  // never stops the controller the parser is still working on.
+  std::string media_type = media_type_;
+  std::shared_ptr<SubtitleController> controller(new SubtitleController(gst_media_, event_));
+  controller->SetUri(subtitle_path_);
+  subtitle_loader_->Start([controller, media_type]() {
+                            std::vector<std::string> languages;
+                            if (controller->Load(media_type)) {
+                              int count = controller->GetSubtitleLanguageCount();
+                              for (int index = 0; index < count; index++) {
+                                std::string text_language;
+                                controller->GetSubtitleLanguageCode(index, text_language);
+                                languages.push_back(text_language);
+                              }
+                            }
+                            return languages;
+                          },
+                          std::bind(&VideoPipeline::HandleSubtitleLoaded, this, controller,
+                                    std::placeholders::_1));
+#elif defined(USE_LGE_SUBTITLE)
+  HandleSubtitleInfo();
+#endif
+}
+
+#if defined(USE_SUBTITLE)
+void VideoPipeline::HandleSubtitleLoaded(std::shared_ptr<SubtitleController> controller,
+                                         const std::vector<std::string>& languages) {
+  subtitle_controller_->Stop();
+  subtitle_controller_ = controller;
+  if (subtitle_show_pending_ >= 0)
+    subtitle_controller_->SetSubtitleEnable(subtitle_show_pending_ != 0);
+  if (!subtitle_language_pending_.empty())
+    subtitle_controller_->SetSubtitleLanguage(subtitle_language_pending_);
+  else if (subtitle_index_pending_ >= 0)
+    subtitle_controller_->SetSubtitleLanguageIndex(subtitle_index_pending_);
+  subtitle_show_pending_ = -1;
+  subtitle_language_pending_.clear();
+  subtitle_index_pending_ = -1;
+
+  // a source info sent before has no text tracks, one still to come carries them
+  std::string json;
+  {
+    std::lock_guard<std::mutex> lock(source_info_mutex_);
+    source_info_.text_.clear();
+    for (const std::string& language : languages) {
       TextTrack text;
-      std::string text_language;
-      subtitle_controller_->GetSubtitleLanguageCode(i, text_language);
-      text.format_.append(text_language);
+      text.format_.append(language);
       source_info_.text_.push_back(text);
     }
+    source_info_.num_of_text_track_ = (int)languages.size();
+    if (source_info_sent_ && !languages.empty())
+      json = MakeSourceInfoJson(source_info_);
   }
-#elif defined(USE_LGE_SUBTITLE)
-  HandleSubtitleInfo();
-#endif
+  if (!json.empty())
+    event_->NotifyEventSourceInfo(json);
+
+  if (subtitle_play_pending_)
+    subtitle_controller_->Play();
 }
+#endif
 
 void VideoPipeline::HandleSubtitleInfo() {
 #if defined(USE_LGE_SUBTITLE)
@@ -1400,16 +1762,19 @@ void VideoPipeline::HandleSubtitleInfo() {
 #endif
 }
 
-void VideoPipeline::HandleAsyncDone() {
+void VideoPipeline::HandleAsyncDone(GstMessage* message) {
   LOG_INFO("[BUS] GST_MESSAGE_ASYNC_DONE");
+  LoadTimeline::Instance()->Mark("async-done");
   pb_info_.is_eos_ = false;
   pb_info_.is_bos_ = false;
 
   event_->NotifyEventAsyncDone();
 
   if (pb_info_.is_seeking_) {
-    pb_info_.is_seeking_ = false;
-    gst_media_->SeekDone();
+    if (gst_media_->SeekDone(gst_message_get_seqnum(message))) {
+      pb_info_.is_seeking_ = false;
+      event_->NotifyEventSeekLatency(gst_media_->GetSeekLatencyJson());
+    }
     return;
   }
 
@@ -1420,6 +1785,7 @@ void VideoPipeline::HandleAsyncDone() {
   }
 
   if (!pb_info_.is_load_completed_) {
+    gint64 async_done_time = g_get_monotonic_time();
     MI::Get()->duration_ = pb_info_.duration_ = gst_media_->GetDuration();
     event_->NotifyEventDuration(pb_info_.duration_);
 
@@ -1441,8 +1807,8 @@ void VideoPipeline::HandleAsyncDone() {
 
     if (not_support_media) {
       event_->NotifyEventError(MI::Get()->error_reason_);
-      event_->NotifyEventSourceInfo(MakeSourceInfoJson(source_info_));
-      check_playback_timer_->Stop();
+      NotifySourceInfo();
+      gst_media_->InvokeOwner([this]() { check_playback_timer_->Stop(); });
       return;
     }
 
@@ -1452,7 +1818,7 @@ void VideoPipeline::HandleAsyncDone() {
       event_->NotifyEventChannel(media_type_, audio_channel_);
     }
 
-    event_->NotifyEventSourceInfo(MakeSourceInfoJson(source_info_));
+    NotifySourceInfo();
     if (MI::Get()->warning_reason_)
       event_->NotifyEventWarn(MI::Get()->warning_reason_);
 
@@ -1462,14 +1828,132 @@ void VideoPipeline::HandleAsyncDone() {
 
     /*send Ready state to media manager*/
     event_->NotifyEventPlaybackStatus(STATE_READY);
+    gint64 ready_latency = g_get_monotonic_time() - async_done_time;
+    LOG_INFO("ASYNC_DONE to READY took [%lld]us", ready_latency);
+    event_->NotifyEventReadyLatency(ready_latency);
   }
 }
 
 gboolean VideoPipeline::HandleBusApplication(GstMessage* message) {
   LOG_INFO("[HandleBusApplication] src(%s)", GST_MESSAGE_SRC_NAME(message));
+  if (gst_message_has_name(message, AUDIO_SINK_SWAP_MESSAGE)) {
+    const GstStructure* structure = gst_message_get_structure(message);
+    gboolean result = FALSE;
+    gboolean is_dsd = FALSE;
+    gint channels = 0;
+    gint64 gap_us = -1;
+    gint64 period_us = 0;
+    gst_structure_get_boolean(structure, "result", &result);
+    gst_structure_get_boolean(structure, "dsd", &is_dsd);
+    gst_structure_get_int(structure, "channels", &channels);
+    gst_structure_get_int64(structure, "gap-us", &gap_us);
+    gst_structure_get_int64(structure, "period-us", &period_us);
+    // false if CheckSinkSwap() or the unload already ended the swap and notified the channel
+    bool pending = gst_media_->SinkSwapDone();
+    gst_media_->InvokeOwner([this]() { sink_swap_timer_->Stop(); });
+    event_->NotifyEventSinkSwap(media_type_, result, channels, gap_us, period_us);
+    if (result) {
+      if (!use_atmos_ && pending)
+        event_->NotifyEventChannel(media_type_, channels);
+    } else {
+      // the legacy switch goes through READY and blocks, not on the bus dispatch
+      LOG_ERROR("live sink swap failed, switch channel with state change");
+      if (sink_swap_fallback_id_)
+        g_source_remove(sink_swap_fallback_id_);
+      SinkSwapFallback* fallback = new SinkSwapFallback{this, channels, is_dsd ? true : false};
+      sink_swap_fallback_id_ = g_idle_add_full(G_PRIORITY_DEFAULT_IDLE, SinkSwapFallbackFunc, fallback,
+                                               FreeSinkSwapFallbackFunc);
+    }
+  } else if (gst_message_has_name(message, FAST_PATH_FALLBACK_MESSAGE)) {
+    std::string raw_uri;
+    {
+      std::lock_guard<std::mutex> lock(next_uri_mutex_);
+      raw_uri = current_raw_uri_;
+    }
+    // the state change to READY shall not run on the bus dispatch
+    gst_media_->InvokeOwner([this, raw_uri]() { ReloadWithoutFastPath(raw_uri); });
+  } else if (gst_message_has_name(message, TRICK_MODE_FALLBACK_MESSAGE)) {
+    gdouble rate = 0.0;
+    gst_structure_get_double(gst_message_get_structure(message), "rate", &rate);
+    // a report of an earlier rate is stale, StopRateChange or another rate change came in between
+    if (pb_info_.is_native_trick_ && fabs(rate - pb_info_.playback_rate_) <= DBL_EPSILON) {
+      gint64 position = 0;
+      pb_info_.is_native_trick_ = false;
+      if (!gst_media_->GetCurPosition(&position))
+        position = pb_info_.current_position_;
+      // trick_timer_ belongs to the main context
+      gst_media_->InvokeOwner([this, position, rate]() { StartTrickStep(position, rate); });
+    }
+  }
   return true;
 }
 
+gboolean VideoPipeline::SinkSwapFallbackFunc(gpointer data) {
+  SinkSwapFallback* fallback = reinterpret_cast<SinkSwapFallback*>(data);
+  VideoPipeline* pipeline = fallback->pipeline_;
+  pipeline->sink_swap_fallback_id_ = 0;
+  if (pipeline->gst_media_ &&
+      pipeline->gst_media_->SwitchChannel(fallback->channels_ == 2, pipeline->audio_slot_, pipeline->audio_6ch_slot_,
+                                          fallback->is_dsd_, pipeline->media_type_, pipeline->provide_global_clock_,
+                                          pipeline->audio_sink_, pipeline->gst_media_->GetPipeline(), false)) {
+    if (!pipeline->use_atmos_)
+      pipeline->event_->NotifyEventChannel(pipeline->media_type_, fallback->channels_);
+  }
+  return G_SOURCE_REMOVE;
+}
+
+void VideoPipeline::FreeSinkSwapFallbackFunc(gpointer data) {
+  delete reinterpret_cast<SinkSwapFallback*>(data);
+}
+
+void VideoPipeline::FastPathPadAddedFunc(GstElement* element, GstPad* pad, gpointer data) {
+  VideoPipeline* pipeline = reinterpret_cast<VideoPipeline*>(data);
+  gchar* pad_name = gst_pad_get_name(pad);
+  // as the first video pad in HandleAutoplugSort()
+  if (g_str_has_prefix(pad_name, "video_") && pipeline->video_count_++ == 0) {
+    pipeline->gst_media_->InvokeOwner([pipeline]() {
+                                        pipeline->check_playback_timer_->Stop();
+                                        TimerCallback playback_callback = std::bind(&VideoPipeline::CheckPlayback,
+                                                                                    pipeline);
+                                        pipeline->check_playback_timer_->AddCallback(playback_callback, 3200);
+                                        pipeline->check_playback_timer_->Start();
+
+                                        pipeline->loading_timer_->Start();
+                                      });
+  }
+  g_free(pad_name);
+}
+
+void VideoPipeline::ReloadWithoutFastPath(const std::string& raw_uri) {
+  GstElement* pipeline = gst_media_->GetPipeline();
+  // a second report of the same load, or one of a load replaced in between
+  if (!pipeline || raw_uri.empty() || fast_path_failed_uri_ == raw_uri)
+    return;
+
+  GstState target = GST_STATE_TARGET(pipeline);
+  LOG_INFO("reload [%s] through uridecodebin", raw_uri.c_str());
+  fast_path_failed_uri_ = raw_uri;
+  fast_path_source_ = false;
+  video_count_ = 0;
+  gst_media_->ChangeStateToReady();
+  gst_media_->SetSourceURI(raw_uri.c_str(), false);
+  gst_element_set_state(pipeline, (target == GST_STATE_PLAYING) ? GST_STATE_PLAYING : GST_STATE_PAUSED);
+}
+
+void VideoPipeline::HandleClockLost() {
+  // a live sink swap fixes the pipeline to the clock of the re-opened sink, nothing to select again
+  LOG_INFO("[BUS] GST_MESSAGE_CLOCK_LOST, sink swap pending=[%d]", gst_media_->IsSinkSwapPending());
+}
+
+gboolean VideoPipeline::CheckSinkSwap() {
+  if (gst_media_->SinkSwapDone()) {
+    LOG_ERROR("no result of the live sink swap in %u ms", kSinkSwapTimeout);
+    if (!use_atmos_)
+      event_->NotifyEventChannel(media_type_, audio_channel_);
+  }
+  return false;
+}
+
 gboolean VideoPipeline::HandleBusPipelineMessage(GstMessage* message) {
   GError* err = nullptr;
   GError* warn = nullptr;
@@ -1495,8 +1979,12 @@ gboolean VideoPipeline::HandleBusPipelineMessage(GstMessage* message) {
       LOG_INFO("[BUS] GST_MESSAGE_WARNING : %s", warn->message);
       break;
 
+    case GST_MESSAGE_STREAM_START:
+      HandleStreamStart();
+      break;
+
     case GST_MESSAGE_ASYNC_DONE:
-      HandleAsyncDone();
+      HandleAsyncDone(message);
       break;
 
     default:
@@ -1538,13 +2026,14 @@ gboolean VideoPipeline::HandleBusElementMessage(GstMessage* message) {
       }
     } else if((warn->code == GST_STREAM_ERROR_NOINDEX) ||
         (warn->code == GST_STREAM_ERROR_TOOBIG)){
-        check_playback_timer_->Stop();
-        TimerCallback playback_callback = std::bind(&VideoPipeline::CheckPlayback, this);
-        int interval = 30000;
-        check_playback_timer_->AddCallback(playback_callback, interval);
-        LOG_INFO("Re-register playback timer as 30sec");
-        check_playback_timer_->Start();
-
+        gst_media_->InvokeOwner([this]() {
+                                  check_playback_timer_->Stop();
+                                  TimerCallback playback_callback = std::bind(&VideoPipeline::CheckPlayback, this);
+                                  int interval = 30000;
+                                  check_playback_timer_->AddCallback(playback_callback, interval);
+                                  LOG_INFO("Re-register playback timer as 30sec");
+                                  check_playback_timer_->Start();
+                                });
     }
     goto EXIT;
   }
@@ -1584,11 +2073,12 @@ gboolean VideoPipeline::HandleBusElementErrorMessage(GstMessage* message) {
     event_->NotifyEventError(ERROR_GST_RESOURCE_ERROR_READ);
   } else if(err->code == (int) GST_STREAM_ERROR_AUDIOSHORT && !no_audio_mode_) {
     event_->NotifyEventError(ERROR_STREAM_AUDIO_SHORT);
-    loading_timer_->Stop();
+    gst_media_->InvokeOwner([this]() { loading_timer_->Stop(); });
   } else {
     event_->NotifyEventError(ERROR_GST_INTERNAL_ERROR);
   }
-  check_playback_timer_->Stop(); // Error event is already sent to application.
+  // Error event is already sent to application.
+  gst_media_->InvokeOwner([this]() { check_playback_timer_->Stop(); });
   ret = true;
 
 EXIT: